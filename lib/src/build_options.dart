@@ -9,6 +9,7 @@ class BuildOptions {
     this.flutterExecutable = "flutter",
     this.gitExecutable = "git",
     this.configuration = "Release",
+    this.aot = false,
     this.openXrSdkTag = "release-1.1.57",
     this.dryRun = false,
   });
@@ -20,6 +21,7 @@ class BuildOptions {
   final String flutterExecutable;
   final String gitExecutable;
   final String configuration;
+  final bool aot;
   final String openXrSdkTag;
   final bool dryRun;
 }
@@ -51,7 +51,14 @@ class FlutterOpenXrBuilder {
     final workspaceDir = Directory(
       p.join(options.projectDir.path, ".dart_tool", "flutter_open_xr"),
     );
-    final assetsDir = Directory(p.join(workspaceDir.path, "flutter_assets"));
+    final assetsDir = Directory(
+      p.join(
+        workspaceDir.path,
+        options.aot ? "flutter_assets_aot" : "flutter_assets",
+      ),
+    );
+    final aotDir = Directory(p.join(workspaceDir.path, "aot"));
+    final aotLibrary = File(p.join(aotDir.path, "app.so"));
     final downloadsDir = Directory(p.join(workspaceDir.path, "downloads"));
     final embedderRootDir = Directory(p.join(workspaceDir.path, "embedder"));
     final nativeBuildDir = Directory(p.join(workspaceDir.path, "native_build"));
@@ -86,8 +93,15 @@ class FlutterOpenXrBuilder {
       return 2;
     }
 
+    final engineArtifact =
+        options.aot ? "windows-x64-release" : "windows-x64";
     final embedderDir = Directory(
-      p.join(embedderRootDir.path, flutterInfo.engineRevision),
+      p.join(
+        embedderRootDir.path,
+        options.aot
+            ? "${flutterInfo.engineRevision}-release"
+            : flutterInfo.engineRevision,
+      ),
     );
     final openXrSdkDir = options.openXrSdkDir ??
         Directory(
@@ -110,6 +124,9 @@ class FlutterOpenXrBuilder {
     out.writeln("Project: ${options.projectDir.path}");
     out.writeln("Flutter SDK: ${flutterInfo.flutterVersion}");
     out.writeln("Flutter engine revision: ${flutterInfo.engineRevision}");
+    out.writeln(
+      "Dart code: ${options.aot ? "AOT (app.so)" : "JIT (kernel_blob.bin)"}",
+    );
     out.writeln("Workspace: ${workspaceDir.path}");
     out.writeln("Output: ${outputDir.path}");
 
@@ -119,6 +136,9 @@ class FlutterOpenXrBuilder {
       embedderRootDir.createSync(recursive: true);
       nativeBuildDir.createSync(recursive: true);
       outputDir.createSync(recursive: true);
+      if (options.aot) {
+        aotDir.createSync(recursive: true);
+      }
     }
 
     final pubGetCode = await _runCommand(
@@ -138,7 +158,7 @@ class FlutterOpenXrBuilder {
       [
         "build",
         "bundle",
-        "--debug",
+        options.aot ? "--release" : "--debug",
         "--target-platform=windows-x64",
         "--asset-dir",
         assetsDir.path,
@@ -152,8 +172,23 @@ class FlutterOpenXrBuilder {
       return bundleCode;
     }
 
+    if (options.aot) {
+      final aotCode = await _compileAotLibrary(
+        options: options,
+        flutterRoot: flutterInfo.flutterRoot,
+        aotDir: aotDir,
+        aotLibrary: aotLibrary,
+        out: out,
+        err: err,
+      );
+      if (aotCode != 0) {
+        return aotCode;
+      }
+    }
+
     final embedderCode = await _ensureFlutterEmbedder(
       engineRevision: flutterInfo.engineRevision,
+      engineArtifact: engineArtifact,
       cmakeExecutable: options.cmakeExecutable,
       downloadsDir: downloadsDir,
       embedderDir: embedderDir,
@@ -191,6 +226,7 @@ class FlutterOpenXrBuilder {
         "-DFLUTTER_EMBEDDER_DIR=${embedderDir.path}",
         "-DFLUTTER_ASSETS_DIR=${assetsDir.path}",
         "-DFLUTTER_ICUDTL_PATH=$flutterIcuDataPath",
+        "-DFLUTTER_AOT_LIBRARY=${options.aot ? aotLibrary.path : ""}",
       ],
       dryRun: options.dryRun,
       out: out,
@@ -358,6 +394,7 @@ class FlutterOpenXrBuilder {
 
   Future<int> _ensureFlutterEmbedder({
     required String engineRevision,
+    required String engineArtifact,
     required String cmakeExecutable,
     required Directory downloadsDir,
     required Directory embedderDir,
@@ -379,10 +416,13 @@ class FlutterOpenXrBuilder {
 
     final embedderUrl = Uri.parse(
       "https://storage.googleapis.com/flutter_infra_release/flutter/"
-      "$engineRevision/windows-x64/windows-x64-embedder.zip",
+      "$engineRevision/$engineArtifact/windows-x64-embedder.zip",
     );
     final embedderZip = File(
-      p.join(downloadsDir.path, "windows-x64-embedder-$engineRevision.zip"),
+      p.join(
+        downloadsDir.path,
+        "$engineArtifact-embedder-$engineRevision.zip",
+      ),
     );
 
     if (dryRun) {
@@ -432,6 +472,94 @@ class FlutterOpenXrBuilder {
     return 0;
   }
 
+  Future<int> _compileAotLibrary({
+    required BuildOptions options,
+    required String flutterRoot,
+    required Directory aotDir,
+    required File aotLibrary,
+    required IOSink out,
+    required IOSink err,
+  }) async {
+    final cacheDir = p.join(flutterRoot, "bin", "cache");
+    final dartSdkBinDir = p.join(cacheDir, "dart-sdk", "bin");
+    final appDill = p.join(aotDir.path, "app.dill");
+    final genSnapshot = p.join(
+      cacheDir,
+      "artifacts",
+      "engine",
+      "windows-x64-release",
+      "gen_snapshot.exe",
+    );
+
+    // Release engine artifacts, including gen_snapshot, are only fetched on
+    // demand.
+    final precacheCode = await _runCommand(
+      options.flutterExecutable,
+      const ["precache", "--windows"],
+      workingDirectory: options.projectDir.path,
+      dryRun: options.dryRun,
+      out: out,
+      err: err,
+    );
+    if (precacheCode != 0) {
+      return precacheCode;
+    }
+
+    final kernelCode = await _runCommand(
+      p.join(dartSdkBinDir, "dartaotruntime.exe"),
+      [
+        p.join(dartSdkBinDir, "snapshots", "frontend_server_aot.dart.snapshot"),
+        "--sdk-root",
+        p.join(
+          cacheDir,
+          "artifacts",
+          "engine",
+          "common",
+          "flutter_patched_sdk_product",
+        ),
+        "--target=flutter",
+        "--aot",
+        "--tfa",
+        "-Ddart.vm.product=true",
+        "-Ddart.vm.profile=false",
+        "--packages",
+        p.join(options.projectDir.path, ".dart_tool", "package_config.json"),
+        "--output-dill",
+        appDill,
+        p.join(options.projectDir.path, "lib", "main.dart"),
+      ],
+      workingDirectory: options.projectDir.path,
+      dryRun: options.dryRun,
+      out: out,
+      err: err,
+    );
+    if (kernelCode != 0) {
+      return kernelCode;
+    }
+
+    final snapshotCode = await _runCommand(
+      genSnapshot,
+      [
+        "--snapshot_kind=app-aot-elf",
+        "--elf=${aotLibrary.path}",
+        "--deterministic",
+        appDill,
+      ],
+      dryRun: options.dryRun,
+      out: out,
+      err: err,
+    );
+    if (snapshotCode != 0) {
+      return snapshotCode;
+    }
+
+    if (!options.dryRun && !aotLibrary.existsSync()) {
+      err.writeln("gen_snapshot finished but ${aotLibrary.path} is missing.");
+      return 2;
+    }
+    return 0;
+  }
+
   Future<int> _ensureOpenXrSdk({
     required BuildOptions options,
     required Directory openXrSdkDir,
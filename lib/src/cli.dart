@@ -64,6 +64,12 @@ class FlutterOpenXrCli {
         allowed: const ["Debug", "Release", "RelWithDebInfo", "MinSizeRel"],
         help: "Native build configuration.",
       )
+      ..addFlag(
+        "aot",
+        negatable: false,
+        help: "Compile Dart ahead of time (app.so) and use the release "
+            "Flutter engine instead of the JIT kernel blob.",
+      )
       ..addFlag(
         "dry-run",
         negatable: false,
@@ -117,6 +123,7 @@ class FlutterOpenXrCli {
       flutterExecutable: parsed["flutter"] as String,
       gitExecutable: parsed["git"] as String,
       configuration: parsed["configuration"] as String,
+      aot: parsed["aot"] as bool,
       dryRun: parsed["dry-run"] as bool,
     );
 
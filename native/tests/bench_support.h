@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace flutter_xr_bench {
+
+inline double NowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Keeps the compiler from dropping work whose result is otherwise unused.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct Timing {
+    double bestSeconds = 0.0;
+    double medianSeconds = 0.0;
+};
+
+// Times `repetitions` runs of `body` after one warm-up run. The best run is
+// the least disturbed by the rest of the machine; the median shows the spread.
+template <typename Body>
+Timing Measure(size_t repetitions, Body&& body) {
+    body();
+    std::vector<double> samples;
+    samples.reserve(repetitions);
+    for (size_t i = 0; i < repetitions; ++i) {
+        const double start = NowSeconds();
+        body();
+        samples.push_back(NowSeconds() - start);
+    }
+    std::sort(samples.begin(), samples.end());
+    return {samples.front(), samples[samples.size() / 2]};
+}
+
+// `--quick` shortens every benchmark so CI can check that it still runs.
+inline bool QuickMode(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace flutter_xr_bench
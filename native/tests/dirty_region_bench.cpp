@@ -0,0 +1,79 @@
+#include "flutter_xr/dirty_region.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench_support.h"
+
+using flutter_xr::DirtyRect;
+using flutter_xr::FindContentBounds;
+using flutter_xr::TileChangeDetector;
+using flutter_xr_bench::DoNotOptimize;
+using flutter_xr_bench::Measure;
+using flutter_xr_bench::Timing;
+
+namespace {
+
+void PrintTiming(const char* name, size_t bytes, const Timing& timing) {
+    std::printf("  %-28s %8.3f ms  %6.2f GB/s  (median %.3f ms)\n", name, timing.bestSeconds * 1e3,
+                bytes / timing.bestSeconds / 1e9, timing.medianSeconds * 1e3);
+}
+
+void RunSize(uint32_t width, uint32_t height, size_t repetitions) {
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    const size_t bytes = rowBytes * height;
+    std::vector<uint8_t> pixels(bytes);
+    std::mt19937 random(1);
+    for (uint8_t& byte : pixels) {
+        byte = static_cast<uint8_t>(random());
+    }
+    std::printf("%ux%u\n", width, height);
+
+    TileChangeDetector detector;
+    detector.Update(pixels.data(), rowBytes, width, height);
+    PrintTiming("Update, unchanged", bytes, Measure(repetitions, [&] {
+                    DoNotOptimize(detector.Update(pixels.data(), rowBytes, width, height).size());
+                }));
+
+    // A blinking cursor: the same pixel flips every frame.
+    uint8_t* cursor = pixels.data() + (height / 2) * rowBytes + (width / 2) * 4;
+    PrintTiming("Update, one pixel changed", bytes, Measure(repetitions, [&] {
+                    *cursor ^= 0xff;
+                    DoNotOptimize(detector.Update(pixels.data(), rowBytes, width, height).size());
+                }));
+
+    PrintTiming("Update, every tile changed", bytes, Measure(repetitions, [&] {
+                    for (size_t offset = 0; offset < bytes; offset += 64 * 4) {
+                        pixels[offset] ^= 0xff;
+                    }
+                    DoNotOptimize(detector.Update(pixels.data(), rowBytes, width, height).size());
+                }));
+
+    // Content bounds scan: worst case is a fully transparent surface, which
+    // reads every pixel; typical UI content stops early on every row.
+    std::vector<uint8_t> transparent(bytes, 0);
+    DirtyRect bounds;
+    PrintTiming("FindContentBounds, empty", bytes, Measure(repetitions, [&] {
+                    DoNotOptimize(FindContentBounds(transparent.data(), rowBytes, width, height, &bounds));
+                }));
+    std::vector<uint8_t> centered(bytes, 0);
+    for (uint32_t y = height / 4; y < height * 3 / 4; ++y) {
+        std::fill(centered.begin() + y * rowBytes + width / 4 * 4, centered.begin() + y * rowBytes + width * 3 / 4 * 4,
+                  0xff);
+    }
+    PrintTiming("FindContentBounds, centered", bytes, Measure(repetitions, [&] {
+                    DoNotOptimize(FindContentBounds(centered.data(), rowBytes, width, height, &bounds));
+                }));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t repetitions = flutter_xr_bench::QuickMode(argc, argv) ? 3 : 50;
+    RunSize(1280, 720, repetitions);
+    RunSize(1920, 1080, repetitions);
+    RunSize(3840, 2160, repetitions);
+    return 0;
+}
@@ -0,0 +1,287 @@
+#include "flutter_xr/dirty_region.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "test_support.h"
+
+using flutter_xr::DirtyRect;
+using flutter_xr::FindContentBounds;
+using flutter_xr::TileChangeDetector;
+
+namespace {
+
+struct Surface {
+    Surface(uint32_t surfaceWidth, uint32_t surfaceHeight, size_t paddingBytes = 0)
+        : width(surfaceWidth),
+          height(surfaceHeight),
+          rowBytes(static_cast<size_t>(surfaceWidth) * 4 + paddingBytes),
+          pixels(rowBytes * surfaceHeight, 0) {}
+
+    uint32_t Get(uint32_t x, uint32_t y) const {
+        uint32_t pixel = 0;
+        std::memcpy(&pixel, pixels.data() + y * rowBytes + x * 4, sizeof(pixel));
+        return pixel;
+    }
+
+    void Set(uint32_t x, uint32_t y, uint32_t pixel) {
+        std::memcpy(pixels.data() + y * rowBytes + x * 4, &pixel, sizeof(pixel));
+    }
+
+    void FillTile(uint32_t tileSize, uint32_t tx, uint32_t ty, uint32_t pixel) {
+        for (uint32_t y = ty * tileSize; y < (ty + 1) * tileSize && y < height; ++y) {
+            for (uint32_t x = tx * tileSize; x < (tx + 1) * tileSize && x < width; ++x) {
+                Set(x, y, pixel);
+            }
+        }
+    }
+
+    const std::vector<DirtyRect>& Update(TileChangeDetector& detector, const DirtyRect* visibleBounds = nullptr) {
+        return detector.Update(pixels.data(), rowBytes, width, height, visibleBounds);
+    }
+
+    uint32_t width;
+    uint32_t height;
+    size_t rowBytes;
+    std::vector<uint8_t> pixels;
+};
+
+bool SameRect(const DirtyRect& rect, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    return rect.x == x && rect.y == y && rect.width == width && rect.height == height;
+}
+
+void FillNoise(Surface& surface, uint32_t seed) {
+    std::mt19937 random(seed);
+    for (uint8_t& byte : surface.pixels) {
+        byte = static_cast<uint8_t>(random());
+    }
+}
+
+// Straightforward reference for FindContentBounds.
+bool ReferenceContentBounds(const Surface& surface, DirtyRect* outBounds) {
+    uint32_t minX = surface.width;
+    uint32_t minY = surface.height;
+    uint32_t maxX = 0;
+    uint32_t maxY = 0;
+    for (uint32_t y = 0; y < surface.height; ++y) {
+        for (uint32_t x = 0; x < surface.width; ++x) {
+            if ((surface.Get(x, y) & 0xff000000u) != 0) {
+                minX = std::min(minX, x);
+                minY = std::min(minY, y);
+                maxX = std::max(maxX, x);
+                maxY = std::max(maxY, y);
+            }
+        }
+    }
+    if (minY == surface.height) {
+        return false;
+    }
+    *outBounds = {minX, minY, maxX - minX + 1, maxY - minY + 1};
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE(FirstFrameIsFullyDirty) {
+    Surface surface(200, 130);
+    FillNoise(surface, 1);
+    TileChangeDetector detector;
+    const std::vector<DirtyRect>& rects = surface.Update(detector);
+    REQUIRE(rects.size() == 1);
+    CHECK(SameRect(rects[0], 0, 0, 200, 130));
+}
+
+TEST_CASE(UnchangedFrameIsClean) {
+    Surface surface(200, 130);
+    FillNoise(surface, 2);
+    TileChangeDetector detector;
+    surface.Update(detector);
+    CHECK(surface.Update(detector).empty());
+    CHECK(surface.Update(detector).empty());
+}
+
+TEST_CASE(SinglePixelChangeDirtiesOneTile) {
+    Surface surface(200, 130);
+    FillNoise(surface, 3);
+    TileChangeDetector detector;
+    surface.Update(detector);
+
+    surface.Set(70, 10, surface.Get(70, 10) ^ 0x00000100u);
+    const std::vector<DirtyRect>& rects = surface.Update(detector);
+    REQUIRE(rects.size() == 1);
+    CHECK(SameRect(rects[0], 64, 0, 64, 64));
+}
+
+TEST_CASE(EdgeTileIsClippedToTheSurface) {
+    Surface surface(200, 130);
+    FillNoise(surface, 4);
+    TileChangeDetector detector;
+    surface.Update(detector);
+
+    surface.Set(199, 129, ~surface.Get(199, 129));
+    const std::vector<DirtyRect>& rects = surface.Update(detector);
+    REQUIRE(rects.size() == 1);
+    CHECK(SameRect(rects[0], 192, 128, 8, 2));
+}
+
+TEST_CASE(RowPaddingIsIgnored) {
+    Surface surface(100, 70, 24);
+    FillNoise(surface, 5);
+    TileChangeDetector detector;
+    surface.Update(detector);
+
+    for (uint32_t y = 0; y < surface.height; ++y) {
+        std::memset(surface.pixels.data() + y * surface.rowBytes + surface.width * 4, y, 24);
+    }
+    CHECK(surface.Update(detector).empty());
+}
+
+TEST_CASE(AdjacentDirtyTilesMergeIntoOneRect) {
+    Surface surface(640, 640);
+    TileChangeDetector detector;
+    surface.Update(detector);
+
+    for (uint32_t ty = 2; ty < 5; ++ty) {
+        for (uint32_t tx = 3; tx < 5; ++tx) {
+            surface.FillTile(64, tx, ty, 0xff0000ffu);
+        }
+    }
+    const std::vector<DirtyRect>& rects = surface.Update(detector);
+    REQUIRE(rects.size() == 1);
+    CHECK(SameRect(rects[0], 192, 128, 128, 192));
+}
+
+TEST_CASE(UpToMaxRectsAreKeptSeparate) {
+    Surface surface(704, 640);
+    TileChangeDetector detector;
+    surface.Update(detector);
+
+    // An 8x8 checkerboard of changed tiles: 32 rects that cannot merge.
+    for (uint32_t ty = 1; ty < 9; ++ty) {
+        for (uint32_t tx = 1; tx < 9; ++tx) {
+            if ((tx + ty) % 2 == 0) {
+                surface.FillTile(64, tx, ty, 0xffffffffu);
+            }
+        }
+    }
+    CHECK(surface.Update(detector).size() == TileChangeDetector::kMaxDirtyRects);
+}
+
+TEST_CASE(MoreThanMaxRectsCollapseToBoundingBox) {
+    Surface surface(704, 640);
+    TileChangeDetector detector;
+    surface.Update(detector);
+
+    // A 9x8 checkerboard leaves 36 rects, over the limit.
+    for (uint32_t ty = 1; ty < 9; ++ty) {
+        for (uint32_t tx = 1; tx < 10; ++tx) {
+            if ((tx + ty) % 2 == 0) {
+                surface.FillTile(64, tx, ty, 0xffffffffu);
+            }
+        }
+    }
+    const std::vector<DirtyRect>& rects = surface.Update(detector);
+    REQUIRE(rects.size() == 1);
+    CHECK(SameRect(rects[0], 64, 64, 576, 512));
+}
+
+TEST_CASE(HiddenChangesAreReportedOnceVisible) {
+    Surface surface(256, 256);
+    TileChangeDetector detector;
+    surface.Update(detector);
+
+    const DirtyRect left{0, 0, 128, 256};
+    surface.FillTile(64, 3, 0, 0xff00ff00u);
+    CHECK(surface.Update(detector, &left).empty());
+    CHECK(surface.Update(detector, &left).empty());
+
+    const DirtyRect all{0, 0, 256, 256};
+    const std::vector<DirtyRect>& rects = surface.Update(detector, &all);
+    REQUIRE(rects.size() == 1);
+    CHECK(SameRect(rects[0], 192, 0, 64, 64));
+    CHECK(surface.Update(detector, &all).empty());
+}
+
+TEST_CASE(ResetAndResizeReportTheWholeSurface) {
+    Surface surface(256, 128);
+    TileChangeDetector detector;
+    surface.Update(detector);
+
+    detector.Reset();
+    const std::vector<DirtyRect>& afterReset = surface.Update(detector);
+    REQUIRE(afterReset.size() == 1);
+    CHECK(SameRect(afterReset[0], 0, 0, 256, 128));
+
+    Surface resized(128, 256);
+    const std::vector<DirtyRect>& afterResize = resized.Update(detector);
+    REQUIRE(afterResize.size() == 1);
+    CHECK(SameRect(afterResize[0], 0, 0, 128, 256));
+}
+
+TEST_CASE(ContentBoundsOfTransparentSurfaceIsEmpty) {
+    Surface surface(37, 20);
+    DirtyRect bounds;
+    CHECK(!FindContentBounds(surface.pixels.data(), surface.rowBytes, surface.width, surface.height, &bounds));
+
+    // Colour without alpha is still transparent.
+    surface.Set(5, 5, 0x00ffffffu);
+    CHECK(!FindContentBounds(surface.pixels.data(), surface.rowBytes, surface.width, surface.height, &bounds));
+}
+
+TEST_CASE(ContentBoundsRejectsInvalidArguments) {
+    Surface surface(16, 16);
+    DirtyRect bounds;
+    surface.Set(3, 3, 0xff000000u);
+    CHECK(!FindContentBounds(nullptr, surface.rowBytes, 16, 16, &bounds));
+    CHECK(!FindContentBounds(surface.pixels.data(), surface.rowBytes, 16, 16, nullptr));
+    CHECK(!FindContentBounds(surface.pixels.data(), 15 * 4, 16, 16, &bounds));
+    CHECK(!FindContentBounds(surface.pixels.data(), surface.rowBytes, 0, 16, &bounds));
+}
+
+TEST_CASE(ContentBoundsOfSinglePixelAtEveryColumn) {
+    // Odd width and padding exercise the vector loop and its scalar tail.
+    Surface surface(37, 5, 12);
+    for (uint32_t y = 0; y < surface.height; ++y) {
+        for (uint32_t x = 0; x < surface.width; ++x) {
+            std::fill(surface.pixels.begin(), surface.pixels.end(), 0);
+            surface.Set(x, y, 0x80000000u);
+            DirtyRect bounds;
+            REQUIRE(FindContentBounds(surface.pixels.data(), surface.rowBytes, surface.width, surface.height, &bounds));
+            CHECK(SameRect(bounds, x, y, 1, 1));
+        }
+    }
+}
+
+TEST_CASE(ContentBoundsIgnoresRowPadding) {
+    Surface surface(20, 10, 16);
+    for (uint32_t y = 0; y < surface.height; ++y) {
+        std::memset(surface.pixels.data() + y * surface.rowBytes + surface.width * 4, 0xff, 16);
+    }
+    surface.Set(4, 6, 0xff000000u);
+    DirtyRect bounds;
+    REQUIRE(FindContentBounds(surface.pixels.data(), surface.rowBytes, surface.width, surface.height, &bounds));
+    CHECK(SameRect(bounds, 4, 6, 1, 1));
+}
+
+TEST_CASE(ContentBoundsMatchesReferenceOnRandomSurfaces) {
+    std::mt19937 random(6);
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        Surface surface(1 + random() % 90, 1 + random() % 40, (random() % 3) * 4);
+        const uint32_t opaquePixels = random() % 6;
+        for (uint32_t i = 0; i < opaquePixels; ++i) {
+            surface.Set(random() % surface.width, random() % surface.height, (random() % 255 + 1) << 24);
+        }
+
+        DirtyRect expected;
+        DirtyRect actual;
+        const bool hasExpected = ReferenceContentBounds(surface, &expected);
+        const bool hasActual =
+            FindContentBounds(surface.pixels.data(), surface.rowBytes, surface.width, surface.height, &actual);
+        REQUIRE(hasActual == hasExpected);
+        if (hasExpected) {
+            CHECK(SameRect(actual, expected.x, expected.y, expected.width, expected.height));
+        }
+    }
+}
@@ -0,0 +1,249 @@
+#include "flutter_xr/engine_channel.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+#include "bench_support.h"
+
+using flutter_xr::EngineChannel;
+using flutter_xr::EngineMessage;
+using flutter_xr::EngineMessageType;
+using flutter_xr::SharedFrame;
+using flutter_xr::SharedFrameRing;
+using flutter_xr::SharedMessageQueue;
+using flutter_xr::SteadyClockNanos;
+
+// Streams frames and messages between this process and a copy of itself
+// started as the producer, the way the runner talks to its engine process.
+
+namespace {
+
+constexpr size_t kWidth = 1280;
+constexpr size_t kHeight = 720;
+constexpr size_t kRowBytes = kWidth * 4;
+constexpr size_t kFrameBytes = kRowBytes * kHeight;
+constexpr uint32_t kTimeoutMs = 5000;
+
+// Producer: publishes `frameCount` frames as fast as it can fill slots, then
+// answers pings until it is told to shut down.
+int RunProducer(const std::string& name, size_t frameCount) {
+    std::unique_ptr<EngineChannel> channel = EngineChannel::Open(name);
+    SharedFrameRing& frames = channel->Frames();
+    for (size_t i = 1; i <= frameCount; ++i) {
+        uint8_t* target = frames.BeginWrite(kRowBytes, kWidth, kHeight);
+        if (target == nullptr) {
+            throw std::runtime_error("benchmark frame does not fit the frame ring");
+        }
+        std::memset(target, static_cast<int>(i & 0xff), kFrameBytes);
+        frames.Publish(0);
+    }
+
+    SharedMessageQueue& toEngine = channel->ToEngine();
+    SharedMessageQueue& fromEngine = channel->FromEngine();
+    auto message = std::make_unique<EngineMessage>();
+    for (;;) {
+        while (toEngine.Pop(message.get())) {
+            if (message->type == EngineMessageType::Shutdown) {
+                return 0;
+            }
+            if (message->type == EngineMessageType::Ping) {
+                fromEngine.Push(EngineMessageType::Pong, message->generation, message->id, nullptr, 0,
+                                message->timestampNanos);
+            }
+        }
+        if (!toEngine.Signal().Wait(kTimeoutMs)) {
+            throw std::runtime_error("producer timed out waiting for the runner");
+        }
+    }
+}
+
+class ProducerProcess {
+   public:
+    ProducerProcess(const std::string& executable, const std::string& name, size_t frameCount) {
+        const std::string producerArgument = "--producer=" + name;
+        const std::string framesArgument = "--frames=" + std::to_string(frameCount);
+#if defined(_WIN32)
+        std::string commandLine = "\"" + executable + "\" " + producerArgument + " " + framesArgument;
+        STARTUPINFOA startup{};
+        startup.cb = sizeof(startup);
+        if (!CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup,
+                            &process_)) {
+            throw std::runtime_error("CreateProcessA failed. error=" + std::to_string(GetLastError()));
+        }
+        CloseHandle(process_.hThread);
+#else
+        std::vector<char*> argv = {const_cast<char*>(executable.c_str()), const_cast<char*>(producerArgument.c_str()),
+                                   const_cast<char*>(framesArgument.c_str()), nullptr};
+        const int error = posix_spawnp(&pid_, executable.c_str(), nullptr, nullptr, argv.data(), environ);
+        if (error != 0) {
+            throw std::runtime_error("posix_spawnp failed. error=" + std::to_string(error));
+        }
+#endif
+    }
+
+    ~ProducerProcess() { Join(); }
+
+    ProducerProcess(const ProducerProcess&) = delete;
+    ProducerProcess& operator=(const ProducerProcess&) = delete;
+
+    // Returns the producer's exit code.
+    int Join() {
+#if defined(_WIN32)
+        if (process_.hProcess == nullptr) {
+            return exitCode_;
+        }
+        WaitForSingleObject(process_.hProcess, INFINITE);
+        DWORD exitCode = 1;
+        GetExitCodeProcess(process_.hProcess, &exitCode);
+        CloseHandle(process_.hProcess);
+        process_.hProcess = nullptr;
+        exitCode_ = static_cast<int>(exitCode);
+#else
+        if (pid_ == 0) {
+            return exitCode_;
+        }
+        int status = 0;
+        waitpid(pid_, &status, 0);
+        pid_ = 0;
+        exitCode_ = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+#endif
+        return exitCode_;
+    }
+
+   private:
+#if defined(_WIN32)
+    PROCESS_INFORMATION process_{};
+#else
+    pid_t pid_ = 0;
+#endif
+    int exitCode_ = 1;
+};
+
+double PercentileMicros(std::vector<uint64_t>& nanos, double fraction) {
+    if (nanos.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(nanos.size() - 1, static_cast<size_t>(fraction * static_cast<double>(nanos.size())));
+    std::nth_element(nanos.begin(), nanos.begin() + static_cast<std::ptrdiff_t>(index), nanos.end());
+    return static_cast<double>(nanos[index]) / 1e3;
+}
+
+void ReportLatencies(const char* label, std::vector<uint64_t>& nanos) {
+    double total = 0.0;
+    for (uint64_t value : nanos) {
+        total += static_cast<double>(value);
+    }
+    const double meanMicros = nanos.empty() ? 0.0 : total / static_cast<double>(nanos.size()) / 1e3;
+    std::printf("  %-24s n=%-6zu mean=%8.1f p50=%8.1f p99=%8.1f max=%8.1f us\n", label, nanos.size(), meanMicros,
+                PercentileMicros(nanos, 0.5), PercentileMicros(nanos, 0.99), PercentileMicros(nanos, 1.0));
+}
+
+int RunConsumer(const std::string& executable, size_t frameCount, size_t pingCount) {
+    const std::string name = "flutter_xr_channel_bench_" + std::to_string(SteadyClockNanos());
+    std::unique_ptr<EngineChannel> channel = EngineChannel::Create(name, kFrameBytes);
+    ProducerProcess producer(executable, name, frameCount);
+
+    // Frames: the runner reads every cache line of each frame it gets, in
+    // place, as the upload would.
+    SharedFrameRing& frames = channel->Frames();
+    std::vector<uint64_t> frameLatencies;
+    frameLatencies.reserve(frameCount);
+    uint64_t firstSequence = 0;
+    uint64_t firstPublishNanos = 0;
+    uint64_t lastPublishNanos = 0;
+    uint64_t checksum = 0;
+    SharedFrame frame;
+    while (frame.sequence < frameCount) {
+        if (!frames.AcquireLatest(&frame)) {
+            if (!frames.WaitForFrame(kTimeoutMs)) {
+                throw std::runtime_error("timed out waiting for frames");
+            }
+            continue;
+        }
+        frameLatencies.push_back(SteadyClockNanos() - frame.publishNanos);
+        for (size_t offset = 0; offset < frame.rowBytes * frame.height; offset += 64) {
+            checksum += frame.pixels[offset];
+        }
+        if (firstSequence == 0) {
+            firstSequence = frame.sequence;
+            firstPublishNanos = frame.publishNanos;
+        }
+        lastPublishNanos = frame.publishNanos;
+    }
+
+    // Messages: round trips through both queues.
+    SharedMessageQueue& toEngine = channel->ToEngine();
+    SharedMessageQueue& fromEngine = channel->FromEngine();
+    auto reply = std::make_unique<EngineMessage>();
+    std::vector<uint64_t> roundTrips;
+    roundTrips.reserve(pingCount);
+    for (size_t i = 0; i < pingCount; ++i) {
+        const uint64_t sentNanos = SteadyClockNanos();
+        if (!toEngine.Push(EngineMessageType::Ping, 0, i, nullptr, 0, sentNanos)) {
+            throw std::runtime_error("could not queue a ping");
+        }
+        while (!fromEngine.Pop(reply.get()) || reply->type != EngineMessageType::Pong || reply->id != i) {
+            if (!fromEngine.Signal().Wait(kTimeoutMs)) {
+                throw std::runtime_error("timed out waiting for a pong");
+            }
+        }
+        roundTrips.push_back(SteadyClockNanos() - sentNanos);
+    }
+    toEngine.Push(EngineMessageType::Shutdown, 0, 0, nullptr, 0);
+    if (producer.Join() != 0) {
+        throw std::runtime_error("producer process failed");
+    }
+
+    const double spanSeconds = static_cast<double>(lastPublishNanos - firstPublishNanos) / 1e9;
+    const double publishedFrames = static_cast<double>(frame.sequence - firstSequence);
+    const double framesPerSecond = spanSeconds > 0.0 ? publishedFrames / spanSeconds : 0.0;
+    std::printf("%zu frames of %zux%zu\n", frameCount, kWidth, kHeight);
+    std::printf("  %-24s %8.1f frames/s  %6.2f GB/s written\n", "throughput", framesPerSecond,
+                framesPerSecond * static_cast<double>(kFrameBytes) / 1e9);
+    std::printf("  %-24s delivered=%zu skipped=%llu checksum=%llu\n", "frames", frameLatencies.size(),
+                static_cast<unsigned long long>(frames.SkippedFrameCount()), static_cast<unsigned long long>(checksum));
+    ReportLatencies("publish-to-read latency", frameLatencies);
+    ReportLatencies("message round trip", roundTrips);
+    return 0;
+}
+
+const char* OptionValue(int argc, char** argv, const char* prefix) {
+    const size_t length = std::strlen(prefix);
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], prefix, length) == 0) {
+            return argv[i] + length;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const char* frames = OptionValue(argc, argv, "--frames=");
+        if (const char* producer = OptionValue(argc, argv, "--producer=")) {
+            return RunProducer(producer, frames != nullptr ? std::stoul(frames) : 0);
+        }
+        const bool quick = flutter_xr_bench::QuickMode(argc, argv);
+        const size_t frameCount = frames != nullptr ? std::stoul(frames) : (quick ? 60 : 2000);
+        return RunConsumer(argv[0], frameCount, quick ? 100 : 1000);
+    } catch (const std::exception& error) {
+        std::fprintf(stderr, "engine_channel_bench: %s\n", error.what());
+        return 1;
+    }
+}
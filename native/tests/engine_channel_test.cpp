@@ -0,0 +1,314 @@
+#include "flutter_xr/engine_channel.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "test_support.h"
+
+using flutter_xr::EngineChannel;
+using flutter_xr::EngineMessage;
+using flutter_xr::EngineMessageType;
+using flutter_xr::SharedFrame;
+using flutter_xr::SharedFrameRing;
+using flutter_xr::SharedMemoryMapping;
+using flutter_xr::SharedSignal;
+using flutter_xr::SharedSignalWord;
+
+namespace {
+
+constexpr size_t kWidth = 64;
+constexpr size_t kHeight = 32;
+constexpr size_t kRowBytes = kWidth * 4 + 32;
+constexpr size_t kCapacityBytes = kRowBytes * kHeight;
+
+// Channels of earlier or concurrent runs must not collide with this one.
+std::string UniqueName(const char* label) {
+    return std::string("flutter_xr_channel_test_") + label + "_" + std::to_string(flutter_xr::SteadyClockNanos());
+}
+
+// SharedChannelHeader as engine_channel.cpp lays it out, so the tests can
+// write what a compromised engine process could.
+struct ForgedSlot {
+    uint64_t sequence;
+    uint64_t rowBytes;
+    uint64_t width;
+    uint64_t height;
+    uint64_t publishNanos;
+    uint64_t rasterNanos;
+};
+
+struct ForgedHeader {
+    uint32_t magic;
+    uint32_t layoutVersion;
+    uint32_t messageBytes;
+    uint64_t frameCapacityBytes;
+    uint64_t slotStrideBytes;
+    uint64_t toEngineOffset;
+    uint64_t fromEngineOffset;
+    uint64_t pixelsOffset;
+    uint64_t mappedBytes;
+    alignas(64) std::atomic<uint32_t> pendingState;
+    std::atomic<uint32_t> consumerIndex;
+    std::atomic<uint64_t> publishedCount;
+    ForgedSlot slots[SharedFrameRing::kSlotCount];
+};
+
+constexpr uint32_t kFreshBit = 0x4u;
+
+void PublishFrame(SharedFrameRing& frames, uint8_t value) {
+    uint8_t* pixels = frames.BeginWrite(kRowBytes, kWidth, kHeight);
+    if (pixels != nullptr) {
+        std::memset(pixels, value, kCapacityBytes);
+        frames.Publish(value);
+    }
+}
+
+}  // namespace
+
+TEST_CASE(OpenedChannelSharesFramesWithItsCreator) {
+    const std::string name = UniqueName("frames");
+    std::unique_ptr<EngineChannel> runner = EngineChannel::Create(name, kCapacityBytes);
+    std::unique_ptr<EngineChannel> engine = EngineChannel::Open(name);
+    CHECK(runner->Frames().CapacityBytes() == kCapacityBytes);
+    CHECK(engine->MappedBytes() == runner->MappedBytes());
+
+    SharedFrame frame;
+    CHECK(!runner->Frames().AcquireLatest(&frame));
+    PublishFrame(engine->Frames(), 7);
+    REQUIRE(runner->Frames().AcquireLatest(&frame));
+    CHECK(frame.sequence == 1);
+    CHECK(frame.width == kWidth && frame.height == kHeight && frame.rowBytes == kRowBytes);
+    CHECK(frame.rasterNanos == 7);
+    CHECK(frame.pixels[0] == 7 && frame.pixels[kCapacityBytes - 1] == 7);
+    CHECK(!runner->Frames().AcquireLatest(&frame));
+}
+
+TEST_CASE(OnlyTheNewestFrameIsDeliveredAndSkipsAreCounted) {
+    const std::string name = UniqueName("skips");
+    std::unique_ptr<EngineChannel> runner = EngineChannel::Create(name, kCapacityBytes);
+    std::unique_ptr<EngineChannel> engine = EngineChannel::Open(name);
+
+    for (uint8_t value = 1; value <= 5; ++value) {
+        PublishFrame(engine->Frames(), value);
+    }
+    SharedFrame frame;
+    REQUIRE(runner->Frames().AcquireLatest(&frame));
+    CHECK(frame.sequence == 5);
+    CHECK(frame.pixels[0] == 5);
+    CHECK(runner->Frames().SkippedFrameCount() == 4);
+    CHECK(engine->Frames().PublishedFrameCount() == 5);
+}
+
+TEST_CASE(FramesLargerThanTheSlotsAreRefused) {
+    std::unique_ptr<EngineChannel> channel = EngineChannel::Create(UniqueName("refuse"), kCapacityBytes);
+    SharedFrameRing& frames = channel->Frames();
+    CHECK(frames.BeginWrite(kRowBytes, kWidth, kHeight + 1) == nullptr);
+    CHECK(frames.BeginWrite(kWidth * 4 - 1, kWidth, kHeight) == nullptr);
+    CHECK(frames.BeginWrite(kRowBytes, kWidth, 0) == nullptr);
+    CHECK(frames.BeginWrite(kRowBytes, kWidth, kHeight) != nullptr);
+}
+
+TEST_CASE(MessagesCrossInBothDirections) {
+    const std::string name = UniqueName("messages");
+    std::unique_ptr<EngineChannel> runner = EngineChannel::Create(name, kCapacityBytes);
+    std::unique_ptr<EngineChannel> engine = EngineChannel::Open(name);
+    auto message = std::make_unique<EngineMessage>();
+
+    const char payload[] = "flutter/platform";
+    REQUIRE(runner->ToEngine().Push(EngineMessageType::PlatformResponse, 3, 42, payload, sizeof(payload), 9));
+    REQUIRE(engine->ToEngine().Pop(message.get()));
+    CHECK(message->type == EngineMessageType::PlatformResponse);
+    CHECK(message->generation == 3 && message->id == 42 && message->timestampNanos == 9);
+    CHECK(message->size == sizeof(payload) && std::memcmp(message->payload, payload, sizeof(payload)) == 0);
+    CHECK(!engine->ToEngine().Pop(message.get()));
+
+    REQUIRE(engine->FromEngine().Push(EngineMessageType::Pong, 3, 42, nullptr, 0));
+    REQUIRE(runner->FromEngine().Pop(message.get()));
+    CHECK(message->type == EngineMessageType::Pong && message->size == 0);
+}
+
+TEST_CASE(QueueRefusesOversizedPayloadsAndOverflow) {
+    std::unique_ptr<EngineChannel> channel = EngineChannel::Create(UniqueName("overflow"), kCapacityBytes);
+    std::string tooLarge(flutter_xr::kEngineMessagePayloadBytes + 1, 'x');
+    CHECK(!channel->ToEngine().Push(EngineMessageType::PlatformResponse, 0, 0, tooLarge.data(), tooLarge.size()));
+
+    for (uint32_t i = 0; i < flutter_xr::kEngineMessageQueueCapacity; ++i) {
+        CHECK(channel->ToEngine().Push(EngineMessageType::Ping, 0, i, nullptr, 0));
+    }
+    CHECK(!channel->ToEngine().Push(EngineMessageType::Ping, 0, 0, nullptr, 0));
+
+    auto message = std::make_unique<EngineMessage>();
+    REQUIRE(channel->ToEngine().Pop(message.get()));
+    CHECK(message->id == 0);
+    CHECK(channel->ToEngine().Push(EngineMessageType::Ping, 0, 0, nullptr, 0));
+}
+
+TEST_CASE(SignalIsAutoResetAndTimesOut) {
+    SharedSignalWord word;
+    std::unique_ptr<SharedSignal> signal = SharedSignal::Create(UniqueName("signal"), &word);
+    CHECK(!signal->Wait(10));
+    signal->Set();
+    signal->Set();
+    CHECK(signal->Wait(0));
+    CHECK(!signal->Wait(0));
+}
+
+TEST_CASE(SignalWakesAWaiterOnAnotherThread) {
+    const std::string name = UniqueName("wake");
+    std::unique_ptr<EngineChannel> runner = EngineChannel::Create(name, kCapacityBytes);
+    std::unique_ptr<EngineChannel> engine = EngineChannel::Open(name);
+
+    std::atomic<bool> woke{false};
+    std::thread waiter([&] { woke.store(runner->Frames().WaitForFrame(5000), std::memory_order_release); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    PublishFrame(engine->Frames(), 1);
+    waiter.join();
+    CHECK(woke.load(std::memory_order_acquire));
+}
+
+TEST_CASE(ChannelNamesAreExclusive) {
+    const std::string name = UniqueName("exclusive");
+    std::unique_ptr<EngineChannel> channel = EngineChannel::Create(name, kCapacityBytes);
+    bool threw = false;
+    try {
+        EngineChannel::Create(name, kCapacityBytes);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+TEST_CASE(OpenRejectsMissingAndForeignMappings) {
+    bool threw = false;
+    try {
+        EngineChannel::Open(UniqueName("missing"));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    // Zeroed memory has neither the magic nor the layout version.
+    const std::string name = UniqueName("foreign");
+    std::unique_ptr<SharedMemoryMapping> foreign = SharedMemoryMapping::Create(name, 1 << 16);
+    threw = false;
+    try {
+        EngineChannel::Open(name);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+TEST_CASE(RunnerKeepsItsOwnFrameCapacity) {
+    const std::string name = UniqueName("capacity");
+    std::unique_ptr<EngineChannel> runner = EngineChannel::Create(name, kCapacityBytes);
+    std::unique_ptr<SharedMemoryMapping> forger = SharedMemoryMapping::Open(name);
+    auto* header = static_cast<ForgedHeader*>(forger->Data());
+    REQUIRE(header->frameCapacityBytes == kCapacityBytes && header->slotStrideBytes > kCapacityBytes);
+
+    // The engine believes the header and writes past the runner's capacity,
+    // though still inside the slot stride.
+    header->frameCapacityBytes = header->slotStrideBytes;
+    std::unique_ptr<EngineChannel> engine = EngineChannel::Open(name);
+    const size_t height = static_cast<size_t>(header->slotStrideBytes) / kRowBytes;
+    REQUIRE(height > kHeight);
+    REQUIRE(engine->Frames().BeginWrite(kRowBytes, kWidth, height) != nullptr);
+    engine->Frames().Publish(0);
+
+    SharedFrame frame;
+    CHECK(!runner->Frames().AcquireLatest(&frame));
+    CHECK(runner->Frames().RejectedFrameCount() == 1);
+    CHECK(runner->Frames().CapacityBytes() == kCapacityBytes);
+}
+
+TEST_CASE(SlotIndicesOutsideTheRingAreRejected) {
+    const std::string name = UniqueName("index");
+    std::unique_ptr<EngineChannel> runner = EngineChannel::Create(name, kCapacityBytes);
+    std::unique_ptr<EngineChannel> engine = EngineChannel::Open(name);
+    std::unique_ptr<SharedMemoryMapping> forger = SharedMemoryMapping::Open(name);
+    auto* header = static_cast<ForgedHeader*>(forger->Data());
+
+    // The runner holds slot 1; neither a slot past the ring nor the held one
+    // may take it away, and what is put back is never the held slot.
+    const uint32_t held = header->consumerIndex.load();
+    const uint32_t forgeries[] = {SharedFrameRing::kSlotCount, held};
+    SharedFrame frame;
+    uint64_t rejected = 0;
+    for (uint32_t index : forgeries) {
+        header->pendingState.store(index | kFreshBit);
+        CHECK(!runner->Frames().AcquireLatest(&frame));
+        CHECK(runner->Frames().RejectedFrameCount() == ++rejected);
+        const uint32_t returned = header->pendingState.load();
+        CHECK((returned & kFreshBit) == 0);
+        CHECK(returned < SharedFrameRing::kSlotCount && returned != held);
+        CHECK(header->consumerIndex.load() == held);
+    }
+
+    // The ring keeps working once the producer behaves again.
+    PublishFrame(engine->Frames(), 3);
+    REQUIRE(runner->Frames().AcquireLatest(&frame));
+    CHECK(frame.pixels[0] == 3);
+}
+
+TEST_CASE(RestartedProducerWaitsForTheConsumerToFinishASwap) {
+    const std::string name = UniqueName("restart");
+    std::unique_ptr<EngineChannel> runner = EngineChannel::Create(name, kCapacityBytes);
+    std::unique_ptr<SharedMemoryMapping> forger = SharedMemoryMapping::Open(name);
+    auto* header = static_cast<ForgedHeader*>(forger->Data());
+    REQUIRE(header->pendingState.load() == 2 && header->consumerIndex.load() == 1);
+
+    // The consumer has swapped slot 1 into pendingState but not yet stored
+    // slot 2 as its own; slot 0 stays the producer's throughout.
+    header->pendingState.store(1);
+    std::thread consumer([header] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        header->consumerIndex.store(2);
+    });
+    std::unique_ptr<EngineChannel> engine = EngineChannel::Open(name);
+    consumer.join();
+
+    PublishFrame(engine->Frames(), 7);
+    CHECK(header->pendingState.load() == (0u | kFreshBit));
+    CHECK(header->slots[0].sequence == 1);
+}
+
+TEST_CASE(FrameSizesThatDoNotFitAreRejected) {
+    const std::string name = UniqueName("size");
+    std::unique_ptr<EngineChannel> runner = EngineChannel::Create(name, kCapacityBytes);
+    std::unique_ptr<EngineChannel> engine = EngineChannel::Open(name);
+    std::unique_ptr<SharedMemoryMapping> forger = SharedMemoryMapping::Open(name);
+    auto* header = static_cast<ForgedHeader*>(forger->Data());
+
+    struct Forgery {
+        uint64_t rowBytes;
+        uint64_t width;
+        uint64_t height;
+    };
+    const Forgery forgeries[] = {
+        {kWidth * 4 - 4, kWidth, kHeight},            // rows narrower than the frame
+        {kRowBytes, kWidth, kHeight + 1},             // one row past the capacity
+        {kRowBytes, kWidth, 0},                       // empty
+        {uint64_t{1} << 62, kWidth, 8},               // rowBytes * height wraps to zero
+        {kRowBytes, uint64_t{1} << 62, kHeight},      // width * 4 wraps
+    };
+    SharedFrame frame;
+    uint64_t rejected = 0;
+    for (const Forgery& forgery : forgeries) {
+        PublishFrame(engine->Frames(), 1);
+        ForgedSlot& slot = header->slots[header->pendingState.load() & 0x3u];
+        slot.rowBytes = forgery.rowBytes;
+        slot.width = forgery.width;
+        slot.height = forgery.height;
+        CHECK(!runner->Frames().AcquireLatest(&frame));
+        CHECK(runner->Frames().RejectedFrameCount() == ++rejected);
+    }
+
+    PublishFrame(engine->Frames(), 2);
+    REQUIRE(runner->Frames().AcquireLatest(&frame));
+    CHECK(frame.rowBytes == kRowBytes && frame.height == kHeight && frame.pixels[0] == 2);
+}
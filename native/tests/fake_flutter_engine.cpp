@@ -0,0 +1,40 @@
+#include "fake_flutter_engine.h"
+
+#include <chrono>
+#include <mutex>
+
+#include "flutter_embedder.h"
+
+// The tests link the runner's embedder-facing modules without the engine
+// library; these stand in for the engine entry points those modules call.
+
+namespace {
+
+std::mutex gRunTaskMutex;
+std::vector<uint64_t> gRunTaskIds;
+
+}  // namespace
+
+std::vector<uint64_t> flutter_xr_test::TakeRunTaskIds() {
+    std::lock_guard<std::mutex> lock(gRunTaskMutex);
+    std::vector<uint64_t> ids;
+    ids.swap(gRunTaskIds);
+    return ids;
+}
+
+uint64_t FlutterEngineGetCurrentTime() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+FlutterEngineResult FlutterEngineSendPointerEvent(FlutterEngine engine, const FlutterPointerEvent* events, size_t count) {
+    return engine != nullptr && events != nullptr && count > 0 ? kSuccess : kInvalidArguments;
+}
+
+FlutterEngineResult FlutterEngineRunTask(FlutterEngine engine, const FlutterTask* task) {
+    if (task != nullptr) {
+        std::lock_guard<std::mutex> lock(gRunTaskMutex);
+        gRunTaskIds.push_back(task->task);
+    }
+    return engine != nullptr && task != nullptr ? kSuccess : kInvalidArguments;
+}
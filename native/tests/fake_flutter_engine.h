@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace flutter_xr_test {
+
+// FlutterTask::task values passed to the fake FlutterEngineRunTask, in the
+// order it was called. Returns and clears the record.
+std::vector<uint64_t> TakeRunTaskIds();
+
+}  // namespace flutter_xr_test
@@ -0,0 +1,165 @@
+#include "flutter_xr/frame_mailbox.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bench_support.h"
+
+using flutter_xr::FrameMailbox;
+using flutter_xr::FrameSlot;
+using flutter_xr_bench::DoNotOptimize;
+using flutter_xr_bench::NowSeconds;
+
+namespace {
+
+constexpr size_t kWidth = 1280;
+constexpr size_t kHeight = 720;
+constexpr size_t kRowBytes = kWidth * 4;
+constexpr size_t kFrameBytes = kRowBytes * kHeight;
+
+struct StreamResult {
+    double producedPerSecond = 0.0;
+    double consumedPerSecond = 0.0;
+    double producerStallSeconds = 0.0;
+};
+
+// Reads one byte per cache line, standing in for the upload of the frame.
+uint64_t TouchFrame(const uint8_t* pixels) {
+    uint64_t sum = 0;
+    for (size_t offset = 0; offset < kFrameBytes; offset += 64) {
+        sum += pixels[offset];
+    }
+    return sum;
+}
+
+// The handoff this runner used before the mailbox: the raster thread copies
+// into a shared vector under a mutex and the render thread copies it out
+// into a snapshot under the same mutex.
+class LockedFrameCopy {
+   public:
+    void Present(const uint8_t* pixels) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pixels_.resize(kFrameBytes);
+        std::memcpy(pixels_.data(), pixels, kFrameBytes);
+        ++frameIndex_;
+    }
+
+    bool TakeSnapshot(std::vector<uint8_t>& snapshot, uint64_t& lastFrameIndex) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frameIndex_ == lastFrameIndex) {
+            return false;
+        }
+        snapshot = pixels_;
+        lastFrameIndex = frameIndex_;
+        return true;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::vector<uint8_t> pixels_;
+    uint64_t frameIndex_ = 0;
+};
+
+template <typename Produce, typename Consume>
+StreamResult RunStream(double durationSeconds, Produce&& produce, Consume&& consume) {
+    std::atomic<bool> done{false};
+    uint64_t produced = 0;
+    double stallSeconds = 0.0;
+    const double start = NowSeconds();
+
+    std::thread producer([&] {
+        while (NowSeconds() - start < durationSeconds) {
+            stallSeconds += produce(produced);
+            ++produced;
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t consumed = 0;
+    while (!done.load(std::memory_order_acquire)) {
+        consumed += consume() ? 1 : 0;
+    }
+    producer.join();
+
+    const double elapsed = NowSeconds() - start;
+    return {produced / elapsed, consumed / elapsed, produced > 0 ? stallSeconds / produced : 0.0};
+}
+
+StreamResult StreamThroughMailbox(double durationSeconds) {
+    FrameMailbox mailbox(kFrameBytes);
+    return RunStream(
+        durationSeconds,
+        [&](uint64_t frameIndex) {
+            uint8_t* pixels = mailbox.BeginWrite(kRowBytes, kWidth, kHeight);
+            std::memset(pixels, static_cast<int>(frameIndex & 0xff), kFrameBytes);
+            const double publishStart = NowSeconds();
+            mailbox.Publish();
+            return NowSeconds() - publishStart;
+        },
+        [&] {
+            const FrameSlot* slot = mailbox.AcquireLatest();
+            if (slot == nullptr) {
+                std::this_thread::yield();
+                return false;
+            }
+            DoNotOptimize(TouchFrame(slot->pixels.get()));
+            return true;
+        });
+}
+
+StreamResult StreamThroughLockedCopy(double durationSeconds) {
+    LockedFrameCopy shared;
+    std::vector<uint8_t> rendered(kFrameBytes);
+    std::vector<uint8_t> snapshot;
+    uint64_t lastFrameIndex = 0;
+    return RunStream(
+        durationSeconds,
+        [&](uint64_t frameIndex) {
+            std::memset(rendered.data(), static_cast<int>(frameIndex & 0xff), kFrameBytes);
+            const double presentStart = NowSeconds();
+            shared.Present(rendered.data());
+            return NowSeconds() - presentStart;
+        },
+        [&] {
+            if (!shared.TakeSnapshot(snapshot, lastFrameIndex)) {
+                std::this_thread::yield();
+                return false;
+            }
+            DoNotOptimize(TouchFrame(snapshot.data()));
+            return true;
+        });
+}
+
+void PrintStream(const char* name, const StreamResult& result) {
+    std::printf("%-12s produced %8.1f frames/s  consumed %8.1f frames/s  producer blocked %8.2f us/frame\n", name,
+                result.producedPerSecond, result.consumedPerSecond, result.producerStallSeconds * 1e6);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = flutter_xr_bench::QuickMode(argc, argv);
+    const double durationSeconds = quick ? 0.1 : 2.0;
+
+    // Handoff cost alone, with no pixels written or read.
+    FrameMailbox mailbox(16);
+    const size_t handoffs = quick ? 100000 : 10000000;
+    const flutter_xr_bench::Timing handoff = flutter_xr_bench::Measure(5, [&] {
+        for (size_t i = 0; i < handoffs; ++i) {
+            mailbox.BeginWrite(16, 4, 1);
+            mailbox.Publish();
+            DoNotOptimize(mailbox.AcquireLatest());
+        }
+    });
+    std::printf("publish+acquire: %.2f ns per frame\n", handoff.bestSeconds / handoffs * 1e9);
+
+    std::printf("%zux%zu frames, %.1f s per run, %u hardware threads\n", kWidth, kHeight, durationSeconds,
+                std::thread::hardware_concurrency());
+    PrintStream("mailbox", StreamThroughMailbox(durationSeconds));
+    PrintStream("locked copy", StreamThroughLockedCopy(durationSeconds));
+    return 0;
+}
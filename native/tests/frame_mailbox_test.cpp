@@ -0,0 +1,153 @@
+#include "flutter_xr/frame_mailbox.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "test_support.h"
+
+using flutter_xr::FrameMailbox;
+using flutter_xr::FrameSlot;
+
+namespace {
+
+struct FrameShape {
+    size_t width;
+    size_t height;
+    size_t rowBytes;
+};
+
+// Frame sizes and row padding change from frame to frame so a slot handed
+// out with the wrong metadata shows up as a pattern mismatch.
+FrameShape ShapeOf(uint64_t frameIndex) {
+    const size_t width = 16 + frameIndex % 17;
+    const size_t height = 8 + frameIndex % 5;
+    return {width, height, width * 4 + (frameIndex % 3) * 16};
+}
+
+constexpr size_t kStressCapacityBytes = (32 * 4 + 32) * 12;
+
+void FillFrame(uint8_t* pixels, const FrameShape& shape, uint64_t frameIndex) {
+    const uint32_t value = static_cast<uint32_t>(frameIndex * 2654435761u);
+    for (size_t y = 0; y < shape.height; ++y) {
+        for (size_t x = 0; x < shape.width; ++x) {
+            const uint32_t pixel = value ^ static_cast<uint32_t>(y * 131 + x);
+            std::memcpy(pixels + y * shape.rowBytes + x * 4, &pixel, sizeof(pixel));
+        }
+    }
+}
+
+bool FrameMatches(const FrameSlot& slot) {
+    const FrameShape shape = ShapeOf(slot.frameIndex);
+    if (slot.width != shape.width || slot.height != shape.height || slot.rowBytes != shape.rowBytes) {
+        return false;
+    }
+    const uint32_t value = static_cast<uint32_t>(slot.frameIndex * 2654435761u);
+    for (size_t y = 0; y < shape.height; ++y) {
+        for (size_t x = 0; x < shape.width; ++x) {
+            uint32_t pixel = 0;
+            std::memcpy(&pixel, slot.pixels.get() + y * shape.rowBytes + x * 4, sizeof(pixel));
+            if (pixel != (value ^ static_cast<uint32_t>(y * 131 + x))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void PublishFrame(FrameMailbox& mailbox, uint64_t frameIndex) {
+    const FrameShape shape = ShapeOf(frameIndex);
+    uint8_t* pixels = mailbox.BeginWrite(shape.rowBytes, shape.width, shape.height);
+    if (pixels != nullptr) {
+        FillFrame(pixels, shape, frameIndex);
+        mailbox.Publish();
+    }
+}
+
+}  // namespace
+
+TEST_CASE(EmptyMailboxHasNoFrame) {
+    FrameMailbox mailbox(1024);
+    CHECK(mailbox.AcquireLatest() == nullptr);
+    CHECK(mailbox.PublishedFrameCount() == 0);
+}
+
+TEST_CASE(BeginWriteRejectsFramesThatDoNotFit) {
+    FrameMailbox mailbox(64 * 4 * 4);
+    CHECK(mailbox.BeginWrite(64 * 4, 64, 4) != nullptr);
+    CHECK(mailbox.BeginWrite(64 * 4, 64, 5) == nullptr);
+    CHECK(mailbox.BeginWrite(63 * 4, 64, 1) == nullptr);
+    CHECK(mailbox.BeginWrite(64 * 4, 64, 0) == nullptr);
+}
+
+TEST_CASE(AcquireReturnsNewestFrameOnce) {
+    FrameMailbox mailbox(kStressCapacityBytes);
+    PublishFrame(mailbox, 1);
+    PublishFrame(mailbox, 2);
+    PublishFrame(mailbox, 3);
+
+    const FrameSlot* slot = mailbox.AcquireLatest();
+    REQUIRE(slot != nullptr);
+    CHECK(slot->frameIndex == 3);
+    CHECK(FrameMatches(*slot));
+    CHECK(mailbox.OverwrittenFrameCount() == 2);
+    CHECK(mailbox.AcquireLatest() == nullptr);
+
+    PublishFrame(mailbox, 4);
+    slot = mailbox.AcquireLatest();
+    REQUIRE(slot != nullptr);
+    CHECK(slot->frameIndex == 4);
+    CHECK(FrameMatches(*slot));
+}
+
+TEST_CASE(AcquiredSlotSurvivesFurtherPublishes) {
+    FrameMailbox mailbox(kStressCapacityBytes);
+    PublishFrame(mailbox, 1);
+    const FrameSlot* held = mailbox.AcquireLatest();
+    REQUIRE(held != nullptr);
+
+    for (uint64_t frameIndex = 2; frameIndex < 50; ++frameIndex) {
+        PublishFrame(mailbox, frameIndex);
+    }
+    CHECK(held->frameIndex == 1);
+    CHECK(FrameMatches(*held));
+}
+
+// One producer and one consumer hammer the mailbox. Every frame the consumer
+// sees must be complete, newer than the previous one, and every published
+// frame must be either consumed or counted as overwritten.
+TEST_CASE(ConcurrentProducerAndConsumerNeverTearFrames) {
+    constexpr uint64_t kFrameCount = 200000;
+    FrameMailbox mailbox(kStressCapacityBytes);
+    std::atomic<bool> producerDone{false};
+
+    std::thread producer([&] {
+        for (uint64_t frameIndex = 1; frameIndex <= kFrameCount; ++frameIndex) {
+            PublishFrame(mailbox, frameIndex);
+        }
+        producerDone.store(true, std::memory_order_release);
+    });
+
+    uint64_t consumed = 0;
+    uint64_t lastFrameIndex = 0;
+    size_t tornFrames = 0;
+    size_t outOfOrderFrames = 0;
+    for (;;) {
+        const bool done = producerDone.load(std::memory_order_acquire);
+        if (const FrameSlot* slot = mailbox.AcquireLatest()) {
+            ++consumed;
+            tornFrames += FrameMatches(*slot) ? 0 : 1;
+            outOfOrderFrames += slot->frameIndex > lastFrameIndex ? 0 : 1;
+            lastFrameIndex = slot->frameIndex;
+        } else if (done) {
+            break;
+        }
+    }
+    producer.join();
+
+    CHECK(tornFrames == 0);
+    CHECK(outOfOrderFrames == 0);
+    CHECK(lastFrameIndex == kFrameCount);
+    CHECK(mailbox.PublishedFrameCount() == kFrameCount);
+    CHECK(consumed + mailbox.OverwrittenFrameCount() == kFrameCount);
+}
@@ -0,0 +1,94 @@
+#include "flutter_xr/panel_hit.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "bench_support.h"
+
+using flutter_xr::IntersectRayWithQuad;
+using flutter_xr::PanelHit;
+using flutter_xr::PanelHitTester;
+using flutter_xr::PanelRay;
+
+namespace {
+
+struct Panel {
+    XrPosef pose;
+    float width;
+    float height;
+};
+
+// Panels on an arc around the viewer, as MakePanelPose places them.
+std::vector<Panel> ArcPanels(size_t count) {
+    std::vector<Panel> panels;
+    const float step = 0.9f;
+    for (size_t i = 0; i < count; ++i) {
+        const float angle = (static_cast<float>(i) - static_cast<float>(count - 1) * 0.5f) * step / count;
+        Panel panel;
+        panel.pose.orientation = {0.0f, std::sin(-angle * 0.5f), 0.0f, std::cos(-angle * 0.5f)};
+        panel.pose.position = {1.2f * std::sin(angle), 0.0f, -1.2f * std::cos(angle)};
+        panel.width = 1.2f;
+        panel.height = 0.675f;
+        panels.push_back(panel);
+    }
+    return panels;
+}
+
+// Two controllers plus head gaze, sweeping across the arc.
+std::vector<PanelRay> SweepRays(size_t count) {
+    std::vector<PanelRay> rays(count);
+    for (size_t i = 0; i < count; ++i) {
+        const float yaw = -1.0f + 2.0f * static_cast<float>(i) / static_cast<float>(count);
+        rays[i].origin = {static_cast<float>(i % 3) * 0.2f - 0.2f, -0.2f, -0.3f};
+        rays[i].direction = {std::sin(yaw), 0.05f, -std::cos(yaw)};
+    }
+    return rays;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = flutter_xr_bench::QuickMode(argc, argv);
+    const size_t repetitions = quick ? 3 : 20;
+    const std::vector<PanelRay> rays = SweepRays(quick ? 300 : 3000);
+
+    std::printf("%zu rays per run\n", rays.size());
+    for (size_t count : {size_t{1}, size_t{3}, size_t{4}, size_t{7}, size_t{16}, size_t{64}}) {
+        const std::vector<Panel> panels = ArcPanels(count);
+        PanelHitTester tester;
+        for (const Panel& panel : panels) {
+            tester.AddPanel(panel.pose, panel.width, panel.height);
+        }
+        std::vector<PanelHit> hits(rays.size());
+
+        const double testerSeconds = flutter_xr_bench::Measure(repetitions, [&] {
+            tester.Intersect(rays.data(), rays.size(), hits.data());
+            flutter_xr_bench::DoNotOptimize(hits.back().panel);
+        }).bestSeconds;
+
+        // The per-panel loop the runner used before PanelHitTester.
+        const double referenceSeconds = flutter_xr_bench::Measure(repetitions, [&] {
+            for (size_t r = 0; r < rays.size(); ++r) {
+                PanelHit nearest;
+                for (size_t i = 0; i < panels.size(); ++i) {
+                    float distance = 0.0f;
+                    double u = 0.0;
+                    double v = 0.0;
+                    if (IntersectRayWithQuad(rays[r].origin, rays[r].direction, panels[i].pose, panels[i].width,
+                                             panels[i].height, &distance, &u, &v) &&
+                        (nearest.panel < 0 || distance < nearest.distance)) {
+                        nearest = {static_cast<int32_t>(i), distance, static_cast<float>(u), static_cast<float>(v)};
+                    }
+                }
+                hits[r] = nearest;
+            }
+            flutter_xr_bench::DoNotOptimize(hits.back().panel);
+        }).bestSeconds;
+
+        std::printf("%3zu panels: PanelHitTester %8.1f ns/ray   IntersectRayWithQuad loop %8.1f ns/ray  %5.2fx\n",
+                    count, testerSeconds / rays.size() * 1e9, referenceSeconds / rays.size() * 1e9,
+                    referenceSeconds / testerSeconds);
+    }
+    return 0;
+}
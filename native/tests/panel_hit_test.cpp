@@ -0,0 +1,239 @@
+#include "flutter_xr/panel_hit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "flutter_xr/xr_math.h"
+#include "test_support.h"
+
+using flutter_xr::IntersectRayWithQuad;
+using flutter_xr::PanelHit;
+using flutter_xr::PanelHitTester;
+using flutter_xr::PanelRay;
+
+namespace {
+
+struct Panel {
+    XrPosef pose;
+    float width;
+    float height;
+};
+
+// Results within this of a panel edge or of another panel's distance may
+// legitimately differ between the quaternion and matrix paths.
+constexpr float kAmbiguousMeters = 1.0e-4f;
+
+XrQuaternionf RandomOrientation(std::mt19937& random, float maxAngle) {
+    std::uniform_real_distribution<float> axis(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> angle(-maxAngle, maxAngle);
+    const XrVector3f a = flutter_xr::Normalize(XrVector3f{axis(random), axis(random), axis(random)});
+    const float half = angle(random) * 0.5f;
+    return {a.x * std::sin(half), a.y * std::sin(half), a.z * std::sin(half), std::cos(half)};
+}
+
+// Panels in front of the viewer, mostly facing it, overlapping in depth.
+std::vector<Panel> RandomPanels(std::mt19937& random, size_t count) {
+    std::uniform_real_distribution<float> lateral(-1.5f, 1.5f);
+    std::uniform_real_distribution<float> depth(-3.0f, -0.5f);
+    std::uniform_real_distribution<float> size(0.2f, 1.6f);
+    std::vector<Panel> panels;
+    for (size_t i = 0; i < count; ++i) {
+        Panel panel;
+        panel.pose.orientation = RandomOrientation(random, 1.2f);
+        panel.pose.position = {lateral(random), lateral(random) * 0.5f, depth(random)};
+        panel.width = size(random);
+        panel.height = size(random) * 0.75f;
+        panels.push_back(panel);
+    }
+    return panels;
+}
+
+// Rays from around the head, aimed at a random panel point or past it.
+PanelRay RandomRay(std::mt19937& random, const std::vector<Panel>& panels) {
+    std::uniform_real_distribution<float> offset(-0.3f, 0.3f);
+    std::uniform_real_distribution<float> spread(-0.8f, 0.8f);
+    PanelRay ray;
+    ray.origin = {offset(random), offset(random), offset(random) + 0.2f};
+    XrVector3f target{spread(random) * 2.0f, spread(random), -1.5f};
+    if (!panels.empty() && random() % 4 != 0) {
+        const Panel& panel = panels[random() % panels.size()];
+        const XrVector3f local{spread(random) * panel.width, spread(random) * panel.height, 0.0f};
+        target = flutter_xr::TransformPoint(panel.pose, local);
+    }
+    ray.direction = flutter_xr::Normalize(flutter_xr::Subtract(target, ray.origin));
+    return ray;
+}
+
+// Nearest hit by testing each panel with IntersectRayWithQuad. Sets
+// `ambiguous` when rounding could change which panel is reported.
+PanelHit ReferenceHit(const std::vector<Panel>& panels, const PanelRay& ray, bool* ambiguous) {
+    PanelHit nearest;
+    std::vector<float> distances;
+    *ambiguous = false;
+    for (size_t i = 0; i < panels.size(); ++i) {
+        const Panel& panel = panels[i];
+        float distance = 0.0f;
+        double u = 0.0;
+        double v = 0.0;
+        if (IntersectRayWithQuad(ray.origin, ray.direction, panel.pose, panel.width, panel.height, &distance, &u,
+                                 &v)) {
+            const double edgeU = std::min(u, 1.0 - u) * panel.width;
+            const double edgeV = std::min(v, 1.0 - v) * panel.height;
+            *ambiguous |= edgeU < kAmbiguousMeters || edgeV < kAmbiguousMeters || distance < kAmbiguousMeters;
+            for (float other : distances) {
+                *ambiguous |= std::abs(other - distance) < kAmbiguousMeters;
+            }
+            distances.push_back(distance);
+            if (nearest.panel < 0 || distance < nearest.distance) {
+                nearest = {static_cast<int32_t>(i), distance, static_cast<float>(u), static_cast<float>(v)};
+            }
+        } else if (panel.width > 0.0f && panel.height > 0.0f) {
+            // A miss just outside an edge is as fragile as a hit just inside.
+            const XrVector3f local = flutter_xr::RotateVector(
+                flutter_xr::Conjugate(panel.pose.orientation),
+                flutter_xr::Subtract(ray.origin, panel.pose.position));
+            const XrVector3f localDirection =
+                flutter_xr::RotateVector(flutter_xr::Conjugate(panel.pose.orientation), ray.direction);
+            if (std::abs(localDirection.z) > 1.0e-6f) {
+                const float t = -local.z / localDirection.z;
+                const float x = std::abs(local.x + localDirection.x * t) - panel.width * 0.5f;
+                const float y = std::abs(local.y + localDirection.y * t) - panel.height * 0.5f;
+                *ambiguous |= std::abs(t) < kAmbiguousMeters ||
+                              (t > 0.0f && ((std::abs(x) < kAmbiguousMeters && y <= kAmbiguousMeters) ||
+                                            (std::abs(y) < kAmbiguousMeters && x <= kAmbiguousMeters)));
+            }
+        }
+    }
+    return nearest;
+}
+
+PanelHitTester MakeTester(const std::vector<Panel>& panels) {
+    PanelHitTester tester;
+    for (const Panel& panel : panels) {
+        tester.AddPanel(panel.pose, panel.width, panel.height);
+    }
+    return tester;
+}
+
+bool SameHit(const PanelHit& actual, const PanelHit& expected) {
+    if (actual.panel != expected.panel) {
+        return false;
+    }
+    return actual.panel < 0 || (std::abs(actual.distance - expected.distance) <= 1.0e-4f * expected.distance &&
+                                std::abs(actual.u - expected.u) <= 1.0e-4f && std::abs(actual.v - expected.v) <= 1.0e-4f);
+}
+
+}  // namespace
+
+TEST_CASE(EmptyTesterNeverHits) {
+    PanelHitTester tester;
+    CHECK(tester.PanelCount() == 0);
+    CHECK(tester.Intersect(PanelRay{}).panel == -1);
+}
+
+TEST_CASE(StraightAheadHitsPanelCentre) {
+    PanelHitTester tester;
+    XrPosef pose{{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.2f}};
+    REQUIRE(tester.AddPanel(pose, 1.2f, 0.675f) == 0);
+    const PanelHit hit = tester.Intersect(PanelRay{});
+    CHECK(hit.panel == 0);
+    CHECK_NEAR(hit.distance, 1.2f, 1.0e-6f);
+    CHECK_NEAR(hit.u, 0.5f, 1.0e-6f);
+    CHECK_NEAR(hit.v, 0.5f, 1.0e-6f);
+
+    // Behind the viewer and pointing away both miss.
+    PanelRay away;
+    away.direction = {0.0f, 0.0f, 1.0f};
+    CHECK(tester.Intersect(away).panel == -1);
+}
+
+// Every panel count up to 13 leaves 0 to 3 padding lanes in the last group
+// and exercises both the four-wide loop and the scalar remainder.
+TEST_CASE(MatchesIntersectRayWithQuadForEveryPanelCount) {
+    std::mt19937 random(20);
+    size_t compared = 0;
+    size_t skipped = 0;
+    size_t hits = 0;
+    for (size_t count = 0; count <= 13; ++count) {
+        for (size_t scene = 0; scene < 40; ++scene) {
+            const std::vector<Panel> panels = RandomPanels(random, count);
+            const PanelHitTester tester = MakeTester(panels);
+            REQUIRE(tester.PanelCount() == count);
+
+            std::vector<PanelRay> rays;
+            for (size_t r = 0; r < 64; ++r) {
+                rays.push_back(RandomRay(random, panels));
+            }
+            std::vector<PanelHit> actual(rays.size());
+            tester.Intersect(rays.data(), rays.size(), actual.data());
+
+            for (size_t r = 0; r < rays.size(); ++r) {
+                bool ambiguous = false;
+                const PanelHit expected = ReferenceHit(panels, rays[r], &ambiguous);
+                if (ambiguous) {
+                    ++skipped;
+                    continue;
+                }
+                ++compared;
+                hits += expected.panel >= 0 ? 1 : 0;
+                if (!SameHit(actual[r], expected)) {
+                    std::cerr << "  " << count << " panels, scene " << scene << ", ray " << r << ": panel "
+                              << actual[r].panel << " expected " << expected.panel << '\n';
+                }
+                CHECK(SameHit(actual[r], expected));
+                CHECK(SameHit(tester.Intersect(rays[r]), actual[r]));
+            }
+        }
+    }
+    std::cout << "  " << compared << " rays compared (" << hits << " hits), " << skipped << " on an edge skipped\n";
+    CHECK(skipped * 100 < compared);
+    CHECK(hits * 3 > compared);
+}
+
+// Invalid panels keep their index but are never hit, wherever they sit in
+// a group of four.
+TEST_CASE(InvalidPanelsAreNeverHit) {
+    std::mt19937 random(21);
+    for (size_t invalid = 0; invalid < 6; ++invalid) {
+        std::vector<Panel> panels = RandomPanels(random, 6);
+        for (size_t i = 0; i < panels.size(); ++i) {
+            panels[i].pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f - 0.1f * static_cast<float>(i)}};
+        }
+        panels[invalid].width = invalid % 2 == 0 ? 0.0f : -1.0f;
+        const PanelHitTester tester = MakeTester(panels);
+        const PanelHit hit = tester.Intersect(PanelRay{});
+        CHECK(hit.panel == static_cast<int32_t>(invalid == 0 ? 1 : 0));
+    }
+}
+
+// Rays through the origin would hit a zeroed padding lane if padding were
+// treated like a panel at the origin.
+TEST_CASE(PaddingLanesNeverHit) {
+    for (size_t count = 1; count <= 7; ++count) {
+        PanelHitTester tester;
+        for (size_t i = 0; i < count; ++i) {
+            // Edge-on to rays along z, so no real panel is hit either.
+            const XrPosef pose{{0.0f, std::sin(0.785398f), 0.0f, std::cos(0.785398f)}, {5.0f, 0.0f, -1.0f}};
+            tester.AddPanel(pose, 1.0f, 1.0f);
+        }
+        for (float z : {-1.0f, 1.0f}) {
+            PanelRay ray;
+            ray.origin = {0.0f, 0.0f, -z};
+            ray.direction = {0.0f, 0.0f, z};
+            CHECK(tester.Intersect(ray).panel == -1);
+        }
+    }
+}
+
+TEST_CASE(ClearDropsPanels) {
+    PanelHitTester tester;
+    tester.AddPanel({{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}}, 1.0f, 1.0f);
+    tester.Clear();
+    CHECK(tester.PanelCount() == 0);
+    CHECK(tester.Intersect(PanelRay{}).panel == -1);
+    CHECK(tester.AddPanel({{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -2.0f}}, 1.0f, 1.0f) == 0);
+    CHECK_NEAR(tester.Intersect(PanelRay{}).distance, 2.0f, 1.0e-6f);
+}
@@ -0,0 +1,62 @@
+#include "flutter_xr/pixel_convert.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "bench_support.h"
+
+using flutter_xr::IsPixelKernelSupported;
+using flutter_xr::PixelKernel;
+using flutter_xr::PixelKernelName;
+using flutter_xr::SwizzleRgbaToBgra;
+
+namespace {
+
+struct FrameSize {
+    const char* name;
+    size_t width;
+    size_t height;
+};
+
+constexpr FrameSize kFrameSizes[] = {{"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4K", 3840, 2160}};
+constexpr PixelKernel kKernels[] = {PixelKernel::Scalar, PixelKernel::Ssse3, PixelKernel::Avx2, PixelKernel::Avx512};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t repetitions = flutter_xr_bench::QuickMode(argc, argv) ? 3 : 50;
+    std::printf("selected kernel: %s\n", PixelKernelName(flutter_xr::SelectedPixelKernel()));
+
+    for (const FrameSize& size : kFrameSizes) {
+        // Flutter's software surfaces are tightly packed, as is the upload buffer.
+        const size_t rowBytes = size.width * 4;
+        const size_t bytes = rowBytes * size.height;
+        std::vector<uint8_t> source(bytes);
+        for (size_t i = 0; i < bytes; ++i) {
+            source[i] = static_cast<uint8_t>(i * 31);
+        }
+        std::vector<uint8_t> destination(bytes);
+
+        std::printf("%s (%zux%zu)\n", size.name, size.width, size.height);
+        double scalarSeconds = 0.0;
+        for (PixelKernel kernel : kKernels) {
+            if (!IsPixelKernelSupported(kernel)) {
+                std::printf("  %-7s not supported by this CPU\n", PixelKernelName(kernel));
+                continue;
+            }
+            const flutter_xr_bench::Timing timing = flutter_xr_bench::Measure(repetitions, [&] {
+                SwizzleRgbaToBgra(kernel, source.data(), rowBytes, destination.data(), rowBytes, size.width,
+                                  size.height);
+                flutter_xr_bench::DoNotOptimize(destination[bytes / 2]);
+            });
+            if (kernel == PixelKernel::Scalar) {
+                scalarSeconds = timing.bestSeconds;
+            }
+            // Bytes read plus bytes written.
+            std::printf("  %-7s %8.3f ms  %6.2f GB/s  %5.2fx scalar\n", PixelKernelName(kernel),
+                        timing.bestSeconds * 1e3, 2.0 * bytes / timing.bestSeconds / 1e9,
+                        scalarSeconds / timing.bestSeconds);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "flutter_xr/pixel_convert.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "test_support.h"
+
+using flutter_xr::ConvertRgbaToBgra;
+using flutter_xr::IsPixelKernelSupported;
+using flutter_xr::PixelKernel;
+using flutter_xr::PixelKernelName;
+using flutter_xr::SwizzleRgbaToBgra;
+
+namespace {
+
+constexpr PixelKernel kVectorKernels[] = {PixelKernel::Ssse3, PixelKernel::Avx2, PixelKernel::Avx512};
+constexpr uint8_t kPaddingSentinel = 0xa5;
+
+std::vector<uint8_t> RandomBytes(size_t size, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t& byte : bytes) {
+        byte = static_cast<uint8_t>(random());
+    }
+    return bytes;
+}
+
+// Converts with `kernel` into a destination whose padding starts out as
+// kPaddingSentinel, so writes past the row end show up in the comparison.
+std::vector<uint8_t> Convert(PixelKernel kernel,
+                             const std::vector<uint8_t>& source,
+                             size_t sourceRowBytes,
+                             size_t destinationRowBytes,
+                             size_t width,
+                             size_t height) {
+    std::vector<uint8_t> destination(destinationRowBytes * height, kPaddingSentinel);
+    SwizzleRgbaToBgra(kernel, source.data(), sourceRowBytes, destination.data(), destinationRowBytes, width, height);
+    return destination;
+}
+
+}  // namespace
+
+TEST_CASE(ScalarKernelSwapsRedAndBlue) {
+    const std::vector<uint8_t> source = {1, 2, 3, 4, 10, 20, 30, 40};
+    std::vector<uint8_t> destination;
+    REQUIRE(ConvertRgbaToBgra(source.data(), 8, 2, 1, destination));
+    CHECK((destination == std::vector<uint8_t>{3, 2, 1, 4, 30, 20, 10, 40}));
+}
+
+TEST_CASE(ScalarKernelIsAlwaysSupported) {
+    CHECK(IsPixelKernelSupported(PixelKernel::Scalar));
+    CHECK(IsPixelKernelSupported(flutter_xr::SelectedPixelKernel()));
+    for (PixelKernel kernel : kVectorKernels) {
+        std::cout << "  " << PixelKernelName(kernel) << (IsPixelKernelSupported(kernel) ? " supported\n" : " skipped\n");
+    }
+}
+
+// Every width from 0 to 70 pixels covers each kernel's full-vector loop and
+// every possible tail length, with source and destination padded differently.
+TEST_CASE(VectorKernelsMatchScalarOnPaddedRowsAndOddWidths) {
+    constexpr size_t kHeight = 3;
+    for (size_t width = 0; width <= 70; ++width) {
+        const size_t sourceRowBytes = width * 4 + 12;
+        const size_t destinationRowBytes = width * 4 + 20;
+        const std::vector<uint8_t> source = RandomBytes(sourceRowBytes * kHeight, static_cast<uint32_t>(width));
+        const std::vector<uint8_t> expected =
+            Convert(PixelKernel::Scalar, source, sourceRowBytes, destinationRowBytes, width, kHeight);
+
+        for (PixelKernel kernel : kVectorKernels) {
+            if (!IsPixelKernelSupported(kernel)) {
+                continue;
+            }
+            const std::vector<uint8_t> actual = Convert(kernel, source, sourceRowBytes, destinationRowBytes, width, kHeight);
+            if (actual != expected) {
+                std::cerr << "  " << PixelKernelName(kernel) << " differs from scalar at width " << width << '\n';
+            }
+            CHECK(actual == expected);
+        }
+    }
+}
+
+TEST_CASE(VectorKernelsMatchScalarAtFrameSizes) {
+    for (size_t width : {size_t{1280}, size_t{1281}, size_t{1919}}) {
+        const size_t height = 17;
+        const size_t rowBytes = width * 4 + 64;
+        const std::vector<uint8_t> source = RandomBytes(rowBytes * height, 99);
+        const std::vector<uint8_t> expected = Convert(PixelKernel::Scalar, source, rowBytes, width * 4, width, height);
+        for (PixelKernel kernel : kVectorKernels) {
+            if (IsPixelKernelSupported(kernel)) {
+                CHECK(Convert(kernel, source, rowBytes, width * 4, width, height) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE(VectorKernelsConvertInPlace) {
+    constexpr size_t kWidth = 37;
+    constexpr size_t kHeight = 4;
+    constexpr size_t kRowBytes = kWidth * 4 + 8;
+    const std::vector<uint8_t> source = RandomBytes(kRowBytes * kHeight, 7);
+    std::vector<uint8_t> expected = source;
+    SwizzleRgbaToBgra(PixelKernel::Scalar, expected.data(), kRowBytes, expected.data(), kRowBytes, kWidth, kHeight);
+
+    for (PixelKernel kernel : kVectorKernels) {
+        if (!IsPixelKernelSupported(kernel)) {
+            continue;
+        }
+        std::vector<uint8_t> pixels = source;
+        SwizzleRgbaToBgra(kernel, pixels.data(), kRowBytes, pixels.data(), kRowBytes, kWidth, kHeight);
+        CHECK(pixels == expected);
+    }
+}
+
+TEST_CASE(ConvertRejectsInvalidArguments) {
+    const std::vector<uint8_t> source(64, 0);
+    std::vector<uint8_t> destination;
+    CHECK(!ConvertRgbaToBgra(nullptr, 16, 4, 1, destination));
+    CHECK(!ConvertRgbaToBgra(source.data(), 12, 4, 1, destination));
+    CHECK(!ConvertRgbaToBgra(source.data(), 16, 0, 1, destination));
+    CHECK(!ConvertRgbaToBgra(source.data(), 16, 4, 0, destination));
+}
+
+TEST_CASE(ConvertPacksPaddedRows) {
+    constexpr size_t kWidth = 5;
+    constexpr size_t kHeight = 3;
+    constexpr size_t kRowBytes = kWidth * 4 + 16;
+    const std::vector<uint8_t> source = RandomBytes(kRowBytes * kHeight, 11);
+    std::vector<uint8_t> packed;
+    REQUIRE(ConvertRgbaToBgra(source.data(), kRowBytes, kWidth, kHeight, packed));
+    REQUIRE(packed.size() == kWidth * kHeight * 4);
+    for (size_t y = 0; y < kHeight; ++y) {
+        for (size_t x = 0; x < kWidth; ++x) {
+            const uint8_t* in = source.data() + y * kRowBytes + x * 4;
+            const uint8_t* out = packed.data() + (y * kWidth + x) * 4;
+            CHECK(out[0] == in[2] && out[1] == in[1] && out[2] == in[0] && out[3] == in[3]);
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include "flutter_xr/platform_task_runner.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "fake_flutter_engine.h"
+#include "test_support.h"
+
+using flutter_xr::PlatformTaskRunner;
+
+namespace {
+
+int gEngineStorage[PlatformTaskRunner::kMaxEngines];
+
+FlutterEngine FakeEngine(size_t engineIndex) {
+    return reinterpret_cast<FlutterEngine>(&gEngineStorage[engineIndex]);
+}
+
+void Post(const PlatformTaskRunner& runner, size_t engineIndex, uint64_t targetTimeNanos, uint64_t taskId = 0) {
+    const FlutterTaskRunnerDescription* description = runner.Description(engineIndex);
+    FlutterTask task{};
+    task.task = taskId;
+    description->post_task_callback(task, targetTimeNanos, description->user_data);
+}
+
+// Waits for the platform thread to run `tasks` tasks in total.
+bool WaitForTasksRun(const PlatformTaskRunner& runner, uint64_t tasks) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (runner.GetStats().tasksRun < tasks) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE(QueueDepthIsTrackedPerEngine) {
+    PlatformTaskRunner runner;
+    for (int i = 0; i < 3; ++i) {
+        Post(runner, 0, 0);
+    }
+    Post(runner, 1, 0);
+
+    // Nothing runs before Release, so every task is still queued.
+    CHECK(runner.GetStats().maxQueueDepth == 4);
+    CHECK(runner.GetStats(0).maxQueueDepth == 3);
+    CHECK(runner.GetStats(1).maxQueueDepth == 1);
+    CHECK(runner.GetStats(2).maxQueueDepth == 0);
+
+    runner.SetEngine(0, FakeEngine(0));
+    runner.SetEngine(1, FakeEngine(1));
+    runner.Release();
+    REQUIRE(WaitForTasksRun(runner, 4));
+    CHECK(runner.GetStats(0).tasksRun == 3);
+    CHECK(runner.GetStats(1).tasksRun == 1);
+
+    // Engine 1 only ever has two tasks pending at once, however deep engine
+    // 0's backlog was.
+    runner.SetEngine(0, nullptr);
+    Post(runner, 1, 0);
+    Post(runner, 1, 0);
+    REQUIRE(WaitForTasksRun(runner, 6));
+    CHECK(runner.GetStats(0).maxQueueDepth == 3);
+    CHECK(runner.GetStats(1).maxQueueDepth <= 2);
+    CHECK(runner.GetStats().maxQueueDepth == 4);
+}
+
+TEST_CASE(TasksOfUnsetEnginesAreDropped) {
+    PlatformTaskRunner runner;
+    runner.SetEngine(0, FakeEngine(0));
+    // Same target time, so engine 2's task is taken first and dropped.
+    Post(runner, 2, 0);
+    Post(runner, 0, 0);
+    runner.Release();
+    REQUIRE(WaitForTasksRun(runner, 1));
+    // The dropped task leaves the queue too, so a later task is counted
+    // from an empty queue.
+    runner.SetEngine(2, FakeEngine(2));
+    Post(runner, 2, 0);
+    REQUIRE(WaitForTasksRun(runner, 2));
+    CHECK(runner.GetStats(2).tasksRun == 1);
+    CHECK(runner.GetStats(2).maxQueueDepth == 1);
+}
+
+TEST_CASE(PostedWorkRunsInOrderOnThePlatformThread) {
+    PlatformTaskRunner runner;
+    const FlutterTaskRunnerDescription* description = runner.Description(0);
+    std::vector<int> order;
+    std::atomic<int> onPlatformThread{0};
+    // Posted work does not wait for Release, unlike engine tasks.
+    for (int i = 0; i < 3; ++i) {
+        runner.Post([&, i]() {
+            order.push_back(i);
+            if (description->runs_task_on_current_thread_callback(description->user_data)) {
+                onPlatformThread.fetch_add(1);
+            }
+        });
+    }
+    runner.Post([]() { throw std::runtime_error("posted work failed"); });
+    bool ranAfterThrow = false;
+    runner.RunSync([&]() { ranAfterThrow = true; });
+    CHECK(ranAfterThrow);
+    CHECK((order == std::vector<int>{0, 1, 2}));
+    CHECK(onPlatformThread.load() == 3);
+    CHECK(!description->runs_task_on_current_thread_callback(description->user_data));
+}
+
+TEST_CASE(TasksRunInTargetTimeOrder) {
+    flutter_xr_test::TakeRunTaskIds();
+    PlatformTaskRunner runner;
+    runner.SetEngine(0, FakeEngine(0));
+    runner.SetEngine(1, FakeEngine(1));
+
+    // Posted out of order and across engines; equal targets keep post order.
+    const uint64_t now = FlutterEngineGetCurrentTime();
+    const uint64_t ms = 1'000'000;
+    Post(runner, 0, now + 6 * ms, 6);
+    Post(runner, 1, now + 2 * ms, 3);
+    Post(runner, 0, 0, 1);
+    Post(runner, 1, now + 4 * ms, 5);
+    Post(runner, 0, now + 2 * ms, 4);
+    Post(runner, 1, 0, 2);
+    runner.Release();
+    REQUIRE(WaitForTasksRun(runner, 6));
+    CHECK((flutter_xr_test::TakeRunTaskIds() == std::vector<uint64_t>{1, 2, 3, 4, 5, 6}));
+
+    // A task posted later with an earlier target overtakes a pending one.
+    Post(runner, 0, FlutterEngineGetCurrentTime() + 200 * ms, 8);
+    Post(runner, 0, 0, 7);
+    REQUIRE(WaitForTasksRun(runner, 8));
+    CHECK((flutter_xr_test::TakeRunTaskIds() == std::vector<uint64_t>{7, 8}));
+}
+
+TEST_CASE(RenderCriticalSectionDefersDueTasks) {
+    flutter_xr_test::TakeRunTaskIds();
+    PlatformTaskRunner runner;
+    runner.SetEngine(0, FakeEngine(0));
+    runner.Release();
+
+    const uint64_t criticalSince = FlutterEngineGetCurrentTime();
+    runner.SetRenderCritical(true);
+    Post(runner, 0, 0, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    // Only a preempted test thread can get past the 4 ms cap here.
+    CHECK(runner.GetStats().tasksRun == 0 || FlutterEngineGetCurrentTime() - criticalSince >= 4'000'000);
+
+    // Leaving the critical section lets the held task run at once.
+    const auto released = std::chrono::steady_clock::now();
+    runner.SetRenderCritical(false);
+    REQUIRE(WaitForTasksRun(runner, 1));
+    CHECK(std::chrono::steady_clock::now() - released < std::chrono::milliseconds(500));
+}
+
+TEST_CASE(RenderDeferralIsCappedAtFourMilliseconds) {
+    flutter_xr_test::TakeRunTaskIds();
+    PlatformTaskRunner runner;
+    runner.SetEngine(0, FakeEngine(0));
+    runner.Release();
+
+    // A frame stuck in its critical section does not starve platform tasks.
+    const uint64_t criticalSince = FlutterEngineGetCurrentTime();
+    runner.SetRenderCritical(true);
+    Post(runner, 0, 0, 1);
+    REQUIRE(WaitForTasksRun(runner, 1));
+    const uint64_t ranAt = FlutterEngineGetCurrentTime();
+    CHECK(ranAt - criticalSince >= 4'000'000);
+    CHECK(ranAt - criticalSince < 500'000'000);
+
+    // Past the cap, tasks posted while still critical run without waiting.
+    const auto posted = std::chrono::steady_clock::now();
+    Post(runner, 0, 0, 2);
+    REQUIRE(WaitForTasksRun(runner, 2));
+    CHECK(std::chrono::steady_clock::now() - posted < std::chrono::milliseconds(500));
+    CHECK((flutter_xr_test::TakeRunTaskIds() == std::vector<uint64_t>{1, 2}));
+    runner.SetRenderCritical(false);
+}
@@ -0,0 +1,24 @@
+#include "test_support.h"
+
+namespace flutter_xr_test {
+
+int RunAllTests() {
+    size_t failedTests = 0;
+    for (const TestCase& test : Registry()) {
+        const size_t failuresBefore = FailureCount();
+        test.body();
+        const bool passed = FailureCount() == failuresBefore;
+        std::cout << (passed ? "[pass] " : "[FAIL] ") << test.name << '\n';
+        if (!passed) {
+            ++failedTests;
+        }
+    }
+    std::cout << Registry().size() - failedTests << '/' << Registry().size() << " tests passed\n";
+    return failedTests == 0 ? 0 : 1;
+}
+
+}  // namespace flutter_xr_test
+
+int main() {
+    return flutter_xr_test::RunAllTests();
+}
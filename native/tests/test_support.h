@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+namespace flutter_xr_test {
+
+struct TestCase {
+    const char* name;
+    void (*body)();
+};
+
+inline std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+inline size_t& FailureCount() {
+    static size_t failures = 0;
+    return failures;
+}
+
+struct Registration {
+    Registration(const char* name, void (*body)()) { Registry().push_back({name, body}); }
+};
+
+inline void ReportFailure(const char* file, int line, const char* expression) {
+    ++FailureCount();
+    std::cerr << file << ':' << line << ": check failed: " << expression << '\n';
+}
+
+// Runs every registered test and returns the process exit code.
+int RunAllTests();
+
+}  // namespace flutter_xr_test
+
+#define FLUTTER_XR_TEST_CONCAT_INNER(a, b) a##b
+#define FLUTTER_XR_TEST_CONCAT(a, b) FLUTTER_XR_TEST_CONCAT_INNER(a, b)
+
+#define TEST_CASE(name)                                                                                  \
+    static void name();                                                                                  \
+    static const ::flutter_xr_test::Registration FLUTTER_XR_TEST_CONCAT(name, Registration)(#name, name); \
+    static void name()
+
+#define CHECK(expression)                                                      \
+    do {                                                                       \
+        if (!(expression)) {                                                   \
+            ::flutter_xr_test::ReportFailure(__FILE__, __LINE__, #expression); \
+        }                                                                      \
+    } while (false)
+
+// Like CHECK, but returns from the test so later checks do not dereference
+// what the failed one guarded.
+#define REQUIRE(expression)                                                    \
+    do {                                                                       \
+        if (!(expression)) {                                                   \
+            ::flutter_xr_test::ReportFailure(__FILE__, __LINE__, #expression); \
+            return;                                                            \
+        }                                                                      \
+    } while (false)
+
+#define CHECK_NEAR(actual, expected, tolerance) CHECK(std::fabs((actual) - (expected)) <= (tolerance))
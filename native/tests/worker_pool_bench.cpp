@@ -0,0 +1,135 @@
+#include "flutter_xr/worker_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "bench_support.h"
+#include "flutter_xr/pixel_convert.h"
+
+using flutter_xr::WorkerPool;
+using flutter_xr_bench::DoNotOptimize;
+using flutter_xr_bench::Measure;
+
+namespace {
+
+constexpr size_t kWidth = 1920;
+constexpr size_t kHeight = 1080;
+constexpr size_t kRowBytes = kWidth * 4;
+constexpr size_t kMinRowsPerStripe = 16;
+
+struct Workload {
+    const char* name;
+    // Runs the job once on `pool`; `stripeRows` is the minimum stripe height.
+    void (*run)(WorkerPool& pool, size_t stripeRows);
+};
+
+std::vector<uint8_t>& Source() {
+    static std::vector<uint8_t> pixels = [] {
+        std::vector<uint8_t> bytes(kRowBytes * kHeight);
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            bytes[i] = static_cast<uint8_t>(i * 13);
+        }
+        return bytes;
+    }();
+    return pixels;
+}
+
+std::vector<uint8_t>& Destination() {
+    static std::vector<uint8_t> pixels(kRowBytes * kHeight);
+    return pixels;
+}
+
+// Memory-bound: the Flutter frame copy into a mailbox slot.
+void CopyFrame(WorkerPool& pool, size_t stripeRows) {
+    pool.ParallelForRows(kHeight, stripeRows, [](size_t rowBegin, size_t rowEnd) {
+        std::memcpy(Destination().data() + rowBegin * kRowBytes, Source().data() + rowBegin * kRowBytes,
+                    (rowEnd - rowBegin) * kRowBytes);
+    });
+}
+
+void SwizzleFrame(WorkerPool& pool, size_t stripeRows) {
+    pool.ParallelForRows(kHeight, stripeRows, [](size_t rowBegin, size_t rowEnd) {
+        flutter_xr::SwizzleRgbaToBgra(Source().data() + rowBegin * kRowBytes, kRowBytes,
+                                      Destination().data() + rowBegin * kRowBytes, kRowBytes, kWidth, rowEnd - rowBegin);
+    });
+}
+
+// Compute-bound with uneven rows, like the ground grid: rows near the
+// horizon cost several times more than the rest.
+void ShadeUnevenRows(WorkerPool& pool, size_t stripeRows) {
+    pool.ParallelForRows(kHeight, stripeRows, [](size_t rowBegin, size_t rowEnd) {
+        for (size_t y = rowBegin; y < rowEnd; ++y) {
+            const size_t samples = y > kHeight / 3 && y < kHeight / 2 ? 8 : 1;
+            uint8_t* row = Destination().data() + y * kRowBytes;
+            for (size_t x = 0; x < kWidth; ++x) {
+                float value = 0.0f;
+                for (size_t s = 0; s < samples; ++s) {
+                    value += std::sin(static_cast<float>(x * 0.01 + y * 0.02 + s));
+                }
+                row[x * 4] = static_cast<uint8_t>(value * 16.0f + 128.0f);
+            }
+        }
+    });
+}
+
+constexpr Workload kWorkloads[] = {
+    {"copy 1080p", CopyFrame},
+    {"swizzle 1080p", SwizzleFrame},
+    {"shade uneven rows", ShadeUnevenRows},
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = flutter_xr_bench::QuickMode(argc, argv);
+    const size_t repetitions = quick ? 3 : 30;
+    const size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    // `--threads=N` measures past the hardware thread count, e.g. to see the
+    // cost of oversubscription.
+    size_t maxThreads = hardwareThreads;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--threads=", 10) == 0) {
+            maxThreads = std::max<size_t>(std::strtoul(argv[i] + 10, nullptr, 10), 1);
+        }
+    }
+    maxThreads = std::min(maxThreads, WorkerPool::kMaxThreads);
+    std::printf("%zu hardware threads, default pool size %zu\n", hardwareThreads, WorkerPool::DefaultThreadCount());
+
+    // Cost of waking the pool and joining it, with no work to share.
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        WorkerPool pool(threads);
+        const size_t jobs = quick ? 100 : 10000;
+        const flutter_xr_bench::Timing timing = Measure(3, [&] {
+            for (size_t i = 0; i < jobs; ++i) {
+                pool.ParallelForRows(kHeight, 1, [](size_t rowBegin, size_t rowEnd) { DoNotOptimize(rowEnd - rowBegin); });
+            }
+        });
+        std::printf("dispatch, %2zu threads: %8.2f us per job\n", threads, timing.bestSeconds / jobs * 1e6);
+    }
+
+    // Each workload runs with the pool's dynamic stripes (several per thread,
+    // claimed from a shared counter) and with one fixed stripe per thread.
+    for (const Workload& workload : kWorkloads) {
+        std::printf("%s\n", workload.name);
+        double singleThreadSeconds = 0.0;
+        for (size_t threads = 1; threads <= maxThreads; ++threads) {
+            WorkerPool pool(threads);
+            const double dynamicSeconds =
+                Measure(repetitions, [&] { workload.run(pool, kMinRowsPerStripe); }).bestSeconds;
+            const size_t staticStripeRows = (kHeight + threads - 1) / threads;
+            const double staticSeconds = Measure(repetitions, [&] { workload.run(pool, staticStripeRows); }).bestSeconds;
+            if (threads == 1) {
+                singleThreadSeconds = dynamicSeconds;
+            }
+            std::printf("  %2zu threads: %8.3f ms  %5.2fx   one stripe per thread %8.3f ms  %5.2fx\n", threads,
+                        dynamicSeconds * 1e3, singleThreadSeconds / dynamicSeconds, staticSeconds * 1e3,
+                        singleThreadSeconds / staticSeconds);
+        }
+    }
+    return 0;
+}
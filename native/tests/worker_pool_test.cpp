@@ -0,0 +1,109 @@
+#include "flutter_xr/worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "test_support.h"
+
+using flutter_xr::WorkerPool;
+
+namespace {
+
+// Runs one job and returns how often each row was visited.
+std::vector<int> VisitRows(WorkerPool& pool, size_t rowCount, size_t minRowsPerStripe) {
+    std::vector<std::atomic<int>> visits(rowCount);
+    pool.ParallelForRows(rowCount, minRowsPerStripe, [&](size_t rowBegin, size_t rowEnd) {
+        for (size_t row = rowBegin; row < rowEnd; ++row) {
+            visits[row].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    std::vector<int> counts;
+    for (const std::atomic<int>& count : visits) {
+        counts.push_back(count.load());
+    }
+    return counts;
+}
+
+bool EveryRowOnce(const std::vector<int>& counts) {
+    return std::all_of(counts.begin(), counts.end(), [](int count) { return count == 1; });
+}
+
+}  // namespace
+
+TEST_CASE(ThreadCountIsClamped) {
+    CHECK(WorkerPool(1).ThreadCount() == 1);
+    CHECK(WorkerPool(3).ThreadCount() == 3);
+    CHECK(WorkerPool(WorkerPool::kMaxThreads + 5).ThreadCount() == WorkerPool::kMaxThreads);
+    CHECK(WorkerPool(0).ThreadCount() == WorkerPool::DefaultThreadCount());
+    CHECK(WorkerPool::DefaultThreadCount() >= 1 && WorkerPool::DefaultThreadCount() <= 8);
+}
+
+TEST_CASE(EveryRowIsVisitedExactlyOnce) {
+    for (size_t threads : {size_t{1}, size_t{2}, size_t{3}, size_t{8}}) {
+        WorkerPool pool(threads);
+        for (size_t rowCount : {size_t{1}, size_t{15}, size_t{16}, size_t{33}, size_t{720}, size_t{1081}}) {
+            for (size_t minRows : {size_t{0}, size_t{1}, size_t{16}, size_t{1000}}) {
+                CHECK(EveryRowOnce(VisitRows(pool, rowCount, minRows)));
+            }
+        }
+    }
+}
+
+TEST_CASE(EmptyJobDoesNotCallTheBody) {
+    WorkerPool pool(4);
+    bool called = false;
+    pool.ParallelForRows(0, 1, [&](size_t, size_t) { called = true; });
+    CHECK(!called);
+}
+
+TEST_CASE(StripesRespectTheMinimumHeight) {
+    WorkerPool pool(4);
+    std::atomic<size_t> shortStripes{0};
+    std::atomic<size_t> stripes{0};
+    pool.ParallelForRows(1000, 64, [&](size_t rowBegin, size_t rowEnd) {
+        stripes.fetch_add(1);
+        if (rowEnd - rowBegin < 64 && rowEnd != 1000) {
+            shortStripes.fetch_add(1);
+        }
+    });
+    CHECK(shortStripes.load() == 0);
+    CHECK(stripes.load() > 1);
+}
+
+TEST_CASE(NestedJobsRunInline) {
+    WorkerPool pool(4);
+    std::atomic<size_t> innerRows{0};
+    pool.ParallelForRows(64, 1, [&](size_t rowBegin, size_t rowEnd) {
+        for (size_t row = rowBegin; row < rowEnd; ++row) {
+            pool.ParallelForRows(10, 1, [&](size_t innerBegin, size_t innerEnd) {
+                innerRows.fetch_add(innerEnd - innerBegin);
+            });
+        }
+    });
+    CHECK(innerRows.load() == 640);
+}
+
+TEST_CASE(ConcurrentCallersBothComplete) {
+    WorkerPool pool(4);
+    std::vector<int> first;
+    std::vector<int> second;
+    std::thread other([&] {
+        for (int i = 0; i < 200; ++i) {
+            second = VisitRows(pool, 257, 4);
+            if (!EveryRowOnce(second)) {
+                return;
+            }
+        }
+    });
+    for (int i = 0; i < 200; ++i) {
+        first = VisitRows(pool, 311, 4);
+        if (!EveryRowOnce(first)) {
+            break;
+        }
+    }
+    other.join();
+    CHECK(EveryRowOnce(first));
+    CHECK(EveryRowOnce(second));
+}
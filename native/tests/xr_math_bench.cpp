@@ -0,0 +1,100 @@
+#include "flutter_xr/xr_math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "bench_support.h"
+#include "xr_math_legacy.h"
+
+using flutter_xr_bench::DoNotOptimize;
+using flutter_xr_bench::Measure;
+
+namespace {
+
+constexpr XrPosef kPose{{0.1f, 0.7f, -0.2f, 0.676f}, {0.3f, 1.4f, -0.8f}};
+
+std::vector<XrVector3f> MakeVectors(size_t count) {
+    std::vector<XrVector3f> vectors(count);
+    for (size_t i = 0; i < count; ++i) {
+        const float f = static_cast<float>(i);
+        vectors[i] = {std::sin(f), std::cos(f * 0.7f), f * 0.001f};
+    }
+    return vectors;
+}
+
+void Report(const char* name, size_t count, size_t iterations, double seconds, double baselineSeconds) {
+    std::printf("  %-28s %8.2f ns/item  %5.2fx\n", name, seconds / (count * iterations) * 1e9,
+                baselineSeconds / seconds);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = flutter_xr_bench::QuickMode(argc, argv);
+    const size_t repetitions = quick ? 3 : 20;
+    // Six is the pointer-ray cylinder; the larger counts show the SIMD step.
+    for (size_t count : {size_t{6}, size_t{64}, size_t{1024}, size_t{65536}}) {
+        const size_t iterations = std::max<size_t>((quick ? 1 << 14 : 1 << 20) / count, 1);
+        const std::vector<XrVector3f> input = MakeVectors(count);
+        std::vector<XrVector3f> output(count);
+        std::printf("%zu vectors\n", count);
+
+        // The out-of-line functions the runner called before xr_math.h.
+        const double legacySeconds = Measure(repetitions, [&] {
+            for (size_t n = 0; n < iterations; ++n) {
+                for (size_t i = 0; i < count; ++i) {
+                    output[i] = flutter_xr_legacy::Add(kPose.position,
+                                                       flutter_xr_legacy::RotateVector(kPose.orientation, input[i]));
+                }
+                DoNotOptimize(output[count - 1]);
+            }
+        }).bestSeconds;
+        Report("legacy TransformPoint loop", count, iterations, legacySeconds, legacySeconds);
+
+        const double inlineSeconds = Measure(repetitions, [&] {
+            for (size_t n = 0; n < iterations; ++n) {
+                for (size_t i = 0; i < count; ++i) {
+                    output[i] = flutter_xr::TransformPoint(kPose, input[i]);
+                }
+                DoNotOptimize(output[count - 1]);
+            }
+        }).bestSeconds;
+        Report("inline TransformPoint loop", count, iterations, inlineSeconds, legacySeconds);
+
+        const double batchSeconds = Measure(repetitions, [&] {
+            for (size_t n = 0; n < iterations; ++n) {
+                flutter_xr::TransformPoints(kPose, input.data(), output.data(), count);
+                DoNotOptimize(output[count - 1]);
+            }
+        }).bestSeconds;
+        Report("TransformPoints", count, iterations, batchSeconds, legacySeconds);
+
+        std::vector<XrPosef> children(count);
+        for (size_t i = 0; i < count; ++i) {
+            children[i] = {{0.0f, 0.0f, std::sin(input[i].x * 0.5f), std::cos(input[i].x * 0.5f)}, input[i]};
+        }
+        std::vector<XrPosef> composed(count);
+        const double legacyComposeSeconds = Measure(repetitions, [&] {
+            for (size_t n = 0; n < iterations; ++n) {
+                for (size_t i = 0; i < count; ++i) {
+                    composed[i].orientation = flutter_xr_legacy::Multiply(kPose.orientation, children[i].orientation);
+                    composed[i].position = flutter_xr_legacy::Add(
+                        kPose.position, flutter_xr_legacy::RotateVector(kPose.orientation, children[i].position));
+                }
+                DoNotOptimize(composed[count - 1]);
+            }
+        }).bestSeconds;
+        Report("legacy pose composition", count, iterations, legacyComposeSeconds, legacyComposeSeconds);
+
+        const double composeSeconds = Measure(repetitions, [&] {
+            for (size_t n = 0; n < iterations; ++n) {
+                flutter_xr::ComposePoses(kPose, children.data(), composed.data(), count);
+                DoNotOptimize(composed[count - 1]);
+            }
+        }).bestSeconds;
+        Report("ComposePoses", count, iterations, composeSeconds, legacyComposeSeconds);
+    }
+    return 0;
+}
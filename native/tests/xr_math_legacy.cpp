@@ -0,0 +1,98 @@
+#include "xr_math_legacy.h"
+
+#include <cmath>
+
+namespace flutter_xr_legacy {
+
+XrVector3f Add(const XrVector3f& lhs, const XrVector3f& rhs) {
+    return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
+}
+
+XrVector3f Subtract(const XrVector3f& lhs, const XrVector3f& rhs) {
+    return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+}
+
+XrVector3f Scale(const XrVector3f& value, float scale) {
+    return {value.x * scale, value.y * scale, value.z * scale};
+}
+
+float Dot(const XrVector3f& lhs, const XrVector3f& rhs) {
+    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+XrVector3f Cross(const XrVector3f& lhs, const XrVector3f& rhs) {
+    return {
+        lhs.y * rhs.z - lhs.z * rhs.y,
+        lhs.z * rhs.x - lhs.x * rhs.z,
+        lhs.x * rhs.y - lhs.y * rhs.x,
+    };
+}
+
+XrQuaternionf Conjugate(const XrQuaternionf& value) {
+    return {-value.x, -value.y, -value.z, value.w};
+}
+
+XrQuaternionf Multiply(const XrQuaternionf& lhs, const XrQuaternionf& rhs) {
+    return {
+        lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y,
+        lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x,
+        lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w,
+        lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z,
+    };
+}
+
+XrVector3f RotateVector(const XrQuaternionf& rotation, const XrVector3f& value) {
+    const XrVector3f qv{rotation.x, rotation.y, rotation.z};
+    const XrVector3f term1 = Scale(qv, 2.0f * Dot(qv, value));
+    const XrVector3f term2 = Scale(value, rotation.w * rotation.w - Dot(qv, qv));
+    const XrVector3f term3 = Scale(Cross(qv, value), 2.0f * rotation.w);
+    return Add(Add(term1, term2), term3);
+}
+
+XrVector3f Normalize(const XrVector3f& value) {
+    const float lengthSquared = Dot(value, value);
+    if (lengthSquared <= 1.0e-8f) {
+        return {0.0f, 0.0f, -1.0f};
+    }
+    const float invLength = 1.0f / std::sqrt(lengthSquared);
+    return Scale(value, invLength);
+}
+
+XrPosef SegmentPose(const XrPosef& pose, const XrQuaternionf& segmentRotation, const XrVector3f& radialOffset) {
+    XrPosef result;
+    result.orientation = Multiply(pose.orientation, segmentRotation);
+    const XrVector3f radialOffsetLocal = RotateVector(segmentRotation, radialOffset);
+    result.position = Add(pose.position, RotateVector(pose.orientation, radialOffsetLocal));
+    return result;
+}
+
+void WorldToLocalRows(const XrQuaternionf& q, float rows[3][3]) {
+    const float xx = q.x * q.x;
+    const float yy = q.y * q.y;
+    const float zz = q.z * q.z;
+    const float xy = q.x * q.y;
+    const float xz = q.x * q.z;
+    const float yz = q.y * q.z;
+    const float wx = q.w * q.x;
+    const float wy = q.w * q.y;
+    const float wz = q.w * q.z;
+    const float expanded[3][3] = {
+        {1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)},
+        {2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)},
+        {2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)},
+    };
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            rows[row][column] = expanded[row][column];
+        }
+    }
+}
+
+XrQuaternionf RotationDelta(const XrQuaternionf& from, const XrQuaternionf& to) {
+    return {to.w * -from.x + to.x * from.w + to.y * -from.z - to.z * -from.y,
+            to.w * -from.y - to.x * -from.z + to.y * from.w + to.z * -from.x,
+            to.w * -from.z + to.x * -from.y - to.y * -from.x + to.z * from.w,
+            to.w * from.w - to.x * -from.x - to.y * -from.y - to.z * -from.z};
+}
+
+}  // namespace flutter_xr_legacy
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <openxr/openxr.h>
+
+// The vector helpers as they were before xr_math.h: out-of-line functions
+// in their own translation unit, plus the per-element segment pose and
+// panel transform code that the batch helpers replaced. Kept as the
+// reference for xr_math_test and the baseline for xr_math_bench.
+namespace flutter_xr_legacy {
+
+XrVector3f Add(const XrVector3f& lhs, const XrVector3f& rhs);
+XrVector3f Subtract(const XrVector3f& lhs, const XrVector3f& rhs);
+XrVector3f Scale(const XrVector3f& value, float scale);
+float Dot(const XrVector3f& lhs, const XrVector3f& rhs);
+XrVector3f Cross(const XrVector3f& lhs, const XrVector3f& rhs);
+XrQuaternionf Conjugate(const XrQuaternionf& value);
+XrQuaternionf Multiply(const XrQuaternionf& lhs, const XrQuaternionf& rhs);
+XrVector3f RotateVector(const XrQuaternionf& rotation, const XrVector3f& value);
+XrVector3f Normalize(const XrVector3f& value);
+
+// Pointer-ray segment pose: `pose` followed by `segmentRotation`, pushed
+// out by `radialOffset` along the rotated axis.
+XrPosef SegmentPose(const XrPosef& pose, const XrQuaternionf& segmentRotation, const XrVector3f& radialOffset);
+
+// PanelHitTester's world-to-local rows, expanded inline from the quaternion.
+void WorldToLocalRows(const XrQuaternionf& q, float rows[3][3]);
+
+// PoseFilter's rotation delta, to * conjugate(from), written out.
+XrQuaternionf RotationDelta(const XrQuaternionf& from, const XrQuaternionf& to);
+
+}  // namespace flutter_xr_legacy
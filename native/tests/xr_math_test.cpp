@@ -0,0 +1,228 @@
+#include "flutter_xr/xr_math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "test_support.h"
+#include "xr_math_legacy.h"
+
+namespace legacy = flutter_xr_legacy;
+
+namespace {
+
+// Batch results go through a rotation matrix instead of the quaternion
+// sandwich, so they agree with the scalar path to rounding, not bit for bit.
+constexpr float kRelativeTolerance = 2.0e-6f;
+
+// Largest vector count checked; covers several full SIMD steps and every
+// tail length after them.
+constexpr size_t kMaxCount = 67;
+
+std::mt19937& Random() {
+    static std::mt19937 random(21);
+    return random;
+}
+
+float RandomFloat(float range) {
+    return std::uniform_real_distribution<float>(-range, range)(Random());
+}
+
+XrVector3f RandomVector(float range) {
+    return {RandomFloat(range), RandomFloat(range), RandomFloat(range)};
+}
+
+XrQuaternionf RandomRotation() {
+    XrQuaternionf q{RandomFloat(1.0f), RandomFloat(1.0f), RandomFloat(1.0f), RandomFloat(1.0f)};
+    const float length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    return {q.x / length, q.y / length, q.z / length, q.w / length};
+}
+
+XrPosef RandomPose() {
+    return {RandomRotation(), RandomVector(5.0f)};
+}
+
+bool Near(float actual, float expected, float scale) {
+    return std::abs(actual - expected) <= kRelativeTolerance * std::max(scale, 1.0f);
+}
+
+bool Near(const XrVector3f& actual, const XrVector3f& expected) {
+    const float scale = std::max({std::abs(expected.x), std::abs(expected.y), std::abs(expected.z)});
+    return Near(actual.x, expected.x, scale) && Near(actual.y, expected.y, scale) && Near(actual.z, expected.z, scale);
+}
+
+bool Near(const XrQuaternionf& actual, const XrQuaternionf& expected) {
+    return Near(actual.x, expected.x, 1.0f) && Near(actual.y, expected.y, 1.0f) && Near(actual.z, expected.z, 1.0f) &&
+           Near(actual.w, expected.w, 1.0f);
+}
+
+bool Same(const XrVector3f& lhs, const XrVector3f& rhs) {
+    return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+}
+
+// Vectors with guard entries on both sides, so a kernel that reads or
+// writes outside [0, count) shows up as a changed guard.
+struct GuardedVectors {
+    static constexpr size_t kGuard = 4;
+    static constexpr float kGuardValue = 12345.0f;
+
+    explicit GuardedVectors(size_t count) : storage(count + kGuard * 2, XrVector3f{kGuardValue, -kGuardValue, 0.5f}) {}
+
+    XrVector3f* data() { return storage.data() + kGuard; }
+
+    bool GuardsIntact(size_t count) const {
+        for (size_t i = 0; i < storage.size(); ++i) {
+            if ((i < kGuard || i >= kGuard + count) && !Same(storage[i], XrVector3f{kGuardValue, -kGuardValue, 0.5f})) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<XrVector3f> storage;
+};
+
+}  // namespace
+
+// The scalar helpers fold at compile time.
+static_assert(flutter_xr::Dot(flutter_xr::Cross({1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}), {0.0f, 0.0f, 1.0f}) == 1.0f,
+              "Cross and Dot are constexpr");
+static_assert(flutter_xr::RotateVector({0.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 2.0f, 3.0f}).y == 2.0f,
+              "RotateVector is constexpr");
+static_assert(flutter_xr::ComposePoses({{0.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}},
+                                       {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 2.0f, 0.0f}})
+                      .position.x == 1.0f,
+              "ComposePoses is constexpr");
+
+TEST_CASE(ScalarHelpersMatchLegacyFunctions) {
+    for (int i = 0; i < 1000; ++i) {
+        const XrVector3f a = RandomVector(10.0f);
+        const XrVector3f b = RandomVector(10.0f);
+        const float s = RandomFloat(4.0f);
+        const XrQuaternionf q = RandomRotation();
+        const XrQuaternionf r = RandomRotation();
+        CHECK(Same(flutter_xr::Add(a, b), legacy::Add(a, b)));
+        CHECK(Same(flutter_xr::Subtract(a, b), legacy::Subtract(a, b)));
+        CHECK(Same(flutter_xr::Scale(a, s), legacy::Scale(a, s)));
+        CHECK(Near(flutter_xr::Dot(a, b), legacy::Dot(a, b), 100.0f));
+        CHECK(Near(flutter_xr::Cross(a, b), legacy::Cross(a, b)));
+        CHECK(Near(flutter_xr::Multiply(q, r), legacy::Multiply(q, r)));
+        CHECK(Near(flutter_xr::RotateVector(q, a), legacy::RotateVector(q, a)));
+        CHECK(Near(flutter_xr::Normalize(a), legacy::Normalize(a)));
+        CHECK(Near(flutter_xr::Multiply(r, flutter_xr::Conjugate(q)), legacy::RotationDelta(q, r)));
+    }
+    CHECK(Same(flutter_xr::Normalize({0.0f, 0.0f, 0.0f}), legacy::Normalize({0.0f, 0.0f, 0.0f})));
+}
+
+TEST_CASE(RotationMatrixMatchesQuaternionRotation) {
+    for (int i = 0; i < 1000; ++i) {
+        const XrQuaternionf q = RandomRotation();
+        const flutter_xr::Matrix3 m = flutter_xr::RotationMatrix(q);
+        const XrVector3f v = RandomVector(3.0f);
+        const XrVector3f rotated{m.m[0][0] * v.x + m.m[0][1] * v.y + m.m[0][2] * v.z,
+                                 m.m[1][0] * v.x + m.m[1][1] * v.y + m.m[1][2] * v.z,
+                                 m.m[2][0] * v.x + m.m[2][1] * v.y + m.m[2][2] * v.z};
+        CHECK(Near(rotated, legacy::RotateVector(q, v)));
+
+        // PanelHitTester used to expand the transpose by hand.
+        float rows[3][3];
+        legacy::WorldToLocalRows(q, rows);
+        const flutter_xr::Matrix3 toLocal = flutter_xr::Transpose(m);
+        for (int row = 0; row < 3; ++row) {
+            for (int column = 0; column < 3; ++column) {
+                CHECK(toLocal.m[row][column] == rows[row][column]);
+            }
+        }
+    }
+}
+
+TEST_CASE(QuaternionFromAxesRoundTrips) {
+    for (int i = 0; i < 1000; ++i) {
+        const XrQuaternionf q = RandomRotation();
+        const XrQuaternionf fromAxes = flutter_xr::QuaternionFromAxes(
+            legacy::RotateVector(q, {1.0f, 0.0f, 0.0f}), legacy::RotateVector(q, {0.0f, 1.0f, 0.0f}),
+            legacy::RotateVector(q, {0.0f, 0.0f, 1.0f}));
+        // q and -q are the same rotation.
+        const float sign = fromAxes.w * q.w + fromAxes.x * q.x + fromAxes.y * q.y + fromAxes.z * q.z < 0.0f ? -1.0f : 1.0f;
+        const XrQuaternionf expected{q.x * sign, q.y * sign, q.z * sign, q.w * sign};
+        CHECK(std::abs(fromAxes.x - expected.x) < 1.0e-4f && std::abs(fromAxes.y - expected.y) < 1.0e-4f &&
+              std::abs(fromAxes.z - expected.z) < 1.0e-4f && std::abs(fromAxes.w - expected.w) < 1.0e-4f);
+    }
+}
+
+// Every count from 0 to kMaxCount, starting at each offset within a SIMD
+// step, so the unaligned loads and every tail length run.
+TEST_CASE(TransformVectorsMatchesScalarForEveryCount) {
+    for (size_t count = 0; count <= kMaxCount; ++count) {
+        for (size_t offset = 0; offset < 4; ++offset) {
+            const XrPosef pose = RandomPose();
+            const flutter_xr::Matrix3 rotation = flutter_xr::RotationMatrix(pose.orientation);
+            std::vector<XrVector3f> input(count + offset);
+            for (XrVector3f& v : input) {
+                v = RandomVector(10.0f);
+            }
+            GuardedVectors output(count);
+            flutter_xr::detail::TransformVectors(rotation, pose.position, input.data() + offset, output.data(), count);
+            CHECK(output.GuardsIntact(count));
+            for (size_t i = 0; i < count; ++i) {
+                const XrVector3f expected =
+                    legacy::Add(pose.position, legacy::RotateVector(pose.orientation, input[offset + i]));
+                CHECK(Near(output.data()[i], expected));
+            }
+        }
+    }
+}
+
+TEST_CASE(BatchHelpersMatchScalarForEveryCount) {
+    for (size_t count = 0; count <= kMaxCount; ++count) {
+        const XrPosef pose = RandomPose();
+        std::vector<XrVector3f> input(count);
+        for (XrVector3f& v : input) {
+            v = RandomVector(10.0f);
+        }
+
+        GuardedVectors rotated(count);
+        flutter_xr::RotateVectors(pose.orientation, input.data(), rotated.data(), count);
+        GuardedVectors transformed(count);
+        flutter_xr::TransformPoints(pose, input.data(), transformed.data(), count);
+        CHECK(rotated.GuardsIntact(count));
+        CHECK(transformed.GuardsIntact(count));
+        for (size_t i = 0; i < count; ++i) {
+            CHECK(Near(rotated.data()[i], legacy::RotateVector(pose.orientation, input[i])));
+            CHECK(Near(transformed.data()[i], flutter_xr::TransformPoint(pose, input[i])));
+        }
+
+        // In place.
+        std::vector<XrVector3f> inPlace = input;
+        flutter_xr::TransformPoints(pose, inPlace.data(), inPlace.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            CHECK(Same(inPlace[i], transformed.data()[i]));
+        }
+    }
+}
+
+TEST_CASE(BatchComposePosesMatchesLegacySegmentPoses) {
+    for (size_t count = 0; count <= kMaxCount; ++count) {
+        const XrPosef parent = RandomPose();
+        std::vector<XrPosef> children(count);
+        std::vector<XrQuaternionf> rotations(count);
+        std::vector<XrVector3f> offsets(count);
+        for (size_t i = 0; i < count; ++i) {
+            rotations[i] = RandomRotation();
+            offsets[i] = RandomVector(0.5f);
+            children[i] = {rotations[i], legacy::RotateVector(rotations[i], offsets[i])};
+        }
+
+        std::vector<XrPosef> composed(count);
+        flutter_xr::ComposePoses(parent, children.data(), composed.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            const XrPosef expected = legacy::SegmentPose(parent, rotations[i], offsets[i]);
+            CHECK(Near(composed[i].orientation, expected.orientation));
+            CHECK(Near(composed[i].position, expected.position));
+
+            const XrPosef single = flutter_xr::ComposePoses(parent, children[i]);
+            CHECK(Near(composed[i].position, single.position));
+        }
+    }
+}
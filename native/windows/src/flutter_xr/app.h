@@ -4,30 +4,38 @@
 #include <dxgi1_6.h>
 #include <wrl/client.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "flutter_embedder.h"
+#include "flutter_xr/dirty_region.h"
+#include "flutter_xr/engine_process.h"
+#include "flutter_xr/flutter_bundle.h"
+#include "flutter_xr/frame_mailbox.h"
+#include "flutter_xr/frame_pipeline.h"
+#include "flutter_xr/panel_hit.h"
+#include "flutter_xr/pixel_convert.h"
+#include "flutter_xr/platform_task_runner.h"
+#include "flutter_xr/pointer_events.h"
+#include "flutter_xr/pointer_filter.h"
+#include "flutter_xr/pointer_ray.h"
+#include "flutter_xr/pointer_resampler.h"
+#include "flutter_xr/runner_config.h"
 #include "flutter_xr/shared.h"
+#include "flutter_xr/surface_scale.h"
+#include "flutter_xr/upload_scheduler.h"
+#include "flutter_xr/worker_pool.h"
 
 namespace flutter_xr {
 
-struct FlutterFrame {
-    std::mutex mutex;
-    std::vector<uint8_t> pixels;
-    size_t rowBytes = 0;
-    size_t width = 0;
-    size_t height = 0;
-    uint64_t frameIndex = 0;
-};
-
-struct FlutterBridgeState {
-    FlutterFrame latestFrame;
-    HANDLE firstFrameEvent = nullptr;
-};
-
 struct PointerHitResult {
     bool hasPose = false;
     bool onQuad = false;
@@ -37,16 +45,141 @@ struct PointerHitResult {
     XrQuaternionf pointerOrientation{0.0f, 0.0f, 0.0f, 1.0f};
     double xPixels = static_cast<double>(kFlutterSurfaceWidth) * 0.5;
     double yPixels = static_cast<double>(kFlutterSurfaceHeight) * 0.5;
+    // Index of the view whose panel was hit; only meaningful when onQuad.
+    size_t view = 0;
+};
+
+// Quad swapchain plus upload texture for one Flutter surface resolution.
+struct FlutterSurfaceTarget {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    XrSwapchain swapchain{XR_NULL_HANDLE};
+    std::vector<XrSwapchainImageD3D11KHR> images;
+    ComPtr<ID3D11Texture2D> texture;
+    bool imageReleased = false;
+    // Scale update of the owning view at which this target was last active.
+    uint64_t lastActiveUpdate = 0;
+};
+
+class FlutterXrApp;
+
+// One Flutter engine run by the runner and the user_data of its callbacks.
+// Engines share the AOT data, ICU data, platform thread, pixel workers and
+// upload budget. The counters attribute frame time, uploads and memory to
+// the engine that caused them.
+struct FlutterEngineHost {
+    FlutterEngineHost(FlutterXrApp* owner, size_t engineIndex, std::string dartEntrypoint)
+        : app(owner), index(engineIndex), entrypoint(std::move(dartEntrypoint)) {}
+
+    FlutterXrApp* const app;
+    const size_t index;
+    const std::string entrypoint;
+    FlutterEngine engine = nullptr;
+
+    // Guarded by the app's vsync mutex.
+    bool hasPendingVsyncBaton = false;
+    intptr_t pendingVsyncBaton = 0;
+    std::atomic<uint64_t> frameTargetNanos{0};
+
+    // Raster thread.
+    std::atomic<uint64_t> framesPresented{0};
+    std::atomic<uint64_t> rasterNanosTotal{0};
+    std::atomic<uint64_t> rasterNanosMax{0};
+    std::atomic<size_t> heapBackingStoreBytes{0};
+
+    // Render thread.
+    uint64_t uploadedBytes = 0;
+    uint64_t uploadNanos = 0;
+};
+
+// Newest frame of a view, read in place from its mailbox slot or from the
+// engine process's frame ring. Valid until the view's next acquire.
+struct FlutterFrame {
+    const uint8_t* pixels = nullptr;
+    size_t rowBytes = 0;
+    size_t width = 0;
+    size_t height = 0;
+    uint64_t frameIndex = 0;
+};
+
+// Changed rect of a view's latest frame, ready for UpdateSubresource.
+struct PendingViewUpload {
+    DirtyRect rect;
+    const uint8_t* pixels = nullptr;
+    size_t rowBytes = 0;
+};
+
+// One Flutter view shown as its own quad panel. The mailbox, the backing
+// store flag and the raster timings are used from the raster thread; the
+// rest belongs to the render thread.
+struct FlutterViewPanel {
+    FlutterViewPanel(size_t engineIndex, int64_t id, const XrPosef& pose, size_t frameCapacityBytes)
+        : engine(engineIndex),
+          viewId(id),
+          basePose(pose),
+          geometry(MakePanelGeometry(pose, kFlutterSurfaceWidth, kFlutterSurfaceHeight,
+                                     XrRect2Di{{0, 0}, {kFlutterSurfaceWidth, kFlutterSurfaceHeight}})),
+          frames(frameCapacityBytes) {}
+
+    // Index of the owning engine; view ids are unique per engine only.
+    const size_t engine;
+    const int64_t viewId;
+    // Pose of the whole panel; cropped content is placed on a sub-quad of it.
+    const XrPosef basePose;
+    // Set once the engine knows the view. The implicit view exists from
+    // FlutterEngineRun on; others once FlutterEngineAddView reports success.
+    std::atomic<bool> engineViewAdded{false};
+
+    std::vector<std::unique_ptr<FlutterSurfaceTarget>> surfaceTargets;
+    FlutterSurfaceTarget* activeSurface = nullptr;
+    std::future<std::unique_ptr<FlutterSurfaceTarget>> pendingSurface;
+    SurfaceScaleController surfaceScale;
+    uint64_t surfaceScaleUpdates = 0;
+    uint32_t metricsWidth = static_cast<uint32_t>(kFlutterSurfaceWidth);
+    uint32_t metricsHeight = static_cast<uint32_t>(kFlutterSurfaceHeight);
+    double pixelRatio = 1.0;
+
+    bool contentVisible = true;
+    DirtyRect contentBounds{0, 0, static_cast<uint32_t>(kFlutterSurfaceWidth), static_cast<uint32_t>(kFlutterSurfaceHeight)};
+    bool panelVisible = true;
+    PanelGeometry geometry;
+    bool textureChanged = false;
+
+    FrameMailbox frames;
+    bool pooledBackingStoreOutstanding = false;
+    // Size of the last backing store handed to the engine and whether the
+    // last present was an empty scene; raster thread only.
+    size_t rasterRowBytes = 0;
+    size_t rasterHeight = 0;
+    bool rasterPresentedEmpty = false;
+    std::atomic<uint64_t> rasterStartNanos{0};
+    std::atomic<uint64_t> rasterNanos{0};
+
+    TileChangeDetector dirtyTiles;
+    std::vector<PendingViewUpload> uploads;
+    std::vector<uint8_t> convertedPixels;
+    uint64_t uploadedFrameIndex = 0;
+    uint64_t uploadNanos = 0;
 };
 
 class FlutterXrApp {
    public:
+    explicit FlutterXrApp(const RunnerConfig& config);
     ~FlutterXrApp();
 
     void Initialize();
     void Run();
-    bool HandleFlutterSurfacePresent(const void* allocation, size_t rowBytes, size_t height);
-    void HandleFlutterPlatformMessage(const FlutterPlatformMessage* message);
+    bool HandleFlutterSurfacePresent(FlutterEngineHost& host, const void* allocation, size_t rowBytes, size_t height);
+    bool HandleFlutterCreateBackingStore(FlutterEngineHost& host,
+                                         const FlutterBackingStoreConfig* config,
+                                         FlutterBackingStore* backingStoreOut);
+    bool HandleFlutterCollectBackingStore(FlutterEngineHost& host, const FlutterBackingStore* backingStore);
+    bool HandleFlutterPresentView(FlutterEngineHost& host,
+                                  int64_t viewId,
+                                  const FlutterLayer** layers,
+                                  size_t layersCount);
+    void HandleFlutterPlatformMessage(FlutterEngineHost& host, const FlutterPlatformMessage* message);
+    void HandleFlutterVsync(FlutterEngineHost& host, intptr_t baton);
 
    private:
     enum class BackgroundMode : uint8_t {
@@ -56,45 +189,110 @@ class FlutterXrApp {
         Glb,
     };
 
+    void InitializeXr();
+    void LogStartupPhase(const char* phase) const;
+
     void CreateInstance();
     void InitializeSystem();
+    uint32_t LocateEyePositions(XrTime displayTime, std::array<XrVector3f, 2>* outPositions) const;
     void InitializeD3D11Device();
     void CreateSession();
     void CreateReferenceSpace();
 
     void SuggestBindings(XrPath interactionProfile, const std::vector<XrActionSuggestedBinding>& bindings);
     void InitializeInputActions();
+    void UpdatePointerFilterTuning();
+    bool LocatePointer(XrTime time, XrSpace pointerSpace, XrPosef* outPose) const;
+    PointerHitResult HitTestPointer(const XrPosef& pointerPose) const;
     PointerHitResult QueryPointerHit(XrTime predictedDisplayTime, XrSpace pointerSpace, XrPath handPath);
+    void UpdatePointerRay(const PointerHitResult& hit, bool* visible, float* length, XrPosef* pose);
+    void LateLatchPointerRays(XrTime predictedDisplayTime);
     bool SendFlutterPointerEvent(FlutterPointerPhase phase, double xPixels, double yPixels, int64_t buttons);
-    bool SendFlutterScrollEvent(double xPixels, double yPixels, double deltaXPixels, double deltaYPixels);
+    bool SubmitFlutterPointerEvents(uint64_t timestampNanos = 0);
+    FlutterEngineHost* PointerFlutterEngineHost() const;
+    bool FlutterEngineReachable(size_t engineIndex) const;
+    bool PointerEngineReachable() const;
     void EnsureFlutterPointerAdded(double xPixels, double yPixels);
+    bool RouteFlutterPointer(const PointerHitResult& hit);
+    void ResamplePointerHit(const PointerHitResult& hit, uint64_t sampleNanos, double* outX, double* outY,
+                            uint64_t* outEventNanos);
+    void QueueFlutterScroll(const PointerHitResult& rightHit, const PointerHitResult& leftHit);
     void PollInput(XrTime predictedDisplayTime);
 
+    XrSwapchain CreateImageSwapchain(int32_t width,
+                                     int32_t height,
+                                     const char* label,
+                                     bool* outStatic,
+                                     std::vector<XrSwapchainImageD3D11KHR>* outImages);
+    void WriteSwapchainImage(XrSwapchain swapchain,
+                             const std::vector<XrSwapchainImageD3D11KHR>& images,
+                             ID3D11Texture2D* source,
+                             const char* label);
     void CreateQuadSwapchain();
     void CreateBackgroundSwapchain();
     void CreatePointerRaySwapchain();
-    void CreateFlutterTexture();
+    void EnsureBackgroundResources();
+    void EnsurePointerRayResources();
     void CreateBackgroundTexture();
     void CreatePointerRayTexture();
 
-    void InitializeFlutterEngine();
-    bool UploadLatestFlutterFrame();
+    std::unique_ptr<FlutterSurfaceTarget> CreateFlutterSurfaceTarget(uint32_t width, uint32_t height) const;
+    FlutterSurfaceTarget* FindFlutterSurfaceTarget(const FlutterViewPanel& view, uint32_t width, uint32_t height) const;
+    FlutterViewPanel* FindFlutterView(size_t engineIndex, int64_t viewId) const;
+    void UpdateFlutterSurfaceScale(const XrFrameState& frameState);
+    void UpdateFlutterViewScale(FlutterViewPanel& view,
+                                float viewDistanceMeters,
+                                uint64_t rasterNanos,
+                                uint64_t frameBudgetNanos);
+    void EvictIdleFlutterSurfaceTargets(FlutterViewPanel& view);
+    void UpdateFlutterPanelHitTester();
+    FlutterEngineResult SendFlutterWindowMetrics(FlutterViewPanel& view, uint32_t width, uint32_t height, double pixelRatio);
+    void DestroyFlutterSurfaceTargets();
+
+    void InitializeFlutterEngines();
+    void StartEngineProcess();
+    void RunFlutterEngine(FlutterEngineHost& host);
+    void AddFlutterViews(FlutterEngineHost& host);
+    void ShutdownFlutterEngines();
+    void LogFlutterEngineStats() const;
+    void MaybeLogFlutterEngineStats();
+    void UploadLatestFlutterFrames(size_t* outBytesUploaded);
+    bool AcquireFlutterFrame(FlutterViewPanel& view, FlutterFrame* outFrame);
+    void PrepareFlutterViewUpload(FlutterViewPanel& view);
+    bool CommitFlutterViewUpload(FlutterViewPanel& view, size_t* outBytesUploaded);
+    void PrepareNextFrame();
+    void SetXrVsyncActive(bool active);
+    void PaceFlutterVsync(const XrFrameState& frameState);
+    void SendFlutterVsync(FlutterEngineHost& host, intptr_t baton, uint64_t frameStartNanos, uint64_t frameTargetNanos);
+    bool XrTimeToFlutterTime(XrTime time, uint64_t* outFlutterNanos) const;
+    void UpdateXrClockEstimate(const XrFrameState& frameState);
+    uint64_t EstimateFlutterTime(XrTime time) const;
     bool IsBackgroundEnabled();
     bool UploadBackgroundTexture();
+    void WriteBackgroundSwapchainIfStale();
     std::string HandleBackgroundMessage(const std::string& message);
 
     void PollEvents();
     void HandleSessionStateChanged(const XrEventDataSessionStateChanged& changed);
-    void RenderFrame();
+    XrFrameState WaitFrame();
+    void StartFrameWaitThread();
+    void StopFrameWaitThread();
+    void SubmitEmptyFrame(const XrFrameState& frameState);
+    void RenderFrame(const XrFrameState& frameState);
     void Shutdown();
 
+    const RunnerConfig config_;
+    WorkerPool pixelWorkers_;
+    TextureUploadScheduler textureUploads_;
+    FrameWaitThread frameWaitThread_;
+
     XrInstance instance_{XR_NULL_HANDLE};
     XrSystemId systemId_{XR_NULL_SYSTEM_ID};
     XrSession session_{XR_NULL_HANDLE};
     XrSpace appSpace_{XR_NULL_HANDLE};
+    XrSpace viewSpace_{XR_NULL_HANDLE};
     XrSpace pointerSpace_{XR_NULL_HANDLE};
     XrSpace leftPointerSpace_{XR_NULL_HANDLE};
-    XrSwapchain quadSwapchain_{XR_NULL_HANDLE};
     XrSwapchain backgroundSwapchain_{XR_NULL_HANDLE};
     XrSwapchain pointerRaySwapchain_{XR_NULL_HANDLE};
     XrActionSet inputActionSet_{XR_NULL_HANDLE};
@@ -119,18 +317,38 @@ class FlutterXrApp {
     float leftPointerRayLengthMeters_{0.0f};
     XrPosef pointerRayPose_{};
     XrPosef leftPointerRayPose_{};
-    double lastPointerX_{static_cast<double>(kFlutterSurfaceWidth) * 0.5};
-    double lastPointerY_{static_cast<double>(kFlutterSurfaceHeight) * 0.5};
+    PointerEventBatch pointerEvents_;
+    size_t pointerView_{0};
+    PointerResampler pointerResampler_;
+    PoseFilter rightPointerFilter_;
+    PoseFilter leftPointerFilter_;
+    // Filter states from before this frame's sample, so the late-latched
+    // ray can be filtered the same way without committing the late sample.
+    PoseFilter rightPointerFilterBeforeFrame_;
+    PoseFilter leftPointerFilterBeforeFrame_;
 
     ComPtr<ID3D11Device> device_;
     ComPtr<ID3D11DeviceContext> deviceContext_;
     DXGI_FORMAT colorFormat_{DXGI_FORMAT_R8G8B8A8_UNORM};
     bool isBgraFormat_{false};
 
-    std::vector<XrSwapchainImageD3D11KHR> quadImages_;
     std::vector<XrSwapchainImageD3D11KHR> backgroundImages_;
     std::vector<XrSwapchainImageD3D11KHR> pointerRayImages_;
-    ComPtr<ID3D11Texture2D> flutterTexture_;
+    bool staticSwapchainsSupported_{true};
+    bool backgroundSwapchainStatic_{false};
+    bool backgroundImageWritten_{false};
+    uint64_t backgroundImageVersion_{0};
+    bool pointerRayImageWritten_{false};
+    uint32_t pointerRayLayerBudget_{0};
+    PointerRayLayerPlan pointerRayPlan_;
+    // Created in the constructor and never resized, so raster-thread
+    // callbacks can look views up without locking.
+    std::vector<std::unique_ptr<FlutterViewPanel>> flutterViews_;
+    PanelHitTester flutterPanelHits_;
+    // View index of each panel in flutterPanelHits_, and the geometry it was
+    // added with.
+    std::vector<size_t> flutterPanelHitViews_;
+    std::vector<PanelGeometry> flutterPanelHitGeometry_;
     ComPtr<ID3D11Texture2D> backgroundTexture_;
     ComPtr<ID3D11Texture2D> pointerRayTexture_;
     std::mutex backgroundMutex_;
@@ -139,12 +357,27 @@ class FlutterXrApp {
     std::vector<uint32_t> backgroundCustomPixels_;
     uint64_t backgroundConfigVersion_{1};
     uint64_t backgroundUploadedVersion_{0};
-    FlutterEngine flutterEngine_{nullptr};
-    FlutterBridgeState flutterBridge_;
-    uint64_t uploadedFrameIndex_{0};
-    std::vector<uint8_t> convertedPixels_;
-    std::string assetsPathUtf8_;
-    std::string icuPathUtf8_;
+    PlatformTaskRunner platformTasks_;
+    // Created in the constructor and never resized, like flutterViews_.
+    std::vector<std::unique_ptr<FlutterEngineHost>> flutterEngines_;
+    FlutterBundle flutterBundle_;
+    // Set with --engine-process; the engine host then has no engine handle
+    // and all engine traffic goes through the child process.
+    std::unique_ptr<EngineProcess> engineProcess_;
+    std::chrono::steady_clock::time_point lastEngineStatsLog_{};
+    std::chrono::steady_clock::time_point startupStart_{};
+    bool firstFlutterFrameLogged_{false};
+    bool firstFrameSubmittedLogged_{false};
+    size_t preparedFlutterBytes_{0};
+    uint64_t quadFramesCopied_{0};
+    uint64_t quadFramesElided_{0};
+    std::mutex vsyncMutex_;
+    bool xrVsyncActive_{false};
+    double smoothedDisplayLatencyNanos_{0.0};
+    PFN_xrConvertTimeToWin32PerformanceCounterKHR convertXrTimeToPerformanceCounter_{nullptr};
+    int64_t performanceCounterFrequency_{0};
+    std::atomic<bool> xrClockOffsetValid_{false};
+    std::atomic<int64_t> xrClockOffsetNanos_{0};
 };
 
 }  // namespace flutter_xr
@@ -5,12 +5,14 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
 #include <limits>
 #include <stdexcept>
 #include <string>
 #include <system_error>
+#include <utility>
 #include <vector>
 
 namespace flutter_xr {
@@ -26,6 +28,8 @@ uint32_t PackColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a, bool bgraFormat)
            (static_cast<uint32_t>(a) << 24U);
 }
 
+constexpr size_t kMinRowsPerStripe = 16;
+
 std::string TrimAscii(const std::string& value) {
     const auto begin = std::find_if_not(value.begin(), value.end(), [](unsigned char ch) { return std::isspace(ch) != 0; });
     const auto end = std::find_if_not(value.rbegin(), value.rend(), [](unsigned char ch) { return std::isspace(ch) != 0; }).base();
@@ -41,7 +45,7 @@ std::string ToLowerAscii(std::string value) {
     return value;
 }
 
-bool BuildGroundGridPixels(bool bgraFormat, std::vector<uint32_t>* outPixels) {
+bool BuildGroundGridPixels(WorkerPool& pool, bool bgraFormat, std::vector<uint32_t>* outPixels) {
     if (outPixels == nullptr) {
         return false;
     }
@@ -55,27 +59,30 @@ bool BuildGroundGridPixels(bool bgraFormat, std::vector<uint32_t>* outPixels) {
     constexpr int kMajorThickness = 1;
     constexpr int kMinorThickness = 1;
 
-    for (size_t y = 0; y < height; ++y) {
-        for (size_t x = 0; x < width; ++x) {
-            const bool majorLine = (static_cast<int>(x) % kMajorCell) < kMajorThickness ||
-                                   (static_cast<int>(y) % kMajorCell) < kMajorThickness;
-            const bool minorLine = (static_cast<int>(x) % kMinorCell) < kMinorThickness ||
-                                   (static_cast<int>(y) % kMinorCell) < kMinorThickness;
-
-            const float u = (static_cast<float>(x) / static_cast<float>(width - 1)) * 2.0f - 1.0f;
-            const float v = (static_cast<float>(y) / static_cast<float>(height - 1)) * 2.0f - 1.0f;
-            const float radial = std::sqrt(u * u + v * v);
-            const float fade = std::clamp(1.2f - radial, 0.0f, 1.0f);
-
-            uint8_t shade = static_cast<uint8_t>(6.0f * fade);
-            if (minorLine || majorLine) {
-                shade = minorLine ? static_cast<uint8_t>(220.0f * fade) : shade;
-                shade = majorLine ? static_cast<uint8_t>(255.0f * fade) : shade;
+    uint32_t* pixels = outPixels->data();
+    pool.ParallelForRows(height, kMinRowsPerStripe, [&](size_t rowBegin, size_t rowEnd) {
+        for (size_t y = rowBegin; y < rowEnd; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                const bool majorLine = (static_cast<int>(x) % kMajorCell) < kMajorThickness ||
+                                       (static_cast<int>(y) % kMajorCell) < kMajorThickness;
+                const bool minorLine = (static_cast<int>(x) % kMinorCell) < kMinorThickness ||
+                                       (static_cast<int>(y) % kMinorCell) < kMinorThickness;
+
+                const float u = (static_cast<float>(x) / static_cast<float>(width - 1)) * 2.0f - 1.0f;
+                const float v = (static_cast<float>(y) / static_cast<float>(height - 1)) * 2.0f - 1.0f;
+                const float radial = std::sqrt(u * u + v * v);
+                const float fade = std::clamp(1.2f - radial, 0.0f, 1.0f);
+
+                uint8_t shade = static_cast<uint8_t>(6.0f * fade);
+                if (minorLine || majorLine) {
+                    shade = minorLine ? static_cast<uint8_t>(220.0f * fade) : shade;
+                    shade = majorLine ? static_cast<uint8_t>(255.0f * fade) : shade;
+                }
+
+                pixels[y * width + x] = PackColor(shade, shade, shade, 255, bgraFormat);
             }
-
-            (*outPixels)[y * width + x] = PackColor(shade, shade, shade, 255, bgraFormat);
         }
-    }
+    });
 
     return true;
 }
@@ -135,7 +142,8 @@ bool ResolveExistingFilePath(const std::string& utf8Path, std::filesystem::path*
     return false;
 }
 
-bool DecodeImageFileToPixels(const std::wstring& sourcePath,
+bool DecodeImageFileToPixels(WorkerPool& pool,
+                             const std::wstring& sourcePath,
                              bool bgraFormat,
                              std::vector<uint32_t>* outPixels,
                              std::string* outError) {
@@ -249,45 +257,61 @@ bool DecodeImageFileToPixels(const std::wstring& sourcePath,
     }
 
     outPixels->resize(pixelCount);
-    for (size_t i = 0; i < pixelCount; ++i) {
-        const uint8_t r = rgbaPixels[i * 4 + 0];
-        const uint8_t g = rgbaPixels[i * 4 + 1];
-        const uint8_t b = rgbaPixels[i * 4 + 2];
-        const uint8_t a = rgbaPixels[i * 4 + 3];
-        (*outPixels)[i] = PackColor(r, g, b, a, bgraFormat);
-    }
+    auto* packed = reinterpret_cast<uint8_t*>(outPixels->data());
+    pool.ParallelForRows(static_cast<size_t>(kBackgroundTextureHeight), kMinRowsPerStripe, [&](size_t rowBegin, size_t rowEnd) {
+        const uint8_t* source = rgbaPixels.data() + rowBegin * rowBytes;
+        uint8_t* destination = packed + rowBegin * rowBytes;
+        if (bgraFormat) {
+            SwizzleRgbaToBgra(source, rowBytes, destination, rowBytes, static_cast<size_t>(kBackgroundTextureWidth),
+                              rowEnd - rowBegin);
+        } else {
+            std::memcpy(destination, source, (rowEnd - rowBegin) * rowBytes);
+        }
+    });
     return true;
 }
 
 }  // namespace
 
 void FlutterXrApp::CreateBackgroundSwapchain() {
-    XrSwapchainCreateInfo swapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
-    swapchainCreateInfo.createFlags = 0;
-    swapchainCreateInfo.usageFlags = XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
-    swapchainCreateInfo.format = static_cast<int64_t>(colorFormat_);
-    swapchainCreateInfo.sampleCount = 1;
-    swapchainCreateInfo.width = kBackgroundTextureWidth;
-    swapchainCreateInfo.height = kBackgroundTextureHeight;
-    swapchainCreateInfo.faceCount = 1;
-    swapchainCreateInfo.arraySize = 1;
-    swapchainCreateInfo.mipCount = 1;
-
-    ThrowIfXrFailed(xrCreateSwapchain(session_, &swapchainCreateInfo, &backgroundSwapchain_), "xrCreateSwapchain(background)",
-                    instance_);
-
-    uint32_t imageCount = 0;
-    ThrowIfXrFailed(xrEnumerateSwapchainImages(backgroundSwapchain_, 0, &imageCount, nullptr),
-                    "xrEnumerateSwapchainImages(background count)", instance_);
-    if (imageCount == 0) {
-        throw std::runtime_error("Runtime returned zero background swapchain images.");
-    }
-
-    backgroundImages_.resize(imageCount, {XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR});
-    ThrowIfXrFailed(
-        xrEnumerateSwapchainImages(backgroundSwapchain_, imageCount, &imageCount,
-                                   reinterpret_cast<XrSwapchainImageBaseHeader*>(backgroundImages_.data())),
-        "xrEnumerateSwapchainImages(background data)", instance_);
+    backgroundSwapchain_ = CreateImageSwapchain(kBackgroundTextureWidth, kBackgroundTextureHeight, "background",
+                                                &backgroundSwapchainStatic_, &backgroundImages_);
+    backgroundImageWritten_ = false;
+}
+
+void FlutterXrApp::EnsureBackgroundResources() {
+    if (backgroundSwapchain_ != XR_NULL_HANDLE && backgroundTexture_ != nullptr) {
+        return;
+    }
+
+    // Created on first use so sessions that start with, or never leave,
+    // background mode None do not pay for them at startup.
+    CreateBackgroundTexture();
+    CreateBackgroundSwapchain();
+}
+
+void FlutterXrApp::WriteBackgroundSwapchainIfStale() {
+    uint64_t textureVersion = 0;
+    {
+        std::lock_guard<std::mutex> lock(backgroundMutex_);
+        textureVersion = backgroundUploadedVersion_;
+    }
+    // Version 0 means the texture has not received a complete image yet.
+    if (textureVersion == 0 || (backgroundImageWritten_ && backgroundImageVersion_ == textureVersion)) {
+        return;
+    }
+
+    // A static image can be written only once, so new content needs a new
+    // swapchain.
+    if (backgroundImageWritten_ && backgroundSwapchainStatic_) {
+        xrDestroySwapchain(backgroundSwapchain_);
+        backgroundSwapchain_ = XR_NULL_HANDLE;
+        CreateBackgroundSwapchain();
+    }
+
+    WriteSwapchainImage(backgroundSwapchain_, backgroundImages_, backgroundTexture_.Get(), "background");
+    backgroundImageWritten_ = true;
+    backgroundImageVersion_ = textureVersion;
 }
 
 void FlutterXrApp::CreateBackgroundTexture() {
@@ -307,13 +331,8 @@ void FlutterXrApp::CreateBackgroundTexture() {
     ThrowIfFailed(device_->CreateTexture2D(&desc, nullptr, backgroundTexture_.ReleaseAndGetAddressOf()),
                   "ID3D11Device::CreateTexture2D(backgroundTexture)");
 
-    std::vector<uint32_t> initialPixels;
-    if (!BuildGroundGridPixels(isBgraFormat_, &initialPixels)) {
-        throw std::runtime_error("Failed to initialize background texture pixels.");
-    }
-
-    deviceContext_->UpdateSubresource(backgroundTexture_.Get(), 0, nullptr, initialPixels.data(),
-                                      static_cast<UINT>(kBackgroundTextureWidth * sizeof(uint32_t)), 0);
+    // The first image arrives through the upload scheduler like any later one.
+    std::lock_guard<std::mutex> lock(backgroundMutex_);
     backgroundUploadedVersion_ = 0;
 }
 
@@ -335,12 +354,13 @@ bool FlutterXrApp::UploadBackgroundTexture() {
         }
 
         mode = backgroundMode_;
-        if (mode == BackgroundMode::Dds) {
+        if (mode == BackgroundMode::Dds && !textureUploads_.HasPendingUpload(backgroundTexture_.Get(), targetVersion)) {
             pixels = backgroundCustomPixels_;
         }
     }
 
     if (mode == BackgroundMode::None) {
+        textureUploads_.Cancel(backgroundTexture_.Get());
         std::lock_guard<std::mutex> lock(backgroundMutex_);
         if (backgroundConfigVersion_ == targetVersion) {
             backgroundUploadedVersion_ = targetVersion;
@@ -348,32 +368,37 @@ bool FlutterXrApp::UploadBackgroundTexture() {
         return true;
     }
 
-    if (mode == BackgroundMode::GroundGrid) {
-        if (!BuildGroundGridPixels(isBgraFormat_, &pixels)) {
-            return false;
-        }
-    } else if (mode == BackgroundMode::Dds) {
-        if (pixels.empty()) {
+    // A new image goes out in row bands over several frames. The swapchain
+    // keeps showing the previous version until every band has landed.
+    if (!textureUploads_.HasPendingUpload(backgroundTexture_.Get(), targetVersion)) {
+        if (mode == BackgroundMode::GroundGrid) {
+            if (!BuildGroundGridPixels(pixelWorkers_, isBgraFormat_, &pixels)) {
+                return false;
+            }
+        } else if (mode == BackgroundMode::Dds) {
+            if (pixels.empty()) {
+                return false;
+            }
+        } else {
             return false;
         }
-    } else {
-        return false;
-    }
 
-    {
-        std::lock_guard<std::mutex> lock(backgroundMutex_);
-        if (backgroundConfigVersion_ != targetVersion) {
-            return false;
-        }
+        textureUploads_.Submit(backgroundTexture_.Get(), std::move(pixels), kBackgroundTextureWidth, kBackgroundTextureHeight,
+                               targetVersion);
     }
 
-    deviceContext_->UpdateSubresource(backgroundTexture_.Get(), 0, nullptr, pixels.data(),
-                                      static_cast<UINT>(kBackgroundTextureWidth * sizeof(uint32_t)), 0);
+    textureUploads_.Pump(deviceContext_.Get());
+
+    uint64_t completedVersion = 0;
+    if (!textureUploads_.TakeCompleted(backgroundTexture_.Get(), &completedVersion)) {
+        return false;
+    }
 
     std::lock_guard<std::mutex> lock(backgroundMutex_);
-    if (backgroundConfigVersion_ == targetVersion) {
-        backgroundUploadedVersion_ = targetVersion;
+    if (backgroundConfigVersion_ != completedVersion) {
+        return false;
     }
+    backgroundUploadedVersion_ = completedVersion;
     return true;
 }
 
@@ -419,7 +444,7 @@ std::string FlutterXrApp::HandleBackgroundMessage(const std::string& message) {
 
         std::vector<uint32_t> decodedPixels;
         std::string decodeError;
-        if (!DecodeImageFileToPixels(resolvedPath.wstring(), isBgraFormat_, &decodedPixels, &decodeError)) {
+        if (!DecodeImageFileToPixels(pixelWorkers_, resolvedPath.wstring(), isBgraFormat_, &decodedPixels, &decodeError)) {
             return "error:" + decodeError;
         }
 
@@ -8,7 +8,10 @@
 #include <cmath>
 #include <cstring>
 #include <exception>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
 #include <thread>
 
@@ -25,23 +28,42 @@ uint32_t PackColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a, bool bgraFormat)
            (static_cast<uint32_t>(a) << 24U);
 }
 
-constexpr float kPi = 3.14159265358979323846f;
 constexpr uint32_t kPointerRayHandCount = 2;
-constexpr uint32_t kMaxPointerRayLayerCount = kPointerRayHandCount * kPointerRayCylinderSegmentCount;
+constexpr uint32_t kMaxPointerRayLayerCount = kPointerRayHandCount * kMaxPointerRaySegments;
+constexpr uint32_t kMaxEyeCount = 2;
+// The background and one panel per Flutter view.
+constexpr uint32_t kMaxNonRayLayerCount = 1 + static_cast<uint32_t>(kMaxFlutterViews);
 
-XrQuaternionf MakeXAxisRotation(float radians) {
-    const float halfAngle = radians * 0.5f;
-    return {std::sin(halfAngle), 0.0f, 0.0f, std::cos(halfAngle)};
-}
-
-float ComputePointerRaySegmentWidthMeters() {
-    const float radius = kPointerRayCylinderDiameterMeters * 0.5f;
-    const float halfSegmentAngle = kPi / static_cast<float>(kPointerRayCylinderSegmentCount);
-    return 2.0f * radius * std::tan(halfSegmentAngle);
-}
+// How long the render loop waits for a pipelined frame before polling events
+// and the console again.
+constexpr std::chrono::milliseconds kFrameStatePollInterval{50};
 
 }  // namespace
 
+FlutterXrApp::FlutterXrApp(const RunnerConfig& config)
+    : config_(config),
+      pixelWorkers_(config.workerThreads),
+      textureUploads_(config.uploadBudgetKb * 1024, config.uploadBudgetMs),
+      frameWaitThread_(config.framePipelineDepth > 1 ? config.framePipelineDepth - 1 : 1),
+      pointerEvents_(config.pointerMoveThresholdPx,
+                     static_cast<double>(kFlutterSurfaceWidth) * 0.5,
+                     static_cast<double>(kFlutterSurfaceHeight) * 0.5) {
+    // With an engine process, frames arrive in its shared frame ring and the
+    // views' own mailboxes stay empty.
+    const size_t frameCapacityBytes = config.useEngineProcess ? 0 : SurfaceScaleController::MaxFrameBytes();
+    // Each engine gets its own run of panels, left to right in engine order.
+    const size_t panelCount = config.engineEntrypoints.size() * config.flutterViews;
+    for (size_t e = 0; e < config.engineEntrypoints.size(); ++e) {
+        flutterEngines_.push_back(std::make_unique<FlutterEngineHost>(this, e, config.engineEntrypoints[e]));
+        for (size_t v = 0; v < config.flutterViews; ++v) {
+            flutterViews_.push_back(std::make_unique<FlutterViewPanel>(
+                e, kFlutterViewId + static_cast<int64_t>(v), MakePanelPose(flutterViews_.size(), panelCount),
+                frameCapacityBytes));
+        }
+    }
+    UpdateFlutterPanelHitTester();
+}
+
 FlutterXrApp::~FlutterXrApp() {
     try {
         Shutdown();
@@ -51,25 +73,58 @@ FlutterXrApp::~FlutterXrApp() {
 }
 
 void FlutterXrApp::Initialize() {
-    CreateInstance();
-    InitializeSystem();
-    InitializeD3D11Device();
-    CreateSession();
-    CreateReferenceSpace();
+    startupStart_ = std::chrono::steady_clock::now();
+    std::cout << "Pixel worker threads: " << pixelWorkers_.ThreadCount() << "\n";
     pointerRayPose_.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
     pointerRayPose_.position = {0.0f, 0.0f, 0.0f};
     pointerRayLengthMeters_ = kPointerRayFallbackLengthMeters;
     leftPointerRayPose_.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
     leftPointerRayPose_.position = {0.0f, 0.0f, 0.0f};
     leftPointerRayLengthMeters_ = kPointerRayFallbackLengthMeters;
+
+    // OpenXR setup and the Flutter engine share no state until the first
+    // frame, so the session comes up on a helper thread while the engine and
+    // isolate boot.
+    std::future<void> xrSetup = std::async(std::launch::async, [this] { InitializeXr(); });
+    try {
+        if (config_.useEngineProcess) {
+            StartEngineProcess();
+        } else {
+            InitializeFlutterEngines();
+        }
+    } catch (...) {
+        xrSetup.wait();
+        throw;
+    }
+    xrSetup.get();
+
+    // Platform messages depend on the swapchain format, so platform tasks
+    // queued while the session was coming up run from here on.
+    platformTasks_.Release();
+    if (engineProcess_ != nullptr) {
+        engineProcess_->Release();
+    }
+    LogStartupPhase("initialized");
+}
+
+void FlutterXrApp::InitializeXr() {
+    CreateInstance();
+    InitializeSystem();
+    InitializeD3D11Device();
+    CreateSession();
+    CreateReferenceSpace();
+    LogStartupPhase("openxr session created");
     InitializeInputActions();
     CreateQuadSwapchain();
-    CreateBackgroundSwapchain();
-    CreatePointerRaySwapchain();
-    CreateFlutterTexture();
-    CreateBackgroundTexture();
-    CreatePointerRayTexture();
-    InitializeFlutterEngine();
+    LogStartupPhase("panel swapchain created");
+}
+
+void FlutterXrApp::LogStartupPhase(const char* phase) const {
+    const double elapsedMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupStart_).count();
+    std::ostringstream line;
+    line << "Startup: " << phase << " at " << std::fixed << std::setprecision(1) << elapsedMs << " ms\n";
+    std::cout << line.str();
 }
 
 void FlutterXrApp::Run() {
@@ -95,12 +150,22 @@ void FlutterXrApp::Run() {
             continue;
         }
 
-        RenderFrame();
+        if (frameWaitThread_.IsRunning()) {
+            XrFrameState frameState{XR_TYPE_FRAME_STATE};
+            if (frameWaitThread_.Pop(&frameState, kFrameStatePollInterval)) {
+                RenderFrame(frameState);
+                PrepareNextFrame();
+            }
+        } else {
+            RenderFrame(WaitFrame());
+        }
+        MaybeLogFlutterEngineStats();
     }
 }
 
 void FlutterXrApp::CreateInstance() {
     const std::array<const char*, 1> requiredExtensions = {XR_KHR_D3D11_ENABLE_EXTENSION_NAME};
+    const std::array<const char*, 1> optionalExtensions = {XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME};
 
     uint32_t extensionCount = 0;
     ThrowIfXrFailed(xrEnumerateInstanceExtensionProperties(nullptr, 0, &extensionCount, nullptr),
@@ -119,6 +184,16 @@ void FlutterXrApp::CreateInstance() {
         }
     }
 
+    std::vector<const char*> enabledExtensions(requiredExtensions.begin(), requiredExtensions.end());
+    for (const char* optional : optionalExtensions) {
+        const bool found =
+            std::any_of(extensionProps.begin(), extensionProps.end(),
+                        [&](const XrExtensionProperties& prop) { return std::strcmp(prop.extensionName, optional) == 0; });
+        if (found) {
+            enabledExtensions.push_back(optional);
+        }
+    }
+
     XrInstanceCreateInfo createInfo{XR_TYPE_INSTANCE_CREATE_INFO};
     std::strncpy(createInfo.applicationInfo.applicationName, "flutter_open_xr",
                  sizeof(createInfo.applicationInfo.applicationName) - 1);
@@ -126,14 +201,30 @@ void FlutterXrApp::CreateInstance() {
     std::strncpy(createInfo.applicationInfo.engineName, "custom", sizeof(createInfo.applicationInfo.engineName) - 1);
     createInfo.applicationInfo.engineVersion = 1;
     createInfo.applicationInfo.apiVersion = XR_API_VERSION_1_0;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
-    createInfo.enabledExtensionNames = requiredExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.enabledExtensionNames = enabledExtensions.data();
 
     ThrowIfXrFailed(xrCreateInstance(&createInfo, &instance_), "xrCreateInstance");
 
     XrInstanceProperties instanceProps{XR_TYPE_INSTANCE_PROPERTIES};
     ThrowIfXrFailed(xrGetInstanceProperties(instance_, &instanceProps), "xrGetInstanceProperties", instance_);
     std::cout << "OpenXR runtime: " << instanceProps.runtimeName << "\n";
+
+    const bool hasTimeConversion =
+        std::find_if(enabledExtensions.begin(), enabledExtensions.end(), [](const char* name) {
+            return std::strcmp(name, XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME) == 0;
+        }) != enabledExtensions.end();
+    LARGE_INTEGER frequency{};
+    if (hasTimeConversion && QueryPerformanceFrequency(&frequency) && frequency.QuadPart > 0) {
+        ThrowIfXrFailed(xrGetInstanceProcAddr(instance_, "xrConvertTimeToWin32PerformanceCounterKHR",
+                                              reinterpret_cast<PFN_xrVoidFunction*>(&convertXrTimeToPerformanceCounter_)),
+                        "xrGetInstanceProcAddr(xrConvertTimeToWin32PerformanceCounterKHR)", instance_);
+        performanceCounterFrequency_ = frequency.QuadPart;
+    } else {
+        std::cout << "[warn] " << XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME
+                  << " unavailable. Flutter vsync falls back to the display period"
+                  << " and input timestamps are estimated.\n";
+    }
 }
 
 void FlutterXrApp::InitializeSystem() {
@@ -143,6 +234,42 @@ void FlutterXrApp::InitializeSystem() {
 
     viewConfigType_ = SelectViewConfigurationType(instance_, systemId_);
     blendMode_ = SelectBlendMode(instance_, systemId_, viewConfigType_);
+
+    // Rays get what is left of the runtime's layer limit after the panels
+    // and the background, capped by the configured budget.
+    XrSystemProperties systemProperties{XR_TYPE_SYSTEM_PROPERTIES};
+    ThrowIfXrFailed(xrGetSystemProperties(instance_, systemId_, &systemProperties), "xrGetSystemProperties", instance_);
+    const uint32_t nonRayLayerCount = 1 + static_cast<uint32_t>(flutterViews_.size());
+    const uint32_t runtimeRayLayers = systemProperties.graphicsProperties.maxLayerCount > nonRayLayerCount
+                                          ? systemProperties.graphicsProperties.maxLayerCount - nonRayLayerCount
+                                          : 0;
+    pointerRayLayerBudget_ =
+        std::min({config_.pointerRayLayerBudget, runtimeRayLayers, kMaxPointerRayLayerCount});
+}
+
+uint32_t FlutterXrApp::LocateEyePositions(XrTime displayTime, std::array<XrVector3f, 2>* outPositions) const {
+    XrViewLocateInfo locateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+    locateInfo.viewConfigurationType = viewConfigType_;
+    locateInfo.displayTime = displayTime;
+    locateInfo.space = appSpace_;
+
+    XrViewState viewState{XR_TYPE_VIEW_STATE};
+    std::array<XrView, kMaxEyeCount> views{};
+    for (XrView& view : views) {
+        view = XrView{XR_TYPE_VIEW};
+    }
+    uint32_t viewCount = 0;
+    if (XR_FAILED(xrLocateViews(session_, &locateInfo, &viewState, static_cast<uint32_t>(views.size()), &viewCount,
+                                views.data()))) {
+        return 0;
+    }
+    if ((viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) == 0 || viewCount == 0) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < viewCount; ++i) {
+        (*outPositions)[i] = views[i].pose.position;
+    }
+    return viewCount;
 }
 
 void FlutterXrApp::InitializeD3D11Device() {
@@ -209,6 +336,9 @@ void FlutterXrApp::CreateReferenceSpace() {
     spaceInfo.poseInReferenceSpace.position = {0.0f, 0.0f, 0.0f};
 
     ThrowIfXrFailed(xrCreateReferenceSpace(session_, &spaceInfo, &appSpace_), "xrCreateReferenceSpace", instance_);
+
+    spaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
+    ThrowIfXrFailed(xrCreateReferenceSpace(session_, &spaceInfo, &viewSpace_), "xrCreateReferenceSpace(view)", instance_);
 }
 
 void FlutterXrApp::CreateQuadSwapchain() {
@@ -225,83 +355,93 @@ void FlutterXrApp::CreateQuadSwapchain() {
 
     colorFormat_ = SelectSwapchainFormat(formats);
     isBgraFormat_ = IsBgraFormat(colorFormat_);
-
-    XrSwapchainCreateInfo swapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
-    swapchainCreateInfo.createFlags = 0;
-    swapchainCreateInfo.usageFlags = XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
-    swapchainCreateInfo.format = static_cast<int64_t>(colorFormat_);
-    swapchainCreateInfo.sampleCount = 1;
-    swapchainCreateInfo.width = kFlutterSurfaceWidth;
-    swapchainCreateInfo.height = kFlutterSurfaceHeight;
-    swapchainCreateInfo.faceCount = 1;
-    swapchainCreateInfo.arraySize = 1;
-    swapchainCreateInfo.mipCount = 1;
-
-    ThrowIfXrFailed(xrCreateSwapchain(session_, &swapchainCreateInfo, &quadSwapchain_), "xrCreateSwapchain", instance_);
-
-    uint32_t imageCount = 0;
-    ThrowIfXrFailed(xrEnumerateSwapchainImages(quadSwapchain_, 0, &imageCount, nullptr), "xrEnumerateSwapchainImages(count)",
-                    instance_);
-    if (imageCount == 0) {
-        throw std::runtime_error("Runtime returned zero swapchain images.");
+    if (isBgraFormat_) {
+        std::cout << "BGRA swapchain selected. Pixel conversion kernel: " << PixelKernelName(SelectedPixelKernel()) << "\n";
     }
 
-    quadImages_.resize(imageCount, {XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR});
-    ThrowIfXrFailed(xrEnumerateSwapchainImages(quadSwapchain_, imageCount, &imageCount,
-                                               reinterpret_cast<XrSwapchainImageBaseHeader*>(quadImages_.data())),
-                    "xrEnumerateSwapchainImages(data)", instance_);
+    for (const auto& view : flutterViews_) {
+        const size_t level = view->surfaceScale.Level();
+        view->surfaceTargets.push_back(CreateFlutterSurfaceTarget(SurfaceScaleController::ScaledWidth(level),
+                                                                  SurfaceScaleController::ScaledHeight(level)));
+        view->activeSurface = view->surfaceTargets.back().get();
+    }
 }
 
-void FlutterXrApp::CreatePointerRaySwapchain() {
+XrSwapchain FlutterXrApp::CreateImageSwapchain(int32_t width,
+                                               int32_t height,
+                                               const char* label,
+                                               bool* outStatic,
+                                               std::vector<XrSwapchainImageD3D11KHR>* outImages) {
     XrSwapchainCreateInfo swapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
     swapchainCreateInfo.createFlags = 0;
     swapchainCreateInfo.usageFlags = XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
     swapchainCreateInfo.format = static_cast<int64_t>(colorFormat_);
     swapchainCreateInfo.sampleCount = 1;
-    swapchainCreateInfo.width = kPointerRayTextureWidth;
-    swapchainCreateInfo.height = kPointerRayTextureHeight;
+    swapchainCreateInfo.width = width;
+    swapchainCreateInfo.height = height;
     swapchainCreateInfo.faceCount = 1;
     swapchainCreateInfo.arraySize = 1;
     swapchainCreateInfo.mipCount = 1;
 
-    ThrowIfXrFailed(xrCreateSwapchain(session_, &swapchainCreateInfo, &pointerRaySwapchain_), "xrCreateSwapchain(pointerRay)",
-                    instance_);
+    XrSwapchain swapchain = XR_NULL_HANDLE;
+    *outStatic = false;
+    if (staticSwapchainsSupported_) {
+        swapchainCreateInfo.createFlags = XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT;
+        const XrResult staticResult = xrCreateSwapchain(session_, &swapchainCreateInfo, &swapchain);
+        if (XR_SUCCEEDED(staticResult)) {
+            *outStatic = true;
+        } else {
+            std::cout << "[warn] Runtime rejected static-image swapchains (" << XrResultToString(instance_, staticResult)
+                      << "). Falling back to upload on content change.\n";
+            staticSwapchainsSupported_ = false;
+            swapchainCreateInfo.createFlags = 0;
+        }
+    }
+    if (swapchain == XR_NULL_HANDLE) {
+        ThrowIfXrFailed(xrCreateSwapchain(session_, &swapchainCreateInfo, &swapchain),
+                        (std::string("xrCreateSwapchain(") + label + ")").c_str(), instance_);
+    }
 
     uint32_t imageCount = 0;
-    ThrowIfXrFailed(xrEnumerateSwapchainImages(pointerRaySwapchain_, 0, &imageCount, nullptr),
-                    "xrEnumerateSwapchainImages(pointerRay count)", instance_);
+    ThrowIfXrFailed(xrEnumerateSwapchainImages(swapchain, 0, &imageCount, nullptr),
+                    (std::string("xrEnumerateSwapchainImages(") + label + " count)").c_str(), instance_);
     if (imageCount == 0) {
-        throw std::runtime_error("Runtime returned zero pointer-ray swapchain images.");
+        throw std::runtime_error(std::string("Runtime returned zero ") + label + " swapchain images.");
     }
 
-    pointerRayImages_.resize(imageCount, {XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR});
-    ThrowIfXrFailed(
-        xrEnumerateSwapchainImages(pointerRaySwapchain_, imageCount, &imageCount,
-                                   reinterpret_cast<XrSwapchainImageBaseHeader*>(pointerRayImages_.data())),
-        "xrEnumerateSwapchainImages(pointerRay data)", instance_);
+    outImages->assign(imageCount, {XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR});
+    ThrowIfXrFailed(xrEnumerateSwapchainImages(swapchain, imageCount, &imageCount,
+                                               reinterpret_cast<XrSwapchainImageBaseHeader*>(outImages->data())),
+                    (std::string("xrEnumerateSwapchainImages(") + label + " data)").c_str(), instance_);
+    return swapchain;
 }
 
-void FlutterXrApp::CreateFlutterTexture() {
-    D3D11_TEXTURE2D_DESC desc{};
-    desc.Width = static_cast<UINT>(kFlutterSurfaceWidth);
-    desc.Height = static_cast<UINT>(kFlutterSurfaceHeight);
-    desc.MipLevels = 1;
-    desc.ArraySize = 1;
-    desc.Format = colorFormat_;
-    desc.SampleDesc.Count = 1;
-    desc.SampleDesc.Quality = 0;
-    desc.Usage = D3D11_USAGE_DEFAULT;
-    desc.BindFlags = 0;
-    desc.CPUAccessFlags = 0;
-    desc.MiscFlags = 0;
-
-    ThrowIfFailed(device_->CreateTexture2D(&desc, nullptr, flutterTexture_.ReleaseAndGetAddressOf()),
-                  "ID3D11Device::CreateTexture2D(flutterTexture)");
+void FlutterXrApp::WriteSwapchainImage(XrSwapchain swapchain,
+                                       const std::vector<XrSwapchainImageD3D11KHR>& images,
+                                       ID3D11Texture2D* source,
+                                       const char* label) {
+    uint32_t imageIndex = 0;
+    XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
+    ThrowIfXrFailed(xrAcquireSwapchainImage(swapchain, &acquireInfo, &imageIndex),
+                    (std::string("xrAcquireSwapchainImage(") + label + ")").c_str(), instance_);
+
+    XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+    waitInfo.timeout = XR_INFINITE_DURATION;
+    ThrowIfXrFailed(xrWaitSwapchainImage(swapchain, &waitInfo),
+                    (std::string("xrWaitSwapchainImage(") + label + ")").c_str(), instance_);
+
+    deviceContext_->CopyResource(images[imageIndex].texture, source);
+
+    XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
+    ThrowIfXrFailed(xrReleaseSwapchainImage(swapchain, &releaseInfo),
+                    (std::string("xrReleaseSwapchainImage(") + label + ")").c_str(), instance_);
+}
 
-    const std::vector<uint32_t> initialPixels(
-        static_cast<size_t>(kFlutterSurfaceWidth) * static_cast<size_t>(kFlutterSurfaceHeight), 0xFF101010u);
-    deviceContext_->UpdateSubresource(flutterTexture_.Get(), 0, nullptr, initialPixels.data(),
-                                      static_cast<UINT>(kFlutterSurfaceWidth * sizeof(uint32_t)), 0);
+void FlutterXrApp::CreatePointerRaySwapchain() {
+    bool isStatic = false;
+    pointerRaySwapchain_ = CreateImageSwapchain(kPointerRayTextureWidth, kPointerRayTextureHeight, "pointerRay", &isStatic,
+                                                &pointerRayImages_);
+    pointerRayImageWritten_ = false;
 }
 
 void FlutterXrApp::CreatePointerRayTexture() {
@@ -328,6 +468,14 @@ void FlutterXrApp::CreatePointerRayTexture() {
                                       static_cast<UINT>(kPointerRayTextureWidth * sizeof(uint32_t)), 0);
 }
 
+void FlutterXrApp::EnsurePointerRayResources() {
+    if (pointerRaySwapchain_ != XR_NULL_HANDLE && pointerRayTexture_ != nullptr) {
+        return;
+    }
+    CreatePointerRayTexture();
+    CreatePointerRaySwapchain();
+}
+
 void FlutterXrApp::PollEvents() {
     XrEventDataBuffer event{XR_TYPE_EVENT_DATA_BUFFER};
     XrResult pollResult = xrPollEvent(instance_, &event);
@@ -342,6 +490,9 @@ void FlutterXrApp::PollEvents() {
                 HandleSessionStateChanged(*changed);
                 break;
             }
+            case XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED:
+                UpdatePointerFilterTuning();
+                break;
             default:
                 break;
         }
@@ -363,31 +514,37 @@ void FlutterXrApp::HandleSessionStateChanged(const XrEventDataSessionStateChange
             beginInfo.primaryViewConfigurationType = viewConfigType_;
             ThrowIfXrFailed(xrBeginSession(session_, &beginInfo), "xrBeginSession", instance_);
             sessionRunning_ = true;
+            SetXrVsyncActive(true);
+            StartFrameWaitThread();
             std::cout << "Session started.\n";
             break;
         }
         case XR_SESSION_STATE_STOPPING:
             if (pointerDown_) {
-                SendFlutterPointerEvent(kUp, lastPointerX_, lastPointerY_, 0);
+                SendFlutterPointerEvent(kUp, pointerEvents_.LastX(), pointerEvents_.LastY(), 0);
                 pointerDown_ = false;
             }
             triggerPressed_ = false;
             pointerRayVisible_ = false;
             leftPointerRayVisible_ = false;
             sessionRunning_ = false;
+            StopFrameWaitThread();
+            SetXrVsyncActive(false);
             ThrowIfXrFailed(xrEndSession(session_), "xrEndSession", instance_);
             std::cout << "Session stopping.\n";
             break;
         case XR_SESSION_STATE_EXITING:
         case XR_SESSION_STATE_LOSS_PENDING:
             if (pointerDown_) {
-                SendFlutterPointerEvent(kUp, lastPointerX_, lastPointerY_, 0);
+                SendFlutterPointerEvent(kUp, pointerEvents_.LastX(), pointerEvents_.LastY(), 0);
                 pointerDown_ = false;
             }
             triggerPressed_ = false;
             pointerRayVisible_ = false;
             leftPointerRayVisible_ = false;
             sessionRunning_ = false;
+            StopFrameWaitThread();
+            SetXrVsyncActive(false);
             exitRequested_ = true;
             break;
         default:
@@ -395,44 +552,82 @@ void FlutterXrApp::HandleSessionStateChanged(const XrEventDataSessionStateChange
     }
 }
 
-void FlutterXrApp::RenderFrame() {
+XrFrameState FlutterXrApp::WaitFrame() {
     XrFrameWaitInfo frameWaitInfo{XR_TYPE_FRAME_WAIT_INFO};
     XrFrameState frameState{XR_TYPE_FRAME_STATE};
     ThrowIfXrFailed(xrWaitFrame(session_, &frameWaitInfo, &frameState), "xrWaitFrame", instance_);
+    UpdateXrClockEstimate(frameState);
+    PaceFlutterVsync(frameState);
+    return frameState;
+}
 
+void FlutterXrApp::StartFrameWaitThread() {
+    if (config_.framePipelineDepth > 1 && !frameWaitThread_.IsRunning()) {
+        frameWaitThread_.Start([this]() { return WaitFrame(); });
+    }
+}
+
+void FlutterXrApp::StopFrameWaitThread() {
+    if (frameWaitThread_.IsRunning()) {
+        frameWaitThread_.Stop([this](const XrFrameState& frameState) { SubmitEmptyFrame(frameState); });
+    }
+}
+
+void FlutterXrApp::SubmitEmptyFrame(const XrFrameState& frameState) {
+    // Only releases the wait thread during teardown, so failures are logged
+    // rather than thrown.
+    XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
+    const XrResult beginResult = xrBeginFrame(session_, &frameBeginInfo);
+    if (XR_FAILED(beginResult)) {
+        std::cerr << "[warn] xrBeginFrame(discard) failed: " << XrResultToString(instance_, beginResult) << "\n";
+        return;
+    }
+
+    XrFrameEndInfo frameEndInfo{XR_TYPE_FRAME_END_INFO};
+    frameEndInfo.displayTime = frameState.predictedDisplayTime;
+    frameEndInfo.environmentBlendMode = blendMode_;
+    const XrResult endResult = xrEndFrame(session_, &frameEndInfo);
+    if (XR_FAILED(endResult)) {
+        std::cerr << "[warn] xrEndFrame(discard) failed: " << XrResultToString(instance_, endResult) << "\n";
+    }
+}
+
+void FlutterXrApp::RenderFrame(const XrFrameState& frameState) {
+    platformTasks_.SetRenderCritical(true);
     PollInput(frameState.predictedDisplayTime);
 
     XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
     ThrowIfXrFailed(xrBeginFrame(session_, &frameBeginInfo), "xrBeginFrame", instance_);
 
     XrCompositionLayerQuad backgroundLayer{XR_TYPE_COMPOSITION_LAYER_QUAD};
-    XrCompositionLayerQuad quadLayer{XR_TYPE_COMPOSITION_LAYER_QUAD};
+    std::array<XrCompositionLayerQuad, kMaxFlutterViews> viewLayers{};
+    for (XrCompositionLayerQuad& viewLayer : viewLayers) {
+        viewLayer = XrCompositionLayerQuad{XR_TYPE_COMPOSITION_LAYER_QUAD};
+    }
     std::array<XrCompositionLayerQuad, kMaxPointerRayLayerCount> pointerRayLayers{};
     for (XrCompositionLayerQuad& pointerRayLayer : pointerRayLayers) {
         pointerRayLayer = XrCompositionLayerQuad{XR_TYPE_COMPOSITION_LAYER_QUAD};
     }
-    std::array<XrCompositionLayerBaseHeader*, 2 + kMaxPointerRayLayerCount> layers{};
+    std::array<XrCompositionLayerBaseHeader*, kMaxNonRayLayerCount + kMaxPointerRayLayerCount> layers{};
     uint32_t layerCount = 0;
 
     if (frameState.shouldRender == XR_TRUE) {
-        if (IsBackgroundEnabled() && backgroundSwapchain_ != XR_NULL_HANDLE && backgroundTexture_ != nullptr) {
-            uint32_t imageIndex = 0;
-            XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
-            ThrowIfXrFailed(xrAcquireSwapchainImage(backgroundSwapchain_, &acquireInfo, &imageIndex),
-                            "xrAcquireSwapchainImage(background)", instance_);
-
-            XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
-            waitInfo.timeout = XR_INFINITE_DURATION;
-            ThrowIfXrFailed(xrWaitSwapchainImage(backgroundSwapchain_, &waitInfo), "xrWaitSwapchainImage(background)",
-                            instance_);
-
+        UpdateFlutterSurfaceScale(frameState);
+
+        // The panels upload first; background bands use what is left of the
+        // frame's upload budget.
+        size_t flutterBytesUploaded = preparedFlutterBytes_;
+        UploadLatestFlutterFrames(&flutterBytesUploaded);
+        preparedFlutterBytes_ = 0;
+        textureUploads_.BeginFrame(flutterBytesUploaded);
+
+        const bool backgroundEnabled = IsBackgroundEnabled();
+        if (backgroundEnabled) {
+            EnsureBackgroundResources();
             UploadBackgroundTexture();
-            deviceContext_->CopyResource(backgroundImages_[imageIndex].texture, backgroundTexture_.Get());
-
-            XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
-            ThrowIfXrFailed(xrReleaseSwapchainImage(backgroundSwapchain_, &releaseInfo), "xrReleaseSwapchainImage(background)",
-                            instance_);
-
+            WriteBackgroundSwapchainIfStale();
+        }
+        if (backgroundEnabled && backgroundImageWritten_) {
             backgroundLayer.space = appSpace_;
             backgroundLayer.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
             backgroundLayer.subImage.swapchain = backgroundSwapchain_;
@@ -445,92 +640,133 @@ void FlutterXrApp::RenderFrame() {
             layers[layerCount++] = reinterpret_cast<XrCompositionLayerBaseHeader*>(&backgroundLayer);
         }
 
-        {
-            uint32_t imageIndex = 0;
-            XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
-            ThrowIfXrFailed(xrAcquireSwapchainImage(quadSwapchain_, &acquireInfo, &imageIndex), "xrAcquireSwapchainImage",
-                            instance_);
-
-            XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
-            waitInfo.timeout = XR_INFINITE_DURATION;
-            ThrowIfXrFailed(xrWaitSwapchainImage(quadSwapchain_, &waitInfo), "xrWaitSwapchainImage", instance_);
-
-            UploadLatestFlutterFrame();
-            deviceContext_->CopyResource(quadImages_[imageIndex].texture, flutterTexture_.Get());
+        // A layer without a newly released image shows the swapchain's last
+        // released one, so a view without new content costs no acquire or
+        // copy, only its layer.
+        for (size_t i = 0; i < flutterViews_.size(); ++i) {
+            FlutterViewPanel& view = *flutterViews_[i];
+            if (!view.engineViewAdded.load(std::memory_order_acquire)) {
+                continue;
+            }
 
-            XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
-            ThrowIfXrFailed(xrReleaseSwapchainImage(quadSwapchain_, &releaseInfo), "xrReleaseSwapchainImage", instance_);
+            FlutterSurfaceTarget& surface = *view.activeSurface;
+            if (view.textureChanged || !surface.imageReleased || !config_.elideIdleFrames) {
+                WriteSwapchainImage(surface.swapchain, surface.images, surface.texture.Get(), "quad");
+                surface.imageReleased = true;
+                ++quadFramesCopied_;
+            } else {
+                ++quadFramesElided_;
+            }
+            view.textureChanged = false;
+
+            // The panel keeps its physical size at every surface resolution;
+            // only the pixel density of the submitted image changes. With
+            // cropping, only the content bounds are submitted, on a matching
+            // sub-quad.
+            XrRect2Di imageRect{{0, 0}, {static_cast<int32_t>(surface.width), static_cast<int32_t>(surface.height)}};
+            if (config_.cropToContent) {
+                imageRect.offset = {static_cast<int32_t>(view.contentBounds.x), static_cast<int32_t>(view.contentBounds.y)};
+                imageRect.extent = {static_cast<int32_t>(view.contentBounds.width),
+                                    static_cast<int32_t>(view.contentBounds.height)};
+            }
+            view.panelVisible = !config_.cropToContent || view.contentVisible;
+            view.geometry = MakePanelGeometry(view.basePose, static_cast<int32_t>(surface.width),
+                                              static_cast<int32_t>(surface.height), imageRect);
+
+            if (view.panelVisible) {
+                XrCompositionLayerQuad& viewLayer = viewLayers[i];
+                viewLayer.space = appSpace_;
+                viewLayer.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+                viewLayer.subImage.swapchain = surface.swapchain;
+                viewLayer.subImage.imageRect = view.geometry.imageRect;
+                viewLayer.subImage.imageArrayIndex = 0;
+                viewLayer.pose = view.geometry.pose;
+                viewLayer.size = view.geometry.size;
+
+                layers[layerCount++] = reinterpret_cast<XrCompositionLayerBaseHeader*>(&viewLayer);
+            }
         }
+        UpdateFlutterPanelHitTester();
 
-        quadLayer.space = appSpace_;
-        quadLayer.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
-        quadLayer.subImage.swapchain = quadSwapchain_;
-        quadLayer.subImage.imageRect.offset = {0, 0};
-        quadLayer.subImage.imageRect.extent = {kFlutterSurfaceWidth, kFlutterSurfaceHeight};
-        quadLayer.subImage.imageArrayIndex = 0;
-        quadLayer.pose = MakeQuadPose();
-        quadLayer.size = {kQuadWidthMeters, kQuadHeightMeters};
-
-        layers[layerCount++] = reinterpret_cast<XrCompositionLayerBaseHeader*>(&quadLayer);
-
-        const bool hasAnyPointerRay =
-            (pointerRayVisible_ || leftPointerRayVisible_) && pointerRaySwapchain_ != XR_NULL_HANDLE &&
-            pointerRayTexture_ != nullptr;
+        // Everything above (uploads, swapchain waits) delays the frame, so the
+        // rays are re-located now to track the controllers at display time.
+        LateLatchPointerRays(frameState.predictedDisplayTime);
+        const bool hasAnyPointerRay = pointerRayVisible_ || leftPointerRayVisible_;
         if (hasAnyPointerRay) {
-            uint32_t rayImageIndex = 0;
-            XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
-            ThrowIfXrFailed(xrAcquireSwapchainImage(pointerRaySwapchain_, &acquireInfo, &rayImageIndex),
-                            "xrAcquireSwapchainImage(pointerRay)", instance_);
-
-            XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
-            waitInfo.timeout = XR_INFINITE_DURATION;
-            ThrowIfXrFailed(xrWaitSwapchainImage(pointerRaySwapchain_, &waitInfo), "xrWaitSwapchainImage(pointerRay)",
-                            instance_);
-
-            deviceContext_->CopyResource(pointerRayImages_[rayImageIndex].texture, pointerRayTexture_.Get());
+            EnsurePointerRayResources();
+            // The ray texture never changes; layers keep referencing the one
+            // released image.
+            if (!pointerRayImageWritten_) {
+                WriteSwapchainImage(pointerRaySwapchain_, pointerRayImages_, pointerRayTexture_.Get(), "pointerRay");
+                pointerRayImageWritten_ = true;
+            }
 
-            XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
-            ThrowIfXrFailed(xrReleaseSwapchainImage(pointerRaySwapchain_, &releaseInfo), "xrReleaseSwapchainImage(pointerRay)",
-                            instance_);
+            // Billboards need this frame's eye positions; cylinders fall back
+            // to fewer segments when the budget is tight.
+            std::array<XrVector3f, kMaxEyeCount> eyePositions{};
+            const uint32_t eyeCount = config_.pointerRayMode == PointerRayMode::Cylinder
+                                          ? 0
+                                          : LocateEyePositions(frameState.predictedDisplayTime, &eyePositions);
+            const uint32_t visibleRayCount = (pointerRayVisible_ ? 1U : 0U) + (leftPointerRayVisible_ ? 1U : 0U);
+            const PointerRayLayerPlan rayPlan = PlanPointerRayLayers(config_.pointerRayMode, config_.pointerRaySegments,
+                                                                     visibleRayCount, pointerRayLayerBudget_, eyeCount);
+            if (rayPlan.mode != pointerRayPlan_.mode || rayPlan.layersPerRay != pointerRayPlan_.layersPerRay) {
+                std::cout << "Pointer rays: " << PointerRayModeName(rayPlan.mode) << " with " << rayPlan.layersPerRay
+                          << " layer(s) per ray\n";
+            }
+            pointerRayPlan_ = rayPlan;
 
             uint32_t pointerRayLayerCount = 0;
-            const float pointerRaySegmentWidthMeters = ComputePointerRaySegmentWidthMeters();
-            const float segmentStepRadians = (2.0f * kPi) / static_cast<float>(kPointerRayCylinderSegmentCount);
-            auto appendPointerRayCylinder = [&](const XrPosef& pose, float lengthMeters) {
-                if (lengthMeters <= 0.0f || pointerRaySegmentWidthMeters <= 0.0f) {
+            auto appendPointerRayLayer = [&](const XrPosef& pose, float lengthMeters, float widthMeters,
+                                             XrEyeVisibility eyeVisibility) {
+                if (pointerRayLayerCount >= pointerRayLayers.size() || layerCount >= layers.size()) {
                     return;
                 }
 
-                for (uint32_t segmentIndex = 0; segmentIndex < kPointerRayCylinderSegmentCount; ++segmentIndex) {
-                    if (pointerRayLayerCount >= pointerRayLayers.size() || layerCount >= layers.size()) {
-                        return;
+                XrCompositionLayerQuad& pointerRayLayer = pointerRayLayers[pointerRayLayerCount++];
+                pointerRayLayer.space = appSpace_;
+                pointerRayLayer.eyeVisibility = eyeVisibility;
+                pointerRayLayer.subImage.swapchain = pointerRaySwapchain_;
+                pointerRayLayer.subImage.imageRect.offset = {0, 0};
+                pointerRayLayer.subImage.imageRect.extent = {kPointerRayTextureWidth, kPointerRayTextureHeight};
+                pointerRayLayer.subImage.imageArrayIndex = 0;
+                pointerRayLayer.pose = pose;
+                pointerRayLayer.size = {lengthMeters, widthMeters};
+                layers[layerCount++] = reinterpret_cast<XrCompositionLayerBaseHeader*>(&pointerRayLayer);
+            };
+
+            std::array<XrPosef, kMaxPointerRaySegments> segmentWorldPoses{};
+            uint32_t raysDrawn = 0;
+            auto appendPointerRay = [&](const XrPosef& pose, float lengthMeters) {
+                if (lengthMeters <= 0.0f || raysDrawn >= rayPlan.rayCount) {
+                    return;
+                }
+                ++raysDrawn;
+
+                if (rayPlan.mode == PointerRayMode::Billboard) {
+                    for (uint32_t eye = 0; eye < eyeCount; ++eye) {
+                        const XrEyeVisibility eyeVisibility = eyeCount == 1 ? XR_EYE_VISIBILITY_BOTH
+                                                              : eye == 0        ? XR_EYE_VISIBILITY_LEFT
+                                                                                : XR_EYE_VISIBILITY_RIGHT;
+                        appendPointerRayLayer(MakeBillboardRayPose(pose, eyePositions[eye]), lengthMeters,
+                                              kPointerRayCylinderDiameterMeters, eyeVisibility);
                     }
+                    return;
+                }
 
-                    const float angleRadians = segmentStepRadians * static_cast<float>(segmentIndex);
-                    const XrQuaternionf segmentRotation = MakeXAxisRotation(angleRadians);
-                    XrCompositionLayerQuad& pointerRayLayer = pointerRayLayers[pointerRayLayerCount++];
-
-                    pointerRayLayer.space = appSpace_;
-                    pointerRayLayer.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
-                    pointerRayLayer.subImage.swapchain = pointerRaySwapchain_;
-                    pointerRayLayer.subImage.imageRect.offset = {0, 0};
-                    pointerRayLayer.subImage.imageRect.extent = {kPointerRayTextureWidth, kPointerRayTextureHeight};
-                    pointerRayLayer.subImage.imageArrayIndex = 0;
-                    pointerRayLayer.pose.orientation = Multiply(pose.orientation, segmentRotation);
-
-                    const XrVector3f radialOffsetLocal =
-                        RotateVector(segmentRotation, XrVector3f{0.0f, 0.0f, kPointerRayCylinderDiameterMeters * 0.5f});
-                    pointerRayLayer.pose.position = Add(pose.position, RotateVector(pose.orientation, radialOffsetLocal));
-                    pointerRayLayer.size = {lengthMeters, pointerRaySegmentWidthMeters};
-                    layers[layerCount++] = reinterpret_cast<XrCompositionLayerBaseHeader*>(&pointerRayLayer);
+                const uint32_t segmentCount = rayPlan.layersPerRay;
+                ComposePoses(pose, PointerRaySegmentPoses(segmentCount), segmentWorldPoses.data(), segmentCount);
+                for (uint32_t segment = 0; segment < segmentCount; ++segment) {
+                    appendPointerRayLayer(segmentWorldPoses[segment], lengthMeters,
+                                          PointerRaySegmentWidthMeters(segmentCount), XR_EYE_VISIBILITY_BOTH);
                 }
             };
 
             if (pointerRayVisible_) {
-                appendPointerRayCylinder(pointerRayPose_, pointerRayLengthMeters_);
+                appendPointerRay(pointerRayPose_, pointerRayLengthMeters_);
             }
             if (leftPointerRayVisible_) {
-                appendPointerRayCylinder(leftPointerRayPose_, leftPointerRayLengthMeters_);
+                appendPointerRay(leftPointerRayPose_, leftPointerRayLengthMeters_);
             }
         }
 
@@ -543,31 +779,50 @@ void FlutterXrApp::RenderFrame() {
     frameEndInfo.layerCount = layerCount;
     frameEndInfo.layers = (layerCount > 0) ? layers.data() : nullptr;
     ThrowIfXrFailed(xrEndFrame(session_, &frameEndInfo), "xrEndFrame", instance_);
+    platformTasks_.SetRenderCritical(false);
+
+    if (layerCount > 0 && !firstFrameSubmittedLogged_) {
+        LogStartupPhase(firstFlutterFrameLogged_ ? "first frame submitted" : "first frame submitted (placeholder panel)");
+        firstFrameSubmittedLogged_ = true;
+    }
 }
 
 void FlutterXrApp::Shutdown() {
-    if (flutterEngine_ != nullptr && pointerAdded_) {
-        SendFlutterPointerEvent(kRemove, lastPointerX_, lastPointerY_, 0);
-        pointerAdded_ = false;
+    StopFrameWaitThread();
+
+    if (quadFramesCopied_ + quadFramesElided_ > 0) {
+        std::cout << "Flutter quad frames: copied=" << quadFramesCopied_ << " elided=" << quadFramesElided_ << "\n";
+        quadFramesCopied_ = 0;
+        quadFramesElided_ = 0;
     }
 
-    if (flutterEngine_ != nullptr) {
-        const FlutterEngineResult shutdownResult = FlutterEngineShutdown(flutterEngine_);
-        if (shutdownResult != kSuccess) {
-            std::cerr << "[warn] FlutterEngineShutdown failed. result=" << static_cast<int32_t>(shutdownResult) << "\n";
-        }
-        flutterEngine_ = nullptr;
+    if (PointerEngineReachable() && pointerAdded_) {
+        SendFlutterPointerEvent(kRemove, pointerEvents_.LastX(), pointerEvents_.LastY(), 0);
+        pointerAdded_ = false;
     }
 
-    if (flutterBridge_.firstFrameEvent != nullptr) {
-        CloseHandle(flutterBridge_.firstFrameEvent);
-        flutterBridge_.firstFrameEvent = nullptr;
+    if (engineProcess_ != nullptr) {
+        engineProcess_->Stop();
+        LogFlutterEngineStats();
+        engineProcess_.reset();
     }
 
-    if (quadSwapchain_ != XR_NULL_HANDLE) {
-        xrDestroySwapchain(quadSwapchain_);
-        quadSwapchain_ = XR_NULL_HANDLE;
+    const bool anyEngineRunning = std::any_of(flutterEngines_.begin(), flutterEngines_.end(),
+                                              [](const auto& host) { return host->engine != nullptr; });
+    if (anyEngineRunning) {
+        ShutdownFlutterEngines();
+        LogFlutterEngineStats();
+
+        const PlatformTaskRunner::Stats taskStats = platformTasks_.GetStats();
+        std::cout << "Flutter platform tasks: run=" << taskStats.tasksRun << " maxQueueDepth=" << taskStats.maxQueueDepth
+                  << " latency mean=" << taskStats.meanLatencyMs << " ms max=" << taskStats.maxLatencyMs << " ms\n";
     }
+    platformTasks_.Stop();
+
+    // The engine reads the AOT snapshot until it has shut down.
+    flutterBundle_.Unload();
+
+    DestroyFlutterSurfaceTargets();
 
     if (backgroundSwapchain_ != XR_NULL_HANDLE) {
         xrDestroySwapchain(backgroundSwapchain_);
@@ -589,6 +844,11 @@ void FlutterXrApp::Shutdown() {
         leftPointerSpace_ = XR_NULL_HANDLE;
     }
 
+    if (viewSpace_ != XR_NULL_HANDLE) {
+        xrDestroySpace(viewSpace_);
+        viewSpace_ = XR_NULL_HANDLE;
+    }
+
     if (appSpace_ != XR_NULL_HANDLE) {
         xrDestroySpace(appSpace_);
         appSpace_ = XR_NULL_HANDLE;
@@ -628,15 +888,13 @@ void FlutterXrApp::Shutdown() {
         instance_ = XR_NULL_HANDLE;
     }
 
+    textureUploads_.Clear();
     deviceContext_.Reset();
     device_.Reset();
-    flutterTexture_.Reset();
     backgroundTexture_.Reset();
     pointerRayTexture_.Reset();
-    quadImages_.clear();
     backgroundImages_.clear();
     pointerRayImages_.clear();
-    convertedPixels_.clear();
     backgroundCustomPixels_.clear();
 }
 
@@ -2,131 +2,456 @@
 
 #include <algorithm>
 #include <cstring>
-#include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 namespace flutter_xr {
 
 namespace {
 
 constexpr const char* kBackgroundChannel = "flutter_open_xr/background";
+constexpr size_t kMinRowsPerStripe = 16;
+constexpr uint64_t kFallbackVsyncPeriodNanos = 1000000000ull / 60;
+constexpr double kDisplayLatencySmoothing = 0.1;
+
+void CopyRowsParallel(WorkerPool& pool, uint8_t* destination, const void* source, size_t rowBytes, size_t height) {
+    const auto* sourceBytes = static_cast<const uint8_t*>(source);
+    pool.ParallelForRows(height, kMinRowsPerStripe, [&](size_t rowBegin, size_t rowEnd) {
+        std::memcpy(destination + rowBegin * rowBytes, sourceBytes + rowBegin * rowBytes, (rowEnd - rowBegin) * rowBytes);
+    });
+}
 
 bool OnSurfacePresent(void* user_data, const void* allocation, size_t row_bytes, size_t height) {
-    auto* app = static_cast<FlutterXrApp*>(user_data);
-    if (app == nullptr) {
+    auto* host = static_cast<FlutterEngineHost*>(user_data);
+    if (host == nullptr) {
         return false;
     }
-    return app->HandleFlutterSurfacePresent(allocation, row_bytes, height);
+    return host->app->HandleFlutterSurfacePresent(*host, allocation, row_bytes, height);
 }
 
-void OnPlatformMessage(const FlutterPlatformMessage* message, void* user_data) {
-    auto* app = static_cast<FlutterXrApp*>(user_data);
-    if (app == nullptr) {
+bool OnCreateBackingStore(const FlutterBackingStoreConfig* config, FlutterBackingStore* backing_store_out, void* user_data) {
+    auto* host = static_cast<FlutterEngineHost*>(user_data);
+    if (host == nullptr) {
+        return false;
+    }
+    return host->app->HandleFlutterCreateBackingStore(*host, config, backing_store_out);
+}
+
+bool OnCollectBackingStore(const FlutterBackingStore* backing_store, void* user_data) {
+    auto* host = static_cast<FlutterEngineHost*>(user_data);
+    if (host == nullptr) {
+        return false;
+    }
+    return host->app->HandleFlutterCollectBackingStore(*host, backing_store);
+}
+
+bool OnPresentView(const FlutterPresentViewInfo* info) {
+    auto* host = info != nullptr ? static_cast<FlutterEngineHost*>(info->user_data) : nullptr;
+    if (host == nullptr) {
+        return false;
+    }
+    return host->app->HandleFlutterPresentView(*host, info->view_id, info->layers, info->layers_count);
+}
+
+void OnViewAdded(const FlutterAddViewResult* result) {
+    auto* view = result != nullptr ? static_cast<FlutterViewPanel*>(result->user_data) : nullptr;
+    if (view == nullptr) {
+        return;
+    }
+    if (!result->added) {
+        std::cerr << "[warn] Flutter engine " << view->engine << " did not add view " << view->viewId
+                  << "; its panel stays hidden.\n";
         return;
     }
-    app->HandleFlutterPlatformMessage(message);
+    view->engineViewAdded.store(true, std::memory_order_release);
 }
 
-}  // namespace
+void ReleaseHeapBackingStore(void* user_data) {
+    delete[] static_cast<uint8_t*>(user_data);
+}
 
-void FlutterXrApp::InitializeFlutterEngine() {
-    const auto exeDir = GetExecutableDir();
-    const auto assetsDir = exeDir / "data" / "flutter_assets";
-    const auto kernelBlob = assetsDir / "kernel_blob.bin";
-    const auto icuPath = exeDir / "icudtl.dat";
+void ReleasePooledBackingStore(void* /*user_data*/) {}
 
-    if (!std::filesystem::exists(kernelBlob)) {
-        throw std::runtime_error("Missing Flutter assets: " + kernelBlob.string());
+void OnVsync(void* user_data, intptr_t baton) {
+    auto* host = static_cast<FlutterEngineHost*>(user_data);
+    if (host == nullptr) {
+        return;
     }
+    host->app->HandleFlutterVsync(*host, baton);
+}
 
-    assetsPathUtf8_ = WideToUtf8(assetsDir.wstring());
-    if (std::filesystem::exists(icuPath)) {
-        icuPathUtf8_ = WideToUtf8(icuPath.wstring());
-    } else {
-        std::cout << "[warn] icudtl.dat not found next to executable. Trying without explicit ICU path.\n";
+void OnPlatformMessage(const FlutterPlatformMessage* message, void* user_data) {
+    auto* host = static_cast<FlutterEngineHost*>(user_data);
+    if (host == nullptr) {
+        return;
     }
+    host->app->HandleFlutterPlatformMessage(*host, message);
+}
 
-    flutterBridge_.firstFrameEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
-    if (flutterBridge_.firstFrameEvent == nullptr) {
-        throw std::runtime_error("CreateEventW(firstFrameEvent) failed.");
+void UpdateMax(std::atomic<uint64_t>& maximum, uint64_t value) {
+    uint64_t current = maximum.load(std::memory_order_relaxed);
+    while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+}  // namespace
+
+void FlutterXrApp::InitializeFlutterEngines() {
+    flutterBundle_.Load();
+
+    // The AOT data and ICU path are shared; each engine maps its own
+    // snapshot view of them and gets its own isolate group.
+    for (const auto& host : flutterEngines_) {
+        RunFlutterEngine(*host);
     }
 
+    // The first frames are not awaited; until they arrive the panels show
+    // the placeholder the surface textures were created with.
+}
+
+void FlutterXrApp::StartEngineProcess() {
+    FlutterEngineHost& host = *flutterEngines_.front();
+    const std::string childArguments = "--engines=" + host.entrypoint +
+                                       " --flutter-compositor=" + (config_.useFlutterCompositor ? "on" : "off");
+    engineProcess_ = std::make_unique<EngineProcess>(childArguments, SurfaceScaleController::MaxFrameBytes());
+    engineProcess_->Start([this](const std::string& channel, const std::string& message) {
+        return channel == kBackgroundChannel ? HandleBackgroundMessage(message) : std::string();
+    });
+    LogStartupPhase("flutter engine process started");
+
+    // Metrics are queued until the child's engine is up, and replayed if it
+    // is restarted.
+    FlutterViewPanel& implicitView = *FindFlutterView(host.index, kFlutterViewId);
+    implicitView.engineViewAdded.store(true, std::memory_order_release);
+    const size_t level = implicitView.surfaceScale.Level();
+    SendFlutterWindowMetrics(implicitView, SurfaceScaleController::ScaledWidth(level),
+                             SurfaceScaleController::ScaledHeight(level),
+                             static_cast<double>(implicitView.surfaceScale.Scale()));
+}
+
+void FlutterXrApp::RunFlutterEngine(FlutterEngineHost& host) {
     FlutterRendererConfig rendererConfig{};
     rendererConfig.type = kSoftware;
     rendererConfig.software.struct_size = sizeof(FlutterSoftwareRendererConfig);
     rendererConfig.software.surface_present_callback = OnSurfacePresent;
 
+    FlutterCompositor compositor{};
+    compositor.struct_size = sizeof(FlutterCompositor);
+    compositor.user_data = &host;
+    compositor.create_backing_store_callback = OnCreateBackingStore;
+    compositor.collect_backing_store_callback = OnCollectBackingStore;
+    compositor.present_view_callback = OnPresentView;
+    // Ask for a fresh backing store every frame so each one maps onto the
+    // mailbox slot the producer currently owns.
+    compositor.avoid_backing_store_cache = true;
+
     const char* commandLineArgs[] = {"flutter_open_xr_runner", "--enable-impeller=false"};
     FlutterProjectArgs projectArgs{};
     projectArgs.struct_size = sizeof(FlutterProjectArgs);
-    projectArgs.assets_path = assetsPathUtf8_.c_str();
-    projectArgs.icu_data_path = icuPathUtf8_.empty() ? nullptr : icuPathUtf8_.c_str();
+    projectArgs.assets_path = flutterBundle_.AssetsPath();
+    projectArgs.icu_data_path = flutterBundle_.IcuPath();
     projectArgs.command_line_argc = static_cast<int>(std::size(commandLineArgs));
     projectArgs.command_line_argv = commandLineArgs;
     projectArgs.platform_message_callback = OnPlatformMessage;
+    projectArgs.compositor = config_.useFlutterCompositor ? &compositor : nullptr;
+    projectArgs.vsync_callback = config_.useFlutterVsync ? OnVsync : nullptr;
+    projectArgs.aot_data = flutterBundle_.AotData();
+    projectArgs.custom_dart_entrypoint = host.entrypoint == "main" ? nullptr : host.entrypoint.c_str();
+
+    // Platform tasks, including platform messages and the decoding they
+    // trigger, run on the runner-owned platform thread shared by all
+    // engines, and each engine is started from that thread.
+    FlutterCustomTaskRunners customTaskRunners{};
+    customTaskRunners.struct_size = sizeof(FlutterCustomTaskRunners);
+    customTaskRunners.platform_task_runner = platformTasks_.Description(host.index);
+    projectArgs.custom_task_runners = &customTaskRunners;
+
+    FlutterEngineResult runResult = kSuccess;
+    platformTasks_.RunSync([&]() {
+        runResult = FlutterEngineRun(FLUTTER_ENGINE_VERSION, &rendererConfig, &projectArgs, &host, &host.engine);
+    });
+    if (runResult != kSuccess || host.engine == nullptr) {
+        throw std::runtime_error("FlutterEngineRun failed. entrypoint=" + host.entrypoint +
+                                 " result=" + std::to_string(static_cast<int32_t>(runResult)));
+    }
+    platformTasks_.SetEngine(host.index, host.engine);
+
+    const std::string phase = "flutter engine " + std::to_string(host.index) + " (" + host.entrypoint + ") running";
+    LogStartupPhase(phase.c_str());
+
+    // The panel swapchain may still be in creation, so size the view from
+    // the scale level it will be created at.
+    FlutterViewPanel& implicitView = *FindFlutterView(host.index, kFlutterViewId);
+    implicitView.engineViewAdded.store(true, std::memory_order_release);
+    const size_t level = implicitView.surfaceScale.Level();
+    SendFlutterWindowMetrics(implicitView, SurfaceScaleController::ScaledWidth(level),
+                             SurfaceScaleController::ScaledHeight(level),
+                             static_cast<double>(implicitView.surfaceScale.Scale()));
+    AddFlutterViews(host);
+}
 
-    const FlutterEngineResult runResult =
-        FlutterEngineRun(FLUTTER_ENGINE_VERSION, &rendererConfig, &projectArgs, this, &flutterEngine_);
-    if (runResult != kSuccess || flutterEngine_ == nullptr) {
-        throw std::runtime_error("FlutterEngineRun failed. result=" + std::to_string(static_cast<int32_t>(runResult)));
-    }
-
-    FlutterWindowMetricsEvent metrics{};
-    metrics.struct_size = sizeof(metrics);
-    metrics.width = kFlutterSurfaceWidth;
-    metrics.height = kFlutterSurfaceHeight;
-    metrics.pixel_ratio = 1.0;
-    metrics.view_id = kFlutterViewId;
-    const FlutterEngineResult metricsResult = FlutterEngineSendWindowMetricsEvent(flutterEngine_, &metrics);
-    if (metricsResult != kSuccess) {
-        throw std::runtime_error("FlutterEngineSendWindowMetricsEvent failed. result=" +
-                                 std::to_string(static_cast<int32_t>(metricsResult)));
-    }
-
-    std::cout << "Waiting for first Flutter frame (timeout " << kFirstFrameTimeoutMs << " ms)...\n";
-    const DWORD waitResult = WaitForSingleObject(flutterBridge_.firstFrameEvent, kFirstFrameTimeoutMs);
-    if (waitResult == WAIT_OBJECT_0) {
-        std::lock_guard<std::mutex> lock(flutterBridge_.latestFrame.mutex);
-        std::cout << "Flutter first frame received: " << flutterBridge_.latestFrame.width << "x"
-                  << flutterBridge_.latestFrame.height << " frameIndex=" << flutterBridge_.latestFrame.frameIndex << "\n";
-    } else if (waitResult == WAIT_TIMEOUT) {
-        std::cout << "[warn] Timed out waiting for the first Flutter frame. Continuing.\n";
-    } else {
-        throw std::runtime_error("WaitForSingleObject(firstFrameEvent) failed.");
+void FlutterXrApp::AddFlutterViews(FlutterEngineHost& host) {
+    // Every view after the implicit one is added with the metrics of its
+    // initial scale level. The engine confirms asynchronously; until then the
+    // panel is neither drawn nor hit-tested.
+    for (const auto& panel : flutterViews_) {
+        FlutterViewPanel& view = *panel;
+        if (view.engine != host.index || view.viewId == kFlutterViewId) {
+            continue;
+        }
+        const size_t level = view.surfaceScale.Level();
+        FlutterWindowMetricsEvent metrics{};
+        metrics.struct_size = sizeof(metrics);
+        metrics.width = SurfaceScaleController::ScaledWidth(level);
+        metrics.height = SurfaceScaleController::ScaledHeight(level);
+        metrics.pixel_ratio = static_cast<double>(view.surfaceScale.Scale());
+        metrics.view_id = view.viewId;
+        view.metricsWidth = static_cast<uint32_t>(metrics.width);
+        view.metricsHeight = static_cast<uint32_t>(metrics.height);
+        view.pixelRatio = metrics.pixel_ratio;
+
+        FlutterAddViewInfo addInfo{};
+        addInfo.struct_size = sizeof(addInfo);
+        addInfo.view_id = view.viewId;
+        addInfo.view_metrics = &metrics;
+        addInfo.user_data = &view;
+        addInfo.add_view_callback = OnViewAdded;
+
+        FlutterEngineResult addResult = kSuccess;
+        platformTasks_.RunSync([&]() { addResult = FlutterEngineAddView(host.engine, &addInfo); });
+        if (addResult != kSuccess) {
+            throw std::runtime_error("FlutterEngineAddView failed. view=" + std::to_string(view.viewId) +
+                                     " result=" + std::to_string(static_cast<int32_t>(addResult)));
+        }
+    }
+}
+
+void FlutterXrApp::ShutdownFlutterEngines() {
+    for (const auto& host : flutterEngines_) {
+        if (host->engine == nullptr) {
+            continue;
+        }
+        platformTasks_.RunSync([&]() {
+            const FlutterEngineResult shutdownResult = FlutterEngineShutdown(host->engine);
+            if (shutdownResult != kSuccess) {
+                std::cerr << "[warn] FlutterEngineShutdown failed. engine=" << host->index
+                          << " result=" << static_cast<int32_t>(shutdownResult) << "\n";
+            }
+            // Cleared here so pointer and metrics work posted after it sees
+            // the engine is gone.
+            host->engine = nullptr;
+        });
+        platformTasks_.SetEngine(host->index, nullptr);
+    }
+}
+
+void FlutterXrApp::LogFlutterEngineStats() const {
+    for (const auto& host : flutterEngines_) {
+        // Memory the runner holds on the engine's behalf: frame mailboxes,
+        // surface targets (swapchain images plus upload texture), converted
+        // pixels and heap backing stores still alive.
+        size_t memoryBytes = host->heapBackingStoreBytes.load(std::memory_order_relaxed);
+        for (const auto& view : flutterViews_) {
+            if (view->engine != host->index) {
+                continue;
+            }
+            memoryBytes += view->frames.CapacityBytes() * FrameMailbox::kSlotCount + view->convertedPixels.capacity();
+            for (const auto& target : view->surfaceTargets) {
+                memoryBytes += static_cast<size_t>(target->width) * target->height * 4 * (target->images.size() + 1);
+            }
+        }
+
+        const uint64_t frames = host->framesPresented.load(std::memory_order_relaxed);
+        const double rasterMeanMs =
+            frames > 0 ? static_cast<double>(host->rasterNanosTotal.load(std::memory_order_relaxed)) / frames / 1e6 : 0.0;
+        const PlatformTaskRunner::Stats taskStats = platformTasks_.GetStats(host->index);
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(2) << "Flutter engine " << host->index << " (" << host->entrypoint
+             << "): frames=" << frames << " raster mean=" << rasterMeanMs
+             << " ms max=" << static_cast<double>(host->rasterNanosMax.load(std::memory_order_relaxed)) / 1e6
+             << " ms upload=" << static_cast<double>(host->uploadedBytes) / (1024.0 * 1024.0)
+             << " MB in " << static_cast<double>(host->uploadNanos) / 1e6 << " ms platformTasks=" << taskStats.tasksRun
+             << " maxQueueDepth=" << taskStats.maxQueueDepth << " busy=" << taskStats.busyMs << " ms memory=" << static_cast<double>(memoryBytes) / (1024.0 * 1024.0)
+             << " MB\n";
+        std::cout << line.str();
+    }
+
+    if (engineProcess_ != nullptr) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(2) << "Flutter engine process: restarts=" << engineProcess_->RestartCount()
+             << " skippedFrames=" << engineProcess_->Frames().SkippedFrameCount()
+             << " rejectedFrames=" << engineProcess_->Frames().RejectedFrameCount()
+             << " sharedMemory=" << static_cast<double>(engineProcess_->MappedBytes()) / (1024.0 * 1024.0) << " MB\n";
+        std::cout << line.str();
+    }
+}
+
+void FlutterXrApp::MaybeLogFlutterEngineStats() {
+    if (config_.engineStatsIntervalSeconds <= 0.0) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (lastEngineStatsLog_ == std::chrono::steady_clock::time_point{}) {
+        lastEngineStatsLog_ = now;
+        return;
+    }
+    if (std::chrono::duration<double>(now - lastEngineStatsLog_).count() < config_.engineStatsIntervalSeconds) {
+        return;
     }
+    lastEngineStatsLog_ = now;
+    LogFlutterEngineStats();
 }
 
-bool FlutterXrApp::HandleFlutterSurfacePresent(const void* allocation, size_t rowBytes, size_t height) {
-    if (allocation == nullptr || rowBytes < 4 || height == 0) {
+bool FlutterXrApp::HandleFlutterSurfacePresent(FlutterEngineHost& host, const void* allocation, size_t rowBytes,
+                                               size_t height) {
+    FlutterViewPanel* view = FindFlutterView(host.index, kFlutterViewId);
+    if (view == nullptr || allocation == nullptr || rowBytes < 4 || height == 0) {
         return false;
     }
 
-    const size_t frameBytes = rowBytes * height;
-    {
-        std::lock_guard<std::mutex> lock(flutterBridge_.latestFrame.mutex);
-        flutterBridge_.latestFrame.pixels.resize(frameBytes);
-        std::memcpy(flutterBridge_.latestFrame.pixels.data(), allocation, frameBytes);
-        flutterBridge_.latestFrame.rowBytes = rowBytes;
-        flutterBridge_.latestFrame.width = rowBytes / 4;
-        flutterBridge_.latestFrame.height = height;
-        flutterBridge_.latestFrame.frameIndex += 1;
+    // Only the implicit view is presented this way.
+    FrameMailbox& frames = view->frames;
+    uint8_t* target = frames.BeginWrite(rowBytes, rowBytes / 4, height);
+    if (target == nullptr) {
+        return false;
+    }
+    CopyRowsParallel(pixelWorkers_, target, allocation, rowBytes, height);
+    frames.Publish();
+    host.framesPresented.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool FlutterXrApp::HandleFlutterCreateBackingStore(FlutterEngineHost& host, const FlutterBackingStoreConfig* config,
+                                                   FlutterBackingStore* backingStoreOut) {
+    if (config == nullptr || backingStoreOut == nullptr || config->size.width < 1.0 || config->size.height < 1.0) {
+        return false;
+    }
+
+    FlutterViewPanel* view = FindFlutterView(host.index, config->view_id);
+    if (view == nullptr) {
+        return false;
+    }
+
+    const size_t width = static_cast<size_t>(config->size.width);
+    const size_t height = static_cast<size_t>(config->size.height);
+    const size_t rowBytes = width * 4;
+    view->rasterStartNanos.store(FlutterEngineGetCurrentTime(), std::memory_order_relaxed);
+    view->rasterRowBytes = rowBytes;
+    view->rasterHeight = height;
+
+    // Hand out the view's mailbox write slot when it is free so Flutter
+    // rasterizes straight into memory the upload path reads. Extra stores
+    // requested in the same frame fall back to a heap allocation.
+    uint8_t* allocation = nullptr;
+    bool pooled = false;
+    if (!view->pooledBackingStoreOutstanding) {
+        allocation = view->frames.BeginWrite(rowBytes, width, height);
+        pooled = allocation != nullptr;
+    }
+    if (allocation == nullptr) {
+        allocation = new uint8_t[rowBytes * height]();
+        host.heapBackingStoreBytes.fetch_add(rowBytes * height, std::memory_order_relaxed);
+    }
+
+    backingStoreOut->struct_size = sizeof(FlutterBackingStore);
+    backingStoreOut->type = kFlutterBackingStoreTypeSoftware;
+    backingStoreOut->user_data = pooled ? &view->frames : nullptr;
+    backingStoreOut->software.allocation = allocation;
+    backingStoreOut->software.row_bytes = rowBytes;
+    backingStoreOut->software.height = height;
+    backingStoreOut->software.user_data = pooled ? nullptr : allocation;
+    backingStoreOut->software.destruction_callback = pooled ? ReleasePooledBackingStore : ReleaseHeapBackingStore;
+
+    view->pooledBackingStoreOutstanding = view->pooledBackingStoreOutstanding || pooled;
+    return true;
+}
+
+bool FlutterXrApp::HandleFlutterCollectBackingStore(FlutterEngineHost& host, const FlutterBackingStore* backingStore) {
+    if (backingStore == nullptr) {
+        return false;
+    }
+    if (backingStore->user_data == nullptr) {
+        host.heapBackingStoreBytes.fetch_sub(backingStore->software.row_bytes * backingStore->software.height,
+                                             std::memory_order_relaxed);
+        return true;
+    }
+    for (const auto& view : flutterViews_) {
+        if (backingStore->user_data == &view->frames) {
+            view->pooledBackingStoreOutstanding = false;
+        }
+    }
+    return true;
+}
+
+bool FlutterXrApp::HandleFlutterPresentView(FlutterEngineHost& host, int64_t viewId, const FlutterLayer** layers,
+                                           size_t layersCount) {
+    FlutterViewPanel* view = FindFlutterView(host.index, viewId);
+    if (view == nullptr || (layers == nullptr && layersCount != 0)) {
+        return false;
+    }
+
+    // An empty or fully transparent scene comes without layers. Publish one
+    // cleared frame so the panel does not keep showing the previous content.
+    if (layersCount == 0) {
+        host.framesPresented.fetch_add(1, std::memory_order_relaxed);
+        if (view->rasterPresentedEmpty || view->rasterRowBytes == 0 || view->pooledBackingStoreOutstanding) {
+            return true;
+        }
+        uint8_t* target = view->frames.BeginWrite(view->rasterRowBytes, view->rasterRowBytes / 4, view->rasterHeight);
+        if (target != nullptr) {
+            std::memset(target, 0, view->rasterRowBytes * view->rasterHeight);
+            view->frames.Publish();
+            view->rasterPresentedEmpty = true;
+        }
+        return true;
+    }
+    view->rasterPresentedEmpty = false;
+
+    // The runner hosts no platform views, so Flutter composites everything
+    // into a single backing-store layer.
+    const FlutterLayer* layer = layers[0];
+    if (layersCount != 1 || layer == nullptr || layer->type != kFlutterLayerContentTypeBackingStore ||
+        layer->backing_store == nullptr) {
+        return false;
     }
 
-    if (flutterBridge_.firstFrameEvent != nullptr) {
-        SetEvent(flutterBridge_.firstFrameEvent);
+    // Backing stores are created as rasterization starts, so the time since
+    // then is Flutter's raster cost for this view's frame.
+    const uint64_t rasterStart = view->rasterStartNanos.load(std::memory_order_relaxed);
+    if (rasterStart != 0) {
+        const uint64_t rasterNanos = FlutterEngineGetCurrentTime() - rasterStart;
+        view->rasterNanos.store(rasterNanos, std::memory_order_relaxed);
+        host.rasterNanosTotal.fetch_add(rasterNanos, std::memory_order_relaxed);
+        UpdateMax(host.rasterNanosMax, rasterNanos);
+    }
+    host.framesPresented.fetch_add(1, std::memory_order_relaxed);
+
+    const FlutterBackingStore* store = layer->backing_store;
+    if (store->user_data == &view->frames) {
+        view->frames.Publish();
+    } else {
+        uint8_t* target =
+            view->frames.BeginWrite(store->software.row_bytes, store->software.row_bytes / 4, store->software.height);
+        if (target == nullptr) {
+            return false;
+        }
+        CopyRowsParallel(pixelWorkers_, target, store->software.allocation, store->software.row_bytes,
+                         store->software.height);
+        view->frames.Publish();
     }
     return true;
 }
 
-void FlutterXrApp::HandleFlutterPlatformMessage(const FlutterPlatformMessage* message) {
-    if (message == nullptr || message->response_handle == nullptr || flutterEngine_ == nullptr) {
+void FlutterXrApp::HandleFlutterPlatformMessage(FlutterEngineHost& host, const FlutterPlatformMessage* message) {
+    if (message == nullptr || message->response_handle == nullptr || host.engine == nullptr) {
         return;
     }
 
     auto sendResponse = [&](const std::string& responseText) {
         const auto* bytes = reinterpret_cast<const uint8_t*>(responseText.data());
         const FlutterEngineResult responseResult =
-            FlutterEngineSendPlatformMessageResponse(flutterEngine_, message->response_handle, bytes, responseText.size());
+            FlutterEngineSendPlatformMessageResponse(host.engine, message->response_handle, bytes, responseText.size());
         if (responseResult != kSuccess) {
             std::cerr << "[warn] FlutterEngineSendPlatformMessageResponse failed. result="
                       << static_cast<int32_t>(responseResult) << "\n";
@@ -146,50 +471,328 @@ void FlutterXrApp::HandleFlutterPlatformMessage(const FlutterPlatformMessage* me
     sendResponse(HandleBackgroundMessage(command));
 }
 
-bool FlutterXrApp::UploadLatestFlutterFrame() {
-    FlutterFrame snapshot;
+void FlutterXrApp::HandleFlutterVsync(FlutterEngineHost& host, intptr_t baton) {
+    {
+        std::lock_guard<std::mutex> lock(vsyncMutex_);
+        if (xrVsyncActive_) {
+            host.pendingVsyncBaton = baton;
+            host.hasPendingVsyncBaton = true;
+            return;
+        }
+    }
+
+    // Without a running XR session (startup, headset idle) tick on a nominal
+    // 60 Hz grid so animations stay throttled.
+    const uint64_t now = FlutterEngineGetCurrentTime();
+    const uint64_t frameStart = (now / kFallbackVsyncPeriodNanos + 1) * kFallbackVsyncPeriodNanos;
+    SendFlutterVsync(host, baton, frameStart, frameStart + kFallbackVsyncPeriodNanos);
+}
+
+void FlutterXrApp::SetXrVsyncActive(bool active) {
+    std::vector<std::pair<FlutterEngineHost*, intptr_t>> batons;
     {
-        std::lock_guard<std::mutex> lock(flutterBridge_.latestFrame.mutex);
-        if (flutterBridge_.latestFrame.frameIndex == 0 || flutterBridge_.latestFrame.frameIndex == uploadedFrameIndex_) {
+        std::lock_guard<std::mutex> lock(vsyncMutex_);
+        xrVsyncActive_ = active;
+        for (const auto& host : flutterEngines_) {
+            if (!active && host->hasPendingVsyncBaton) {
+                batons.emplace_back(host.get(), host->pendingVsyncBaton);
+                host->hasPendingVsyncBaton = false;
+            }
+        }
+    }
+    smoothedDisplayLatencyNanos_ = 0.0;
+
+    for (const auto& [host, baton] : batons) {
+        HandleFlutterVsync(*host, baton);
+    }
+}
+
+bool FlutterXrApp::XrTimeToFlutterTime(XrTime time, uint64_t* outFlutterNanos) const {
+    if (convertXrTimeToPerformanceCounter_ == nullptr || performanceCounterFrequency_ <= 0 || outFlutterNanos == nullptr) {
+        return false;
+    }
+
+    LARGE_INTEGER target{};
+    if (XR_FAILED(convertXrTimeToPerformanceCounter_(instance_, time, &target))) {
+        return false;
+    }
+    LARGE_INTEGER now{};
+    QueryPerformanceCounter(&now);
+    const uint64_t flutterNow = FlutterEngineGetCurrentTime();
+
+    // Only the distance from "now" is carried over, so the result does not
+    // depend on how the engine clock's epoch relates to the performance counter.
+    const double deltaNanos =
+        static_cast<double>(target.QuadPart - now.QuadPart) * 1e9 / static_cast<double>(performanceCounterFrequency_);
+    const double flutterTime = static_cast<double>(flutterNow) + deltaNanos;
+    *outFlutterNanos = flutterTime > 0.0 ? static_cast<uint64_t>(flutterTime) : 0;
+    return true;
+}
+
+void FlutterXrApp::UpdateXrClockEstimate(const XrFrameState& frameState) {
+    if (convertXrTimeToPerformanceCounter_ != nullptr || frameState.predictedDisplayTime <= 0) {
+        return;
+    }
+
+    // Without a time conversion extension, assume the predicted display time
+    // is one display period after xrWaitFrame returns. Only the offset is
+    // guessed; the spacing between converted times stays exact.
+    const int64_t period = frameState.predictedDisplayPeriod > 0 ? static_cast<int64_t>(frameState.predictedDisplayPeriod)
+                                                                 : static_cast<int64_t>(kFallbackVsyncPeriodNanos);
+    const int64_t offset = static_cast<int64_t>(FlutterEngineGetCurrentTime()) + period -
+                           static_cast<int64_t>(frameState.predictedDisplayTime);
+    if (!xrClockOffsetValid_.load(std::memory_order_acquire)) {
+        xrClockOffsetNanos_.store(offset, std::memory_order_relaxed);
+        xrClockOffsetValid_.store(true, std::memory_order_release);
+        return;
+    }
+    const double previous = static_cast<double>(xrClockOffsetNanos_.load(std::memory_order_relaxed));
+    const double smoothed = previous + (static_cast<double>(offset) - previous) * kDisplayLatencySmoothing;
+    xrClockOffsetNanos_.store(static_cast<int64_t>(smoothed), std::memory_order_relaxed);
+}
+
+uint64_t FlutterXrApp::EstimateFlutterTime(XrTime time) const {
+    uint64_t flutterNanos = 0;
+    if (XrTimeToFlutterTime(time, &flutterNanos)) {
+        return flutterNanos;
+    }
+    if (!xrClockOffsetValid_.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    const int64_t estimate = static_cast<int64_t>(time) + xrClockOffsetNanos_.load(std::memory_order_relaxed);
+    return estimate > 0 ? static_cast<uint64_t>(estimate) : 0;
+}
+
+void FlutterXrApp::PaceFlutterVsync(const XrFrameState& frameState) {
+    if (!config_.useFlutterVsync || flutterEngines_.empty()) {
+        return;
+    }
+
+    const uint64_t now = FlutterEngineGetCurrentTime();
+    const uint64_t period = frameState.predictedDisplayPeriod > 0 ? static_cast<uint64_t>(frameState.predictedDisplayPeriod)
+                                                                  : kFallbackVsyncPeriodNanos;
+
+    // The render thread samples the mailbox right after xrWaitFrame returns,
+    // i.e. one period from now. Deriving that instant from the predicted
+    // display time and a smoothed wait-to-display latency follows the
+    // runtime's display clock instead of this thread's wake-up jitter.
+    uint64_t nextSample = now + period;
+    uint64_t displayTime = 0;
+    if (XrTimeToFlutterTime(frameState.predictedDisplayTime, &displayTime) && displayTime > now) {
+        const double latency = static_cast<double>(displayTime - now);
+        smoothedDisplayLatencyNanos_ = smoothedDisplayLatencyNanos_ <= 0.0
+                                           ? latency
+                                           : smoothedDisplayLatencyNanos_ +
+                                                 (latency - smoothedDisplayLatencyNanos_) * kDisplayLatencySmoothing;
+        const double sample = static_cast<double>(displayTime + period) - smoothedDisplayLatencyNanos_;
+        nextSample = std::max(now, static_cast<uint64_t>(std::max(sample, 0.0)));
+    }
+
+    // Every engine is released against the same display sample, so panels
+    // from different engines update on the same XR frame.
+    std::vector<std::pair<FlutterEngineHost*, intptr_t>> batons;
+    {
+        std::lock_guard<std::mutex> lock(vsyncMutex_);
+        for (const auto& host : flutterEngines_) {
+            if (host->hasPendingVsyncBaton) {
+                batons.emplace_back(host.get(), host->pendingVsyncBaton);
+                host->hasPendingVsyncBaton = false;
+            }
+        }
+    }
+    if (batons.empty()) {
+        return;
+    }
+
+    const uint64_t rasterLead = static_cast<uint64_t>(config_.rasterLeadMs * 1e6);
+    const uint64_t frameTarget = nextSample > now + rasterLead ? nextSample - rasterLead : now;
+    const uint64_t frameStart = frameTarget > period ? frameTarget - period : 0;
+    for (const auto& [host, baton] : batons) {
+        SendFlutterVsync(*host, baton, frameStart, frameTarget);
+    }
+}
+
+void FlutterXrApp::SendFlutterVsync(FlutterEngineHost& host, intptr_t baton, uint64_t frameStartNanos,
+                                    uint64_t frameTargetNanos) {
+    if (host.engine == nullptr) {
+        return;
+    }
+    host.frameTargetNanos.store(frameTargetNanos, std::memory_order_relaxed);
+    const FlutterEngineResult result = FlutterEngineOnVsync(host.engine, baton, frameStartNanos, frameTargetNanos);
+    if (result != kSuccess) {
+        std::cerr << "[warn] FlutterEngineOnVsync failed. engine=" << host.index
+                  << " result=" << static_cast<int32_t>(result) << "\n";
+    }
+}
+
+void FlutterXrApp::PrepareNextFrame() {
+    // Runs while the wait thread blocks on the next frame, so Flutter frames
+    // that are already here are converted and uploaded off that frame's
+    // critical path.
+    UploadLatestFlutterFrames(&preparedFlutterBytes_);
+}
+
+void FlutterXrApp::UploadLatestFlutterFrames(size_t* outBytesUploaded) {
+    // Finding and converting changed pixels only touches the view itself, so
+    // views are prepared in parallel. The immediate context is not
+    // thread-safe, so the texture copies are issued here afterwards. Views
+    // without a new frame skip both steps.
+    pixelWorkers_.ParallelForRows(flutterViews_.size(), 1, [&](size_t viewBegin, size_t viewEnd) {
+        for (size_t i = viewBegin; i < viewEnd; ++i) {
+            const uint64_t prepareStart = FlutterEngineGetCurrentTime();
+            PrepareFlutterViewUpload(*flutterViews_[i]);
+            flutterViews_[i]->uploadNanos = FlutterEngineGetCurrentTime() - prepareStart;
+        }
+    });
+    for (const auto& view : flutterViews_) {
+        const uint64_t commitStart = FlutterEngineGetCurrentTime();
+        size_t viewBytes = 0;
+        if (CommitFlutterViewUpload(*view, &viewBytes)) {
+            view->textureChanged = true;
+        }
+
+        // Upload work is charged to the engine that produced the frame.
+        FlutterEngineHost& host = *flutterEngines_[view->engine];
+        host.uploadedBytes += viewBytes;
+        host.uploadNanos += view->uploadNanos + (FlutterEngineGetCurrentTime() - commitStart);
+        if (outBytesUploaded != nullptr) {
+            *outBytesUploaded += viewBytes;
+        }
+    }
+}
+
+bool FlutterXrApp::AcquireFlutterFrame(FlutterViewPanel& view, FlutterFrame* outFrame) {
+    if (engineProcess_ == nullptr) {
+        const FrameSlot* slot = view.frames.AcquireLatest();
+        if (slot == nullptr) {
             return false;
         }
-        snapshot.rowBytes = flutterBridge_.latestFrame.rowBytes;
-        snapshot.width = flutterBridge_.latestFrame.width;
-        snapshot.height = flutterBridge_.latestFrame.height;
-        snapshot.frameIndex = flutterBridge_.latestFrame.frameIndex;
-        snapshot.pixels = flutterBridge_.latestFrame.pixels;
+        *outFrame = FlutterFrame{slot->pixels.get(), slot->rowBytes, slot->width, slot->height, slot->frameIndex};
+        return true;
     }
 
-    if (snapshot.width == 0 || snapshot.height == 0 || snapshot.rowBytes < snapshot.width * 4 || snapshot.pixels.empty()) {
+    SharedFrame shared;
+    if (!engineProcess_->Frames().AcquireLatest(&shared)) {
         return false;
     }
 
-    const size_t uploadWidth = std::min(snapshot.width, static_cast<size_t>(kFlutterSurfaceWidth));
-    const size_t uploadHeight = std::min(snapshot.height, static_cast<size_t>(kFlutterSurfaceHeight));
+    // The engine process measures raster time itself; it feeds the same
+    // statistics and resolution control as in-process frames.
+    FlutterEngineHost& host = *flutterEngines_[view.engine];
+    view.rasterNanos.store(shared.rasterNanos, std::memory_order_relaxed);
+    host.framesPresented.fetch_add(1, std::memory_order_relaxed);
+    host.rasterNanosTotal.fetch_add(shared.rasterNanos, std::memory_order_relaxed);
+    UpdateMax(host.rasterNanosMax, shared.rasterNanos);
+    *outFrame = FlutterFrame{shared.pixels, shared.rowBytes, shared.width, shared.height, shared.sequence};
+    return true;
+}
+
+void FlutterXrApp::PrepareFlutterViewUpload(FlutterViewPanel& view) {
+    view.uploads.clear();
+    FlutterFrame frame;
+    if (!AcquireFlutterFrame(view, &frame) || view.activeSurface == nullptr) {
+        return;
+    }
+
+    if (frame.width == 0 || frame.height == 0 || frame.rowBytes < frame.width * 4) {
+        return;
+    }
+
+    // Frames rendered before or after a resize carry their own size; route
+    // each to the target of that size when one exists.
+    FlutterSurfaceTarget* target =
+        FindFlutterSurfaceTarget(view, static_cast<uint32_t>(frame.width), static_cast<uint32_t>(frame.height));
+    if (target != nullptr) {
+        view.activeSurface = target;
+    }
+
+    const size_t uploadWidth = std::min(frame.width, static_cast<size_t>(view.activeSurface->width));
+    const size_t uploadHeight = std::min(frame.height, static_cast<size_t>(view.activeSurface->height));
     if (uploadWidth == 0 || uploadHeight == 0) {
-        return false;
+        return;
+    }
+
+    // Everything outside the content bounds is transparent and never
+    // submitted, so those tiles do not need uploading either.
+    const DirtyRect* visibleBounds = nullptr;
+    if (config_.cropToContent) {
+        view.contentVisible = FindContentBounds(frame.pixels, frame.rowBytes, static_cast<uint32_t>(uploadWidth),
+                                                static_cast<uint32_t>(uploadHeight), &view.contentBounds);
+        if (!view.contentVisible) {
+            view.contentBounds = DirtyRect{};
+        }
+        visibleBounds = &view.contentBounds;
+    }
+
+    const std::vector<DirtyRect>& dirtyRects =
+        view.dirtyTiles.Update(frame.pixels, frame.rowBytes, static_cast<uint32_t>(uploadWidth),
+                               static_cast<uint32_t>(uploadHeight), visibleBounds);
+    view.uploadedFrameIndex = frame.frameIndex;
+    if (dirtyRects.empty()) {
+        return;
     }
 
-    const uint8_t* uploadPixels = snapshot.pixels.data();
-    size_t uploadRowBytes = snapshot.rowBytes;
+    // BGRA swapchains get every rect converted into one packed buffer, sized
+    // up front so the pointers handed to the upload stay valid.
     if (isBgraFormat_) {
-        if (!ConvertRgbaToBgra(snapshot.pixels.data(), snapshot.rowBytes, uploadWidth, uploadHeight, convertedPixels_)) {
-            return false;
+        size_t convertedBytes = 0;
+        for (const DirtyRect& rect : dirtyRects) {
+            convertedBytes += static_cast<size_t>(rect.width) * rect.height * 4;
         }
-        uploadPixels = convertedPixels_.data();
-        uploadRowBytes = uploadWidth * 4;
+        view.convertedPixels.resize(convertedBytes);
     }
 
-    D3D11_BOX dstBox{};
-    dstBox.left = 0;
-    dstBox.top = 0;
-    dstBox.front = 0;
-    dstBox.right = static_cast<UINT>(uploadWidth);
-    dstBox.bottom = static_cast<UINT>(uploadHeight);
-    dstBox.back = 1;
+    size_t convertedOffset = 0;
+    for (const DirtyRect& rect : dirtyRects) {
+        PendingViewUpload upload;
+        upload.rect = rect;
+        upload.pixels = frame.pixels + rect.y * frame.rowBytes + static_cast<size_t>(rect.x) * 4;
+        upload.rowBytes = frame.rowBytes;
+        if (isBgraFormat_) {
+            const uint8_t* rectPixels = upload.pixels;
+            const size_t sourceRowBytes = frame.rowBytes;
+            const size_t convertedRowBytes = static_cast<size_t>(rect.width) * 4;
+            uint8_t* converted = view.convertedPixels.data() + convertedOffset;
+            pixelWorkers_.ParallelForRows(rect.height, kMinRowsPerStripe, [&](size_t rowBegin, size_t rowEnd) {
+                SwizzleRgbaToBgra(rectPixels + rowBegin * sourceRowBytes, sourceRowBytes,
+                                  converted + rowBegin * convertedRowBytes, convertedRowBytes, rect.width,
+                                  rowEnd - rowBegin);
+            });
+            upload.pixels = converted;
+            upload.rowBytes = convertedRowBytes;
+            convertedOffset += convertedRowBytes * rect.height;
+        }
+        view.uploads.push_back(upload);
+    }
+}
 
-    deviceContext_->UpdateSubresource(flutterTexture_.Get(), 0, &dstBox, uploadPixels, static_cast<UINT>(uploadRowBytes), 0);
-    uploadedFrameIndex_ = snapshot.frameIndex;
+bool FlutterXrApp::CommitFlutterViewUpload(FlutterViewPanel& view, size_t* outBytesUploaded) {
+    if (view.uploads.empty()) {
+        return false;
+    }
+
+    for (const PendingViewUpload& upload : view.uploads) {
+        const DirtyRect& rect = upload.rect;
+        D3D11_BOX dstBox{};
+        dstBox.left = rect.x;
+        dstBox.top = rect.y;
+        dstBox.front = 0;
+        dstBox.right = rect.x + rect.width;
+        dstBox.bottom = rect.y + rect.height;
+        dstBox.back = 1;
+
+        deviceContext_->UpdateSubresource(view.activeSurface->texture.Get(), 0, &dstBox, upload.pixels,
+                                          static_cast<UINT>(upload.rowBytes), 0);
+        if (outBytesUploaded != nullptr) {
+            *outBytesUploaded += static_cast<size_t>(rect.width) * rect.height * 4;
+        }
+    }
+    view.uploads.clear();
+
+    if (!firstFlutterFrameLogged_) {
+        LogStartupPhase("first flutter frame uploaded");
+        firstFlutterFrameLogged_ = true;
+    }
     return true;
 }
 
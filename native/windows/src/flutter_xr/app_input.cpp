@@ -5,6 +5,7 @@
 #include <cmath>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 namespace flutter_xr {
 
@@ -22,6 +23,33 @@ float ApplyAxisDeadzone(float value) {
     return std::copysign(normalized, value);
 }
 
+FlutterEngineResult SendPointerEventsToProcess(void* context, const FlutterPointerEvent* events, size_t count) {
+    return static_cast<EngineProcess*>(context)->SendPointerEvents(events, count) ? kSuccess : kInternalInconsistency;
+}
+
+struct PointerEventPost {
+    PlatformTaskRunner* platformTasks;
+    FlutterEngineHost* host;
+};
+
+// The batch is stamped on the render thread and sent from the platform
+// thread, where the embedder requires the call to be made.
+FlutterEngineResult PostPointerEvents(void* context, const FlutterPointerEvent* events, size_t count) {
+    const auto* post = static_cast<PointerEventPost*>(context);
+    FlutterEngineHost* host = post->host;
+    post->platformTasks->Post([host, batch = std::vector<FlutterPointerEvent>(events, events + count)]() {
+        if (host->engine == nullptr) {
+            return;
+        }
+        const FlutterEngineResult result = FlutterEngineSendPointerEvent(host->engine, batch.data(), batch.size());
+        if (result != kSuccess) {
+            std::cerr << "[warn] FlutterEngineSendPointerEvent failed. events=" << batch.size()
+                      << " result=" << static_cast<int32_t>(result) << "\n";
+        }
+    });
+    return kSuccess;
+}
+
 float MagnitudeSquared(const XrVector2f& value) {
     return value.x * value.x + value.y * value.y;
 }
@@ -200,6 +228,74 @@ void FlutterXrApp::InitializeInputActions() {
                     "xrCreateActionSpace(pointerLeft)", instance_);
 }
 
+void FlutterXrApp::UpdatePointerFilterTuning() {
+    auto update = [&](XrPath handPath, PoseFilter* filter, const char* label) {
+        XrInteractionProfileState profileState{XR_TYPE_INTERACTION_PROFILE_STATE};
+        ThrowIfXrFailed(xrGetCurrentInteractionProfile(session_, handPath, &profileState),
+                        "xrGetCurrentInteractionProfile", instance_);
+
+        std::string profile;
+        if (profileState.interactionProfile != XR_NULL_PATH) {
+            char buffer[XR_MAX_PATH_LENGTH] = {};
+            uint32_t length = 0;
+            ThrowIfXrFailed(
+                xrPathToString(instance_, profileState.interactionProfile, XR_MAX_PATH_LENGTH, &length, buffer),
+                "xrPathToString(interaction profile)", instance_);
+            profile = buffer;
+        }
+        filter->SetTuning(PointerFilterTuningForProfile(profile));
+        filter->Reset();
+        std::cout << "Interaction profile (" << label << "): " << (profile.empty() ? "none" : profile) << "\n";
+    };
+    update(rightHandPath_, &rightPointerFilter_, "right");
+    update(leftHandPath_, &leftPointerFilter_, "left");
+}
+
+bool FlutterXrApp::LocatePointer(XrTime time, XrSpace pointerSpace, XrPosef* outPose) const {
+    XrSpaceLocation pointerLocation{XR_TYPE_SPACE_LOCATION};
+    const XrResult locateResult = xrLocateSpace(pointerSpace, appSpace_, time, &pointerLocation);
+    if (XR_FAILED(locateResult)) {
+        return false;
+    }
+
+    constexpr XrSpaceLocationFlags kRequiredFlags =
+        XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
+    if ((pointerLocation.locationFlags & kRequiredFlags) != kRequiredFlags) {
+        return false;
+    }
+    *outPose = pointerLocation.pose;
+    return true;
+}
+
+PointerHitResult FlutterXrApp::HitTestPointer(const XrPosef& pointerPose) const {
+    PointerHitResult result;
+    const XrVector3f rayForward = RotateVector(pointerPose.orientation, XrVector3f{0.0f, 0.0f, -1.0f});
+    result.hasPose = true;
+    result.rayOriginWorld = pointerPose.position;
+    result.rayDirectionWorld = Normalize(rayForward);
+    result.pointerOrientation = pointerPose.orientation;
+
+    const PanelHit panelHit = flutterPanelHits_.Intersect(PanelRay{pointerPose.position, result.rayDirectionWorld});
+    if (panelHit.panel < 0) {
+        return result;
+    }
+
+    // u/v are relative to the submitted region; map them back onto the
+    // whole surface of the hit view in the physical pixels Flutter currently
+    // lays out.
+    result.onQuad = true;
+    result.view = flutterPanelHitViews_[static_cast<size_t>(panelHit.panel)];
+    result.hitDistanceMeters = panelHit.distance;
+    const FlutterViewPanel& view = *flutterViews_[result.view];
+    const double u = static_cast<double>(panelHit.u);
+    const double v = static_cast<double>(panelHit.v);
+    const double surfaceWidth = static_cast<double>(view.metricsWidth);
+    const double surfaceHeight = static_cast<double>(view.metricsHeight);
+    result.xPixels = std::clamp((view.geometry.u0 + u * view.geometry.uSpan) * surfaceWidth, 0.0, surfaceWidth - 1.0);
+    result.yPixels = std::clamp((view.geometry.v0 + v * view.geometry.vSpan) * surfaceHeight, 0.0, surfaceHeight - 1.0);
+    return result;
+}
+
 PointerHitResult FlutterXrApp::QueryPointerHit(XrTime predictedDisplayTime, XrSpace pointerSpace, XrPath handPath) {
     PointerHitResult result;
     if (pointerSpace == XR_NULL_HANDLE || handPath == XR_NULL_PATH) {
@@ -216,106 +312,165 @@ PointerHitResult FlutterXrApp::QueryPointerHit(XrTime predictedDisplayTime, XrSp
         return result;
     }
 
-    XrSpaceLocation pointerLocation{XR_TYPE_SPACE_LOCATION};
-    const XrResult locateResult = xrLocateSpace(pointerSpace, appSpace_, predictedDisplayTime, &pointerLocation);
-    if (XR_FAILED(locateResult)) {
+    const bool leftHand = handPath == leftHandPath_;
+    PoseFilter& filter = leftHand ? leftPointerFilter_ : rightPointerFilter_;
+    XrPosef pointerPose{};
+    if (!LocatePointer(predictedDisplayTime, pointerSpace, &pointerPose)) {
+        filter.Reset();
         return result;
     }
+    if (config_.filterPointerPose) {
+        (leftHand ? leftPointerFilterBeforeFrame_ : rightPointerFilterBeforeFrame_) = filter;
+        pointerPose = filter.Filter(static_cast<double>(predictedDisplayTime) * 1e-9, pointerPose);
+    }
+    return HitTestPointer(pointerPose);
+}
 
-    constexpr XrSpaceLocationFlags kRequiredFlags =
-        XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
-    if ((pointerLocation.locationFlags & kRequiredFlags) != kRequiredFlags) {
-        return result;
+void FlutterXrApp::UpdatePointerRay(const PointerHitResult& hit, bool* visible, float* length, XrPosef* pose) {
+    if (!hit.hasPose) {
+        *visible = false;
+        return;
     }
 
-    const XrVector3f rayForward = RotateVector(pointerLocation.pose.orientation, XrVector3f{0.0f, 0.0f, -1.0f});
-    result.hasPose = true;
-    result.rayOriginWorld = pointerLocation.pose.position;
-    result.rayDirectionWorld = Normalize(rayForward);
-    result.pointerOrientation = pointerLocation.pose.orientation;
+    const float rayLength =
+        hit.onQuad ? std::clamp(hit.hitDistanceMeters, kPointerRayMinLengthMeters, kPointerRayFallbackLengthMeters)
+                   : kPointerRayFallbackLengthMeters;
+    *length = rayLength;
+    pose->orientation = Multiply(hit.pointerOrientation, kRayAlignmentFromController);
+    pose->position = Add(hit.rayOriginWorld, Scale(hit.rayDirectionWorld, rayLength * 0.5f));
+    *visible = true;
+}
+
+void FlutterXrApp::LateLatchPointerRays(XrTime predictedDisplayTime) {
+    if (!config_.lateLatchPointerRays) {
+        return;
+    }
 
-    const XrPosef quadPose = MakeQuadPose();
+    // Only the drawn rays move to the late sample. Flutter already received
+    // events from the early one this frame, and this does not change them.
+    // With filtering on, the late sample replaces the early one in a copy of
+    // the filter as it was before this frame, so the ray gets the same
+    // smoothing as the hit point Flutter saw and does not jitter around it.
+    auto relatch = [&](XrSpace pointerSpace, const PoseFilter& filterBeforeFrame, bool* visible, float* length,
+                       XrPosef* pose) {
+        XrPosef pointerPose{};
+        if (*visible && pointerSpace != XR_NULL_HANDLE && LocatePointer(predictedDisplayTime, pointerSpace, &pointerPose)) {
+            if (config_.filterPointerPose) {
+                PoseFilter filter = filterBeforeFrame;
+                pointerPose = filter.Filter(static_cast<double>(predictedDisplayTime) * 1e-9, pointerPose);
+            }
+            UpdatePointerRay(HitTestPointer(pointerPose), visible, length, pose);
+        }
+    };
+    relatch(pointerSpace_, rightPointerFilterBeforeFrame_, &pointerRayVisible_, &pointerRayLengthMeters_,
+            &pointerRayPose_);
+    relatch(leftPointerSpace_, leftPointerFilterBeforeFrame_, &leftPointerRayVisible_, &leftPointerRayLengthMeters_,
+            &leftPointerRayPose_);
+}
 
-    double u = 0.0;
-    double v = 0.0;
-    if (!IntersectRayWithQuad(pointerLocation.pose.position, result.rayDirectionWorld, quadPose, kQuadWidthMeters, kQuadHeightMeters,
-                              &result.hitDistanceMeters,
-                              &u, &v)) {
-        return result;
+bool FlutterXrApp::FlutterEngineReachable(size_t engineIndex) const {
+    if (engineProcess_ != nullptr) {
+        return engineProcess_->IsRunning();
     }
+    return flutterEngines_[engineIndex]->engine != nullptr;
+}
 
-    result.onQuad = true;
-    result.xPixels = std::clamp(u * static_cast<double>(kFlutterSurfaceWidth), 0.0, static_cast<double>(kFlutterSurfaceWidth - 1));
-    result.yPixels = std::clamp(v * static_cast<double>(kFlutterSurfaceHeight), 0.0, static_cast<double>(kFlutterSurfaceHeight - 1));
-    return result;
+bool FlutterXrApp::PointerEngineReachable() const {
+    return !flutterViews_.empty() && FlutterEngineReachable(flutterViews_[pointerView_]->engine);
+}
+
+FlutterEngineHost* FlutterXrApp::PointerFlutterEngineHost() const {
+    if (flutterViews_.empty()) {
+        return nullptr;
+    }
+    return flutterEngines_[flutterViews_[pointerView_]->engine].get();
 }
 
 bool FlutterXrApp::SendFlutterPointerEvent(FlutterPointerPhase phase, double xPixels, double yPixels, int64_t buttons) {
-    if (flutterEngine_ == nullptr) {
+    if (!PointerEngineReachable()) {
         return false;
     }
 
-    FlutterPointerEvent event{};
-    event.struct_size = sizeof(event);
-    event.phase = phase;
-    event.timestamp = static_cast<size_t>(FlutterEngineGetCurrentTime());
-    event.x = xPixels;
-    event.y = yPixels;
-    event.device = kPointerDeviceId;
-    event.signal_kind = kFlutterPointerSignalKindNone;
-    event.device_kind = kFlutterPointerDeviceKindMouse;
-    event.buttons = buttons;
-    event.view_id = kFlutterViewId;
+    pointerEvents_.Add(phase, xPixels, yPixels, buttons);
+    return SubmitFlutterPointerEvents();
+}
 
-    const FlutterEngineResult result = FlutterEngineSendPointerEvent(flutterEngine_, &event, 1);
+bool FlutterXrApp::SubmitFlutterPointerEvents(uint64_t timestampNanos) {
+    if (!PointerEngineReachable()) {
+        pointerEvents_.Clear();
+        return false;
+    }
+
+    const size_t eventCount = pointerEvents_.Size();
+    PointerEventPost post{&platformTasks_, PointerFlutterEngineHost()};
+    const FlutterEngineResult result =
+        engineProcess_ != nullptr ? pointerEvents_.Submit(SendPointerEventsToProcess, engineProcess_.get(), timestampNanos)
+                                  : pointerEvents_.Submit(PostPointerEvents, &post, timestampNanos);
     if (result != kSuccess) {
-        std::cerr << "[warn] FlutterEngineSendPointerEvent failed. phase=" << static_cast<int32_t>(phase)
+        std::cerr << "[warn] FlutterEngineSendPointerEvent failed. events=" << eventCount
                   << " result=" << static_cast<int32_t>(result) << "\n";
         return false;
     }
-
-    lastPointerX_ = xPixels;
-    lastPointerY_ = yPixels;
     return true;
 }
 
-bool FlutterXrApp::SendFlutterScrollEvent(double xPixels, double yPixels, double deltaXPixels, double deltaYPixels) {
-    if (flutterEngine_ == nullptr) {
-        return false;
+void FlutterXrApp::EnsureFlutterPointerAdded(double xPixels, double yPixels) {
+    if (pointerAdded_) {
+        return;
     }
+    pointerEvents_.Add(kAdd, xPixels, yPixels, 0);
+    pointerAdded_ = true;
+}
 
-    FlutterPointerEvent event{};
-    event.struct_size = sizeof(event);
-    event.phase = pointerDown_ ? kMove : kHover;
-    event.timestamp = static_cast<size_t>(FlutterEngineGetCurrentTime());
-    event.x = xPixels;
-    event.y = yPixels;
-    event.device = kPointerDeviceId;
-    event.signal_kind = kFlutterPointerSignalKindScroll;
-    event.scroll_delta_x = deltaXPixels;
-    event.scroll_delta_y = deltaYPixels;
-    event.device_kind = kFlutterPointerDeviceKindMouse;
-    event.buttons = pointerDown_ ? kFlutterPointerButtonMousePrimary : 0;
-    event.view_id = kFlutterViewId;
-
-    const FlutterEngineResult result = FlutterEngineSendPointerEvent(flutterEngine_, &event, 1);
-    if (result != kSuccess) {
-        std::cerr << "[warn] FlutterEngineSendPointerEvent failed. signal=scroll"
-                  << " result=" << static_cast<int32_t>(result) << "\n";
+bool FlutterXrApp::RouteFlutterPointer(const PointerHitResult& hit) {
+    if (!hit.onQuad) {
+        return false;
+    }
+    if (hit.view == pointerView_) {
+        return true;
+    }
+    // A pressed pointer stays with the view it went down on.
+    if (pointerDown_) {
         return false;
     }
 
-    lastPointerX_ = xPixels;
-    lastPointerY_ = yPixels;
+    // Hover state is kept per view, so the device leaves the old view before
+    // it is added to the new one.
+    if (pointerAdded_) {
+        pointerEvents_.Add(kRemove, pointerEvents_.LastX(), pointerEvents_.LastY(), 0);
+        pointerAdded_ = false;
+    }
+    // Queued events belong to the old view's engine, so they are sent before
+    // the pointer moves to another engine.
+    if (flutterViews_[hit.view]->engine != flutterViews_[pointerView_]->engine) {
+        SubmitFlutterPointerEvents();
+    }
+    pointerView_ = hit.view;
+    pointerEvents_.SetViewId(flutterViews_[pointerView_]->viewId);
+    pointerResampler_.Reset();
     return true;
 }
 
-void FlutterXrApp::EnsureFlutterPointerAdded(double xPixels, double yPixels) {
-    if (pointerAdded_) {
+void FlutterXrApp::ResamplePointerHit(const PointerHitResult& hit,
+                                      uint64_t sampleNanos,
+                                      double* outX,
+                                      double* outY,
+                                      uint64_t* outEventNanos) {
+    *outX = hit.xPixels;
+    *outY = hit.yPixels;
+    *outEventNanos = sampleNanos;
+    if (!config_.resamplePointer || !hit.onQuad || hit.view != pointerView_ || sampleNanos == 0) {
+        pointerResampler_.Reset();
         return;
     }
-    if (SendFlutterPointerEvent(kAdd, xPixels, yPixels, 0)) {
-        pointerAdded_ = true;
+
+    // Moves are reported where the pointer is at the target time of the
+    // frame Flutter is producing, so drags advance evenly per Flutter frame.
+    pointerResampler_.AddSample(sampleNanos, hit.xPixels, hit.yPixels);
+    const uint64_t frameTarget =
+        flutterEngines_[flutterViews_[pointerView_]->engine]->frameTargetNanos.load(std::memory_order_relaxed);
+    if (frameTarget != 0 && pointerResampler_.Resample(frameTarget, outX, outY)) {
+        *outEventNanos = frameTarget;
     }
 }
 
@@ -326,7 +481,7 @@ void FlutterXrApp::PollInput(XrTime predictedDisplayTime) {
 
     if (sessionState_ != XR_SESSION_STATE_FOCUSED) {
         if (pointerDown_) {
-            SendFlutterPointerEvent(kUp, lastPointerX_, lastPointerY_, 0);
+            SendFlutterPointerEvent(kUp, pointerEvents_.LastX(), pointerEvents_.LastY(), 0);
             pointerDown_ = false;
         }
         triggerPressed_ = false;
@@ -344,23 +499,8 @@ void FlutterXrApp::PollInput(XrTime predictedDisplayTime) {
     const PointerHitResult hit = QueryPointerHit(predictedDisplayTime, pointerSpace_, rightHandPath_);
     const PointerHitResult leftHit = QueryPointerHit(predictedDisplayTime, leftPointerSpace_, leftHandPath_);
 
-    auto updateRayState = [&](const PointerHitResult& pointerHit, bool* visible, float* length, XrPosef* pose) {
-        if (pointerHit.hasPose) {
-            const float rayLength =
-                pointerHit.onQuad
-                    ? std::clamp(pointerHit.hitDistanceMeters, kPointerRayMinLengthMeters, kPointerRayFallbackLengthMeters)
-                    : kPointerRayFallbackLengthMeters;
-            *length = rayLength;
-            pose->orientation = Multiply(pointerHit.pointerOrientation, kRayAlignmentFromController);
-            pose->position = Add(pointerHit.rayOriginWorld, Scale(pointerHit.rayDirectionWorld, rayLength * 0.5f));
-            *visible = true;
-            return;
-        }
-        *visible = false;
-    };
-
-    updateRayState(hit, &pointerRayVisible_, &pointerRayLengthMeters_, &pointerRayPose_);
-    updateRayState(leftHit, &leftPointerRayVisible_, &leftPointerRayLengthMeters_, &leftPointerRayPose_);
+    UpdatePointerRay(hit, &pointerRayVisible_, &pointerRayLengthMeters_, &pointerRayPose_);
+    UpdatePointerRay(leftHit, &leftPointerRayVisible_, &leftPointerRayLengthMeters_, &leftPointerRayPose_);
 
     XrActionStateGetInfo triggerGetInfo{XR_TYPE_ACTION_STATE_GET_INFO};
     triggerGetInfo.action = triggerValueAction_;
@@ -374,25 +514,56 @@ void FlutterXrApp::PollInput(XrTime predictedDisplayTime) {
     const bool pressedNow =
         triggerPressed_ ? (triggerValue >= kTriggerReleaseThreshold) : (triggerValue >= kTriggerPressThreshold);
 
+    // Only hits on the view the pointer belongs to produce events; a released
+    // pointer follows whichever panel it points at.
+    const bool onPointerView = RouteFlutterPointer(hit);
+
+    // Poses are located at the predicted display time, so that is when the
+    // events happen on the engine clock.
+    const uint64_t sampleNanos = EstimateFlutterTime(predictedDisplayTime);
+    double moveX = 0.0;
+    double moveY = 0.0;
+    uint64_t eventNanos = 0;
+    ResamplePointerHit(hit, sampleNanos, &moveX, &moveY, &eventNanos);
+
+    // Hysteresis is tuned on the nominal surface, so it covers the same
+    // physical distance on the panel at every surface scale.
+    double moveThreshold = config_.pointerMoveThresholdPx;
+    if (config_.filterPointerPose) {
+        const double surfaceScale =
+            static_cast<double>(flutterViews_[pointerView_]->metricsWidth) / static_cast<double>(kFlutterSurfaceWidth);
+        moveThreshold = std::max(moveThreshold, rightPointerFilter_.Tuning().hysteresisPixels * surfaceScale);
+    }
+    pointerEvents_.SetMoveThreshold(moveThreshold);
+
+    const int64_t heldButtons = pointerDown_ ? kFlutterPointerButtonMousePrimary : 0;
     if (pressedNow && !triggerPressed_) {
-        if (hit.onQuad && flutterEngine_ != nullptr) {
+        if (onPointerView && PointerEngineReachable()) {
             EnsureFlutterPointerAdded(hit.xPixels, hit.yPixels);
-            if (pointerAdded_ && SendFlutterPointerEvent(kDown, hit.xPixels, hit.yPixels, kFlutterPointerButtonMousePrimary)) {
-                pointerDown_ = true;
-            }
+            pointerEvents_.Add(kDown, hit.xPixels, hit.yPixels, kFlutterPointerButtonMousePrimary);
+            pointerDown_ = true;
         }
     } else if ((!pressedNow || !inputActive) && triggerPressed_) {
-        if (pointerDown_ && flutterEngine_ != nullptr) {
-            const double upX = hit.onQuad ? hit.xPixels : lastPointerX_;
-            const double upY = hit.onQuad ? hit.yPixels : lastPointerY_;
-            SendFlutterPointerEvent(kUp, upX, upY, 0);
+        if (pointerDown_ && PointerEngineReachable()) {
+            if (onPointerView) {
+                pointerEvents_.AddMove(moveX, moveY, heldButtons);
+            }
+            pointerEvents_.Add(kUp, pointerEvents_.LastX(), pointerEvents_.LastY(), 0);
             pointerDown_ = false;
         }
+    } else if (onPointerView && PointerEngineReachable()) {
+        EnsureFlutterPointerAdded(hit.xPixels, hit.yPixels);
+        pointerEvents_.AddMove(moveX, moveY, heldButtons);
     }
 
     triggerPressed_ = inputActive && pressedNow;
 
-    if (scrollVectorAction_ == XR_NULL_HANDLE || flutterEngine_ == nullptr) {
+    QueueFlutterScroll(hit, leftHit);
+    SubmitFlutterPointerEvents(eventNanos);
+}
+
+void FlutterXrApp::QueueFlutterScroll(const PointerHitResult& hit, const PointerHitResult& leftHit) {
+    if (scrollVectorAction_ == XR_NULL_HANDLE || !PointerEngineReachable()) {
         return;
     }
 
@@ -430,26 +601,39 @@ void FlutterXrApp::PollInput(XrTime predictedDisplayTime) {
         scrollAxisHandPath = leftHandPath_;
     }
 
-    const double scrollDeltaX = static_cast<double>(ApplyAxisDeadzone(scrollAxis.x)) * kScrollPixelsPerFrame;
-    const double scrollDeltaY = -static_cast<double>(ApplyAxisDeadzone(scrollAxis.y)) * kScrollPixelsPerFrame;
-    if (std::abs(scrollDeltaX) <= kScrollDeltaEpsilonPixels && std::abs(scrollDeltaY) <= kScrollDeltaEpsilonPixels) {
+    const float scrollAxisX = ApplyAxisDeadzone(scrollAxis.x);
+    const float scrollAxisY = ApplyAxisDeadzone(scrollAxis.y);
+    if (scrollAxisX == 0.0f && scrollAxisY == 0.0f) {
         return;
     }
 
+    // The scroll goes to the view under the scrolling hand, in that view's
+    // physical pixels.
     const PointerHitResult* scrollHit = SelectScrollHit(scrollAxisHandPath, leftHandPath_, hit, leftHit);
-    double scrollX = lastPointerX_;
-    double scrollY = lastPointerY_;
+    if (scrollHit != nullptr && !RouteFlutterPointer(*scrollHit)) {
+        scrollHit = nullptr;
+    }
+    const double scrollPixelsPerFrame = kScrollPixelsPerFrame * flutterViews_[pointerView_]->pixelRatio;
+    const double scrollDeltaX = static_cast<double>(scrollAxisX) * scrollPixelsPerFrame;
+    const double scrollDeltaY = -static_cast<double>(scrollAxisY) * scrollPixelsPerFrame;
+    if (std::abs(scrollDeltaX) <= kScrollDeltaEpsilonPixels && std::abs(scrollDeltaY) <= kScrollDeltaEpsilonPixels) {
+        return;
+    }
+
+    double scrollX = pointerEvents_.LastX();
+    double scrollY = pointerEvents_.LastY();
     if (scrollHit != nullptr) {
         scrollX = scrollHit->xPixels;
         scrollY = scrollHit->yPixels;
         EnsureFlutterPointerAdded(scrollX, scrollY);
-        if (pointerAdded_ && !pointerDown_) {
-            SendFlutterPointerEvent(kHover, scrollX, scrollY, 0);
+        if (!pointerDown_) {
+            pointerEvents_.AddMove(scrollX, scrollY, 0);
         }
     }
 
     if (pointerAdded_) {
-        SendFlutterScrollEvent(scrollX, scrollY, scrollDeltaX, scrollDeltaY);
+        const int64_t buttons = pointerDown_ ? kFlutterPointerButtonMousePrimary : 0;
+        pointerEvents_.AddScroll(scrollX, scrollY, scrollDeltaX, scrollDeltaY, buttons);
     }
 }
 
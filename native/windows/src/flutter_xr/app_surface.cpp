@@ -0,0 +1,328 @@
+#include "flutter_xr/app.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace flutter_xr {
+
+namespace {
+
+// A target away from the current scale level is freed once it has not been
+// active for this many frames, a few seconds at headset refresh rates.
+constexpr uint64_t kSurfaceTargetIdleUpdates = 600;
+
+bool SamePanelPlacement(const PanelGeometry& lhs, const PanelGeometry& rhs) {
+    const XrQuaternionf& a = lhs.pose.orientation;
+    const XrQuaternionf& b = rhs.pose.orientation;
+    const XrVector3f& p = lhs.pose.position;
+    const XrVector3f& q = rhs.pose.position;
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w && p.x == q.x && p.y == q.y && p.z == q.z &&
+           lhs.size.width == rhs.size.width && lhs.size.height == rhs.size.height;
+}
+
+}  // namespace
+
+std::unique_ptr<FlutterSurfaceTarget> FlutterXrApp::CreateFlutterSurfaceTarget(uint32_t width, uint32_t height) const {
+    // Only reads state fixed at startup, so it can also run off the render
+    // thread while frames keep flowing.
+    auto target = std::make_unique<FlutterSurfaceTarget>();
+    target->width = width;
+    target->height = height;
+
+    XrSwapchainCreateInfo swapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+    swapchainCreateInfo.createFlags = 0;
+    swapchainCreateInfo.usageFlags = XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+    swapchainCreateInfo.format = static_cast<int64_t>(colorFormat_);
+    swapchainCreateInfo.sampleCount = 1;
+    swapchainCreateInfo.width = width;
+    swapchainCreateInfo.height = height;
+    swapchainCreateInfo.faceCount = 1;
+    swapchainCreateInfo.arraySize = 1;
+    swapchainCreateInfo.mipCount = 1;
+
+    ThrowIfXrFailed(xrCreateSwapchain(session_, &swapchainCreateInfo, &target->swapchain), "xrCreateSwapchain", instance_);
+
+    uint32_t imageCount = 0;
+    ThrowIfXrFailed(xrEnumerateSwapchainImages(target->swapchain, 0, &imageCount, nullptr), "xrEnumerateSwapchainImages(count)",
+                    instance_);
+    if (imageCount == 0) {
+        xrDestroySwapchain(target->swapchain);
+        throw std::runtime_error("Runtime returned zero swapchain images.");
+    }
+
+    target->images.resize(imageCount, {XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR});
+    ThrowIfXrFailed(xrEnumerateSwapchainImages(target->swapchain, imageCount, &imageCount,
+                                               reinterpret_cast<XrSwapchainImageBaseHeader*>(target->images.data())),
+                    "xrEnumerateSwapchainImages(data)", instance_);
+
+    D3D11_TEXTURE2D_DESC desc{};
+    desc.Width = static_cast<UINT>(width);
+    desc.Height = static_cast<UINT>(height);
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = colorFormat_;
+    desc.SampleDesc.Count = 1;
+    desc.SampleDesc.Quality = 0;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = 0;
+    desc.CPUAccessFlags = 0;
+    desc.MiscFlags = 0;
+
+    const std::vector<uint32_t> initialPixels(static_cast<size_t>(width) * static_cast<size_t>(height), 0xFF101010u);
+    D3D11_SUBRESOURCE_DATA initialData{};
+    initialData.pSysMem = initialPixels.data();
+    initialData.SysMemPitch = static_cast<UINT>(width * sizeof(uint32_t));
+
+    const HRESULT hr = device_->CreateTexture2D(&desc, &initialData, target->texture.ReleaseAndGetAddressOf());
+    if (FAILED(hr)) {
+        xrDestroySwapchain(target->swapchain);
+    }
+    ThrowIfFailed(hr, "ID3D11Device::CreateTexture2D(flutterTexture)");
+    return target;
+}
+
+FlutterSurfaceTarget* FlutterXrApp::FindFlutterSurfaceTarget(const FlutterViewPanel& view,
+                                                             uint32_t width,
+                                                             uint32_t height) const {
+    for (const auto& target : view.surfaceTargets) {
+        if (target->width == width && target->height == height) {
+            return target.get();
+        }
+    }
+    return nullptr;
+}
+
+FlutterViewPanel* FlutterXrApp::FindFlutterView(size_t engineIndex, int64_t viewId) const {
+    for (const auto& view : flutterViews_) {
+        if (view->engine == engineIndex && view->viewId == viewId) {
+            return view.get();
+        }
+    }
+    return nullptr;
+}
+
+FlutterEngineResult FlutterXrApp::SendFlutterWindowMetrics(FlutterViewPanel& view,
+                                                           uint32_t width,
+                                                           uint32_t height,
+                                                           double pixelRatio) {
+    FlutterWindowMetricsEvent metrics{};
+    metrics.struct_size = sizeof(metrics);
+    metrics.width = width;
+    metrics.height = height;
+    metrics.pixel_ratio = pixelRatio;
+    metrics.view_id = view.viewId;
+    if (engineProcess_ != nullptr) {
+        if (!engineProcess_->SendWindowMetrics(metrics)) {
+            return kInternalInconsistency;
+        }
+    } else {
+        // Sent from the platform thread, as the embedder requires; failures
+        // are reported there.
+        FlutterEngineHost* host = flutterEngines_[view.engine].get();
+        platformTasks_.Post([host, metrics]() {
+            if (host->engine == nullptr) {
+                return;
+            }
+            const FlutterEngineResult result = FlutterEngineSendWindowMetricsEvent(host->engine, &metrics);
+            if (result != kSuccess) {
+                std::cerr << "[warn] FlutterEngineSendWindowMetricsEvent failed. view=" << metrics.view_id
+                          << " result=" << static_cast<int32_t>(result) << "\n";
+            }
+        });
+    }
+
+    // Pointer positions are physical pixels, so keep the last one on the
+    // same spot of the panel.
+    if (flutterViews_[pointerView_].get() == &view) {
+        const double scaleX = static_cast<double>(width) / static_cast<double>(view.metricsWidth);
+        const double scaleY = static_cast<double>(height) / static_cast<double>(view.metricsHeight);
+        pointerEvents_.ScalePosition(scaleX, scaleY);
+        pointerResampler_.ScalePositions(scaleX, scaleY);
+    }
+    view.metricsWidth = width;
+    view.metricsHeight = height;
+    view.pixelRatio = pixelRatio;
+    return kSuccess;
+}
+
+void FlutterXrApp::UpdateFlutterSurfaceScale(const XrFrameState& frameState) {
+    if (!config_.adaptiveResolution) {
+        return;
+    }
+
+    XrSpaceLocation viewLocation{XR_TYPE_SPACE_LOCATION};
+    const bool hasViewPosition =
+        viewSpace_ != XR_NULL_HANDLE &&
+        XR_SUCCEEDED(xrLocateSpace(viewSpace_, appSpace_, frameState.predictedDisplayTime, &viewLocation)) &&
+        (viewLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0;
+
+    // An engine rasterizes its views one after another within the same
+    // frame, so each view's budget check sees the raster time of all views of
+    // its engine. Engines have their own raster threads and are budgeted
+    // separately.
+    std::array<uint64_t, kMaxFlutterEngines> engineRasterNanos{};
+    for (const auto& view : flutterViews_) {
+        engineRasterNanos[view->engine] += view->rasterNanos.load(std::memory_order_relaxed);
+    }
+
+    const uint64_t frameBudgetNanos = static_cast<uint64_t>(std::max<XrDuration>(frameState.predictedDisplayPeriod, 0));
+    for (const auto& view : flutterViews_) {
+        if (!FlutterEngineReachable(view->engine)) {
+            continue;
+        }
+        float viewDistanceMeters = 0.0f;
+        if (hasViewPosition) {
+            const XrVector3f toPanel = Subtract(view->basePose.position, viewLocation.pose.position);
+            viewDistanceMeters = std::sqrt(Dot(toPanel, toPanel));
+        }
+        UpdateFlutterViewScale(*view, viewDistanceMeters, engineRasterNanos[view->engine], frameBudgetNanos);
+    }
+}
+
+void FlutterXrApp::UpdateFlutterViewScale(FlutterViewPanel& view,
+                                          float viewDistanceMeters,
+                                          uint64_t rasterNanos,
+                                          uint64_t frameBudgetNanos) {
+    if (view.pendingSurface.valid() && view.pendingSurface.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        try {
+            view.surfaceTargets.push_back(view.pendingSurface.get());
+            view.surfaceTargets.back()->lastActiveUpdate = view.surfaceScaleUpdates;
+        } catch (const std::exception& ex) {
+            std::cerr << "[warn] Failed to allocate Flutter surface: " << ex.what() << "\n";
+        }
+    }
+
+    ++view.surfaceScaleUpdates;
+    if (view.activeSurface != nullptr) {
+        view.activeSurface->lastActiveUpdate = view.surfaceScaleUpdates;
+    }
+    EvictIdleFlutterSurfaceTargets(view);
+
+    view.surfaceScale.Update(viewDistanceMeters, rasterNanos, frameBudgetNanos);
+
+    const size_t level = view.surfaceScale.Level();
+    const uint32_t width = SurfaceScaleController::ScaledWidth(level);
+    const uint32_t height = SurfaceScaleController::ScaledHeight(level);
+    if (width == view.metricsWidth && height == view.metricsHeight) {
+        return;
+    }
+
+    // Flutter is told about the new size only once a target for it exists,
+    // so every frame it produces has somewhere to go. Targets are kept for
+    // reuse and allocated off the render thread.
+    if (FindFlutterSurfaceTarget(view, width, height) == nullptr) {
+        if (!view.pendingSurface.valid()) {
+            view.pendingSurface =
+                std::async(std::launch::async, [this, width, height]() { return CreateFlutterSurfaceTarget(width, height); });
+        }
+        return;
+    }
+
+    // A view the engine does not know yet keeps its size until it is added.
+    if (!view.engineViewAdded.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    const FlutterEngineResult result =
+        SendFlutterWindowMetrics(view, width, height, SurfaceScaleController::kScaleLevels[level]);
+    if (result != kSuccess) {
+        std::cerr << "[warn] FlutterEngineSendWindowMetricsEvent failed. view=" << view.viewId
+                  << " result=" << static_cast<int32_t>(result) << "\n";
+        return;
+    }
+    std::cout << "Flutter view " << view.viewId << " resolution: " << width << "x" << height << " (scale "
+              << SurfaceScaleController::kScaleLevels[level] << ")\n";
+}
+
+void FlutterXrApp::EvictIdleFlutterSurfaceTargets(FlutterViewPanel& view) {
+    // Keep the active target, the one matching the size Flutter renders at,
+    // and the levels next to the current one so a viewer moving back and
+    // forth around a threshold does not reallocate. Every other level costs
+    // a swapchain plus a texture and is released once it has been idle.
+    const size_t level = view.surfaceScale.Level();
+    auto keep = [&](const FlutterSurfaceTarget& target) {
+        if (&target == view.activeSurface ||
+            view.surfaceScaleUpdates - target.lastActiveUpdate < kSurfaceTargetIdleUpdates ||
+            (target.width == view.metricsWidth && target.height == view.metricsHeight)) {
+            return true;
+        }
+        const size_t lastNeighbor = std::min(level + 1, SurfaceScaleController::MaxLevel());
+        for (size_t neighbor = level > 0 ? level - 1 : 0; neighbor <= lastNeighbor; ++neighbor) {
+            if (target.width == SurfaceScaleController::ScaledWidth(neighbor) &&
+                target.height == SurfaceScaleController::ScaledHeight(neighbor)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto evicted =
+        std::stable_partition(view.surfaceTargets.begin(), view.surfaceTargets.end(),
+                              [&](const std::unique_ptr<FlutterSurfaceTarget>& target) { return keep(*target); });
+    for (auto it = evicted; it != view.surfaceTargets.end(); ++it) {
+        std::cout << "Flutter view " << view.viewId << " released idle surface " << (*it)->width << "x" << (*it)->height
+                  << "\n";
+        if ((*it)->swapchain != XR_NULL_HANDLE) {
+            xrDestroySwapchain((*it)->swapchain);
+        }
+    }
+    view.surfaceTargets.erase(evicted, view.surfaceTargets.end());
+}
+
+void FlutterXrApp::UpdateFlutterPanelHitTester() {
+    // Called every frame, but only rebuilt when a panel is shown, hidden or
+    // moved, so pointer hit tests keep using cached world-to-panel
+    // transforms. Hidden panels and views the engine has not added are not hit.
+    size_t panel = 0;
+    bool changed = false;
+    for (size_t i = 0; i < flutterViews_.size() && !changed; ++i) {
+        const FlutterViewPanel& view = *flutterViews_[i];
+        if (view.panelVisible && view.engineViewAdded.load(std::memory_order_acquire)) {
+            changed = panel == flutterPanelHitViews_.size() || flutterPanelHitViews_[panel] != i ||
+                      !SamePanelPlacement(flutterPanelHitGeometry_[panel], view.geometry);
+            ++panel;
+        }
+    }
+    if (!changed && panel == flutterPanelHitViews_.size()) {
+        return;
+    }
+
+    flutterPanelHits_.Clear();
+    flutterPanelHitViews_.clear();
+    flutterPanelHitGeometry_.clear();
+    for (size_t i = 0; i < flutterViews_.size(); ++i) {
+        const FlutterViewPanel& view = *flutterViews_[i];
+        if (view.panelVisible && view.engineViewAdded.load(std::memory_order_acquire)) {
+            flutterPanelHits_.AddPanel(view.geometry.pose, view.geometry.size.width, view.geometry.size.height);
+            flutterPanelHitViews_.push_back(i);
+            flutterPanelHitGeometry_.push_back(view.geometry);
+        }
+    }
+}
+
+void FlutterXrApp::DestroyFlutterSurfaceTargets() {
+    for (const auto& view : flutterViews_) {
+        if (view->pendingSurface.valid()) {
+            try {
+                view->surfaceTargets.push_back(view->pendingSurface.get());
+            } catch (const std::exception&) {
+            }
+        }
+
+        for (const auto& target : view->surfaceTargets) {
+            if (target->swapchain != XR_NULL_HANDLE) {
+                xrDestroySwapchain(target->swapchain);
+            }
+        }
+        view->surfaceTargets.clear();
+        view->activeSurface = nullptr;
+    }
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,298 @@
+#include "flutter_xr/dirty_region.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLUTTER_XR_TILE_HASH_SSE2 1
+#endif
+
+namespace flutter_xr {
+
+namespace {
+
+// Per-lane starting key and per-chunk key step. The key advances for every
+// 16-byte chunk of a tile so identical chunks at different positions (for
+// example two swapped rows) still hash differently.
+constexpr uint64_t kTileHashKey0 = 0x1cad21f72c81017cull;
+constexpr uint64_t kTileHashKey1 = 0xbe4ba423396cfeb8ull;
+constexpr uint64_t kTileHashStep0 = 0x9e3779b97f4a7c15ull;
+constexpr uint64_t kTileHashStep1 = 0xc2b2ae3d27d4eb4full;
+
+uint64_t RotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t Avalanche(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+#if defined(FLUTTER_XR_TILE_HASH_SSE2)
+
+struct TileHashState {
+    __m128i acc = _mm_setzero_si128();
+    __m128i key = _mm_set_epi64x(static_cast<long long>(kTileHashKey1), static_cast<long long>(kTileHashKey0));
+    const __m128i step = _mm_set_epi64x(static_cast<long long>(kTileHashStep1), static_cast<long long>(kTileHashStep0));
+
+    void Accumulate(const uint8_t* chunk) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chunk));
+        const __m128i dataKey = _mm_xor_si128(data, key);
+        const __m128i dataKeyHigh = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i product = _mm_mul_epu32(dataKey, dataKeyHigh);
+        const __m128i dataSwap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+        acc = _mm_add_epi64(acc, _mm_add_epi64(product, dataSwap));
+        key = _mm_add_epi64(key, step);
+    }
+
+    uint64_t Lane(int index) const {
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        return lanes[index];
+    }
+};
+
+#else
+
+struct TileHashState {
+    uint64_t acc[2] = {0, 0};
+    uint64_t key[2] = {kTileHashKey0, kTileHashKey1};
+
+    void Accumulate(const uint8_t* chunk) {
+        uint64_t data[2];
+        std::memcpy(data, chunk, sizeof(data));
+        uint64_t product[2];
+        for (int lane = 0; lane < 2; ++lane) {
+            const uint64_t dataKey = data[lane] ^ key[lane];
+            product[lane] = (dataKey & 0xffffffffull) * (dataKey >> 32);
+        }
+        acc[0] += product[0] + data[1];
+        acc[1] += product[1] + data[0];
+        key[0] += kTileHashStep0;
+        key[1] += kTileHashStep1;
+    }
+
+    uint64_t Lane(int index) const { return acc[index]; }
+};
+
+#endif
+
+// Column range [first, last] of pixels with non-zero alpha in one row, or
+// false when the whole row is transparent.
+bool FindOpaqueColumns(const uint32_t* row, uint32_t width, uint32_t* outFirst, uint32_t* outLast) {
+    uint32_t first = 0;
+#if defined(FLUTTER_XR_TILE_HASH_SSE2)
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xff000000u));
+    const __m128i zero = _mm_setzero_si128();
+    auto transparentMask = [&](uint32_t x) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+        return _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), zero));
+    };
+    while (first + 4 <= width && transparentMask(first) == 0xffff) {
+        first += 4;
+    }
+#endif
+    while (first < width && (row[first] & 0xff000000u) == 0) {
+        ++first;
+    }
+    if (first == width) {
+        return false;
+    }
+
+    uint32_t end = width;
+#if defined(FLUTTER_XR_TILE_HASH_SSE2)
+    while (end >= first + 4 && transparentMask(end - 4) == 0xffff) {
+        end -= 4;
+    }
+#endif
+    while ((row[end - 1] & 0xff000000u) == 0) {
+        --end;
+    }
+
+    *outFirst = first;
+    *outLast = end - 1;
+    return true;
+}
+
+}  // namespace
+
+uint64_t HashPixelTile(const uint8_t* pixels, size_t rowBytes, size_t tileRowBytes, size_t tileRows) {
+    TileHashState state;
+    const size_t fullChunkBytes = tileRowBytes & ~static_cast<size_t>(15);
+    const size_t tailBytes = tileRowBytes - fullChunkBytes;
+
+    for (size_t row = 0; row < tileRows; ++row) {
+        const uint8_t* src = pixels + row * rowBytes;
+        for (size_t offset = 0; offset < fullChunkBytes; offset += 16) {
+            state.Accumulate(src + offset);
+        }
+        if (tailBytes != 0) {
+            uint8_t tail[16] = {};
+            std::memcpy(tail, src + fullChunkBytes, tailBytes);
+            state.Accumulate(tail);
+        }
+    }
+
+    const uint64_t combined = state.Lane(0) ^ RotateLeft(state.Lane(1), 29) ^ (tileRowBytes * tileRows);
+    return Avalanche(combined);
+}
+
+bool FindContentBounds(const uint8_t* pixels, size_t rowBytes, uint32_t width, uint32_t height, DirtyRect* outBounds) {
+    if (pixels == nullptr || outBounds == nullptr || width == 0 || height == 0 || rowBytes < static_cast<size_t>(width) * 4) {
+        return false;
+    }
+
+    uint32_t minX = width;
+    uint32_t maxX = 0;
+    uint32_t minY = height;
+    uint32_t maxY = 0;
+    for (uint32_t y = 0; y < height; ++y) {
+        // Rows are 4-byte aligned in every surface the runner produces.
+        const auto* row = reinterpret_cast<const uint32_t*>(pixels + static_cast<size_t>(y) * rowBytes);
+        uint32_t first = 0;
+        uint32_t last = 0;
+        if (!FindOpaqueColumns(row, width, &first, &last)) {
+            continue;
+        }
+        minX = std::min(minX, first);
+        maxX = std::max(maxX, last);
+        minY = std::min(minY, y);
+        maxY = y;
+    }
+
+    if (minY == height) {
+        return false;
+    }
+    outBounds->x = minX;
+    outBounds->y = minY;
+    outBounds->width = maxX - minX + 1;
+    outBounds->height = maxY - minY + 1;
+    return true;
+}
+
+TileChangeDetector::TileChangeDetector(uint32_t tileSize) : tileSize_(std::max<uint32_t>(tileSize, 1)) {}
+
+void TileChangeDetector::Reset() {
+    hasPreviousFrame_ = false;
+    std::fill(staleTiles_.begin(), staleTiles_.end(), 0);
+}
+
+const std::vector<DirtyRect>& TileChangeDetector::Update(const uint8_t* pixels,
+                                                         size_t rowBytes,
+                                                         uint32_t width,
+                                                         uint32_t height,
+                                                         const DirtyRect* visibleBounds) {
+    dirtyRects_.clear();
+    if (pixels == nullptr || width == 0 || height == 0 || rowBytes < static_cast<size_t>(width) * 4) {
+        hasPreviousFrame_ = false;
+        return dirtyRects_;
+    }
+
+    if (width != width_ || height != height_) {
+        width_ = width;
+        height_ = height;
+        tilesX_ = (width + tileSize_ - 1) / tileSize_;
+        tilesY_ = (height + tileSize_ - 1) / tileSize_;
+        tileHashes_.assign(static_cast<size_t>(tilesX_) * tilesY_, 0);
+        dirtyTiles_.assign(tileHashes_.size(), 0);
+        staleTiles_.assign(tileHashes_.size(), 0);
+        hasPreviousFrame_ = false;
+    }
+
+    bool anyDirty = false;
+    for (uint32_t ty = 0; ty < tilesY_; ++ty) {
+        const uint32_t y0 = ty * tileSize_;
+        const uint32_t rows = std::min(tileSize_, height_ - y0);
+        for (uint32_t tx = 0; tx < tilesX_; ++tx) {
+            const uint32_t x0 = tx * tileSize_;
+            const uint32_t columns = std::min(tileSize_, width_ - x0);
+            const size_t tileIndex = static_cast<size_t>(ty) * tilesX_ + tx;
+
+            const uint64_t hash = HashPixelTile(pixels + static_cast<size_t>(y0) * rowBytes + static_cast<size_t>(x0) * 4,
+                                                rowBytes, static_cast<size_t>(columns) * 4, rows);
+            bool dirty = !hasPreviousFrame_ || hash != tileHashes_[tileIndex];
+            tileHashes_[tileIndex] = hash;
+
+            const bool visible = visibleBounds == nullptr ||
+                                 (x0 < visibleBounds->x + visibleBounds->width && visibleBounds->x < x0 + columns &&
+                                  y0 < visibleBounds->y + visibleBounds->height && visibleBounds->y < y0 + rows);
+            if (!visible) {
+                staleTiles_[tileIndex] = staleTiles_[tileIndex] != 0 || dirty ? 1 : 0;
+                dirty = false;
+            } else if (staleTiles_[tileIndex] != 0) {
+                staleTiles_[tileIndex] = 0;
+                dirty = true;
+            }
+            dirtyTiles_[tileIndex] = dirty ? 1 : 0;
+            anyDirty = anyDirty || dirty;
+        }
+    }
+    hasPreviousFrame_ = true;
+
+    if (anyDirty) {
+        MergeDirtyTiles();
+    }
+    return dirtyRects_;
+}
+
+void TileChangeDetector::MergeDirtyTiles() {
+    // Horizontal runs of dirty tiles become spans; a span extends the rect
+    // from the row above when both cover exactly the same tile columns.
+    struct TileRect {
+        uint32_t x0;
+        uint32_t x1;
+        uint32_t y0;
+        uint32_t y1;
+    };
+    std::vector<TileRect> rects;
+
+    for (uint32_t ty = 0; ty < tilesY_; ++ty) {
+        uint32_t tx = 0;
+        while (tx < tilesX_) {
+            if (dirtyTiles_[static_cast<size_t>(ty) * tilesX_ + tx] == 0) {
+                ++tx;
+                continue;
+            }
+            const uint32_t runStart = tx;
+            while (tx < tilesX_ && dirtyTiles_[static_cast<size_t>(ty) * tilesX_ + tx] != 0) {
+                ++tx;
+            }
+
+            auto open = std::find_if(rects.begin(), rects.end(), [&](const TileRect& rect) {
+                return rect.y1 == ty && rect.x0 == runStart && rect.x1 == tx;
+            });
+            if (open != rects.end()) {
+                open->y1 = ty + 1;
+            } else {
+                rects.push_back({runStart, tx, ty, ty + 1});
+            }
+        }
+    }
+
+    if (rects.size() > kMaxDirtyRects) {
+        TileRect bounds = rects.front();
+        for (const TileRect& rect : rects) {
+            bounds.x0 = std::min(bounds.x0, rect.x0);
+            bounds.x1 = std::max(bounds.x1, rect.x1);
+            bounds.y0 = std::min(bounds.y0, rect.y0);
+            bounds.y1 = std::max(bounds.y1, rect.y1);
+        }
+        rects.assign(1, bounds);
+    }
+
+    for (const TileRect& rect : rects) {
+        DirtyRect out;
+        out.x = rect.x0 * tileSize_;
+        out.y = rect.y0 * tileSize_;
+        out.width = std::min(rect.x1 * tileSize_, width_) - out.x;
+        out.height = std::min(rect.y1 * tileSize_, height_) - out.y;
+        dirtyRects_.push_back(out);
+    }
+}
+
+}  // namespace flutter_xr
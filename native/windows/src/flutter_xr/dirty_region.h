@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_xr {
+
+struct DirtyRect {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// Finds the parts of a 32-bit pixel surface that changed since the previous
+// call by hashing fixed-size tiles and comparing them with the hashes kept
+// from the last frame. Changed tiles are merged into a short list of
+// rectangles suitable for partial texture uploads.
+class TileChangeDetector {
+   public:
+    static constexpr uint32_t kDefaultTileSize = 64;
+    static constexpr size_t kMaxDirtyRects = 32;
+
+    explicit TileChangeDetector(uint32_t tileSize = kDefaultTileSize);
+
+    // Returns the dirty rectangles of `pixels` relative to the previous call.
+    // The whole surface is reported after Reset() or a size change, and an
+    // empty list means the frame is identical to the previous one.
+    //
+    // When `visibleBounds` is given, changed tiles entirely outside it are
+    // not reported. They are remembered as stale and reported once the
+    // bounds grow to cover them again.
+    const std::vector<DirtyRect>& Update(const uint8_t* pixels,
+                                         size_t rowBytes,
+                                         uint32_t width,
+                                         uint32_t height,
+                                         const DirtyRect* visibleBounds = nullptr);
+    void Reset();
+
+    uint32_t TileSize() const { return tileSize_; }
+
+   private:
+    void MergeDirtyTiles();
+
+    uint32_t tileSize_ = kDefaultTileSize;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    uint32_t tilesX_ = 0;
+    uint32_t tilesY_ = 0;
+    bool hasPreviousFrame_ = false;
+    std::vector<uint64_t> tileHashes_;
+    std::vector<uint8_t> dirtyTiles_;
+    std::vector<uint8_t> staleTiles_;
+    std::vector<DirtyRect> dirtyRects_;
+};
+
+uint64_t HashPixelTile(const uint8_t* pixels, size_t rowBytes, size_t tileRowBytes, size_t tileRows);
+
+// Computes the bounding box of pixels with non-zero alpha in a 32-bit RGBA
+// surface. Returns false when every pixel is fully transparent.
+bool FindContentBounds(const uint8_t* pixels, size_t rowBytes, uint32_t width, uint32_t height, DirtyRect* outBounds);
+
+}  // namespace flutter_xr
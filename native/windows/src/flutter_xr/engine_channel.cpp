@@ -0,0 +1,326 @@
+#include "flutter_xr/engine_channel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace flutter_xr {
+
+namespace {
+
+constexpr uint32_t kChannelMagic = 0x43525846;  // "FXRC"
+constexpr uint32_t kChannelLayoutVersion = 2;
+constexpr uint32_t kIndexMask = 0x3u;
+constexpr uint32_t kFreshBit = 0x4u;
+constexpr size_t kPageBytes = 4096;
+constexpr auto kRingSettleTimeout = std::chrono::seconds(1);
+// Bounds how long a producer flipping pendingState can hold up the consumer.
+constexpr int kMaxAcquireAttempts = 8;
+
+size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Divides instead of multiplying so sizes from the other process cannot
+// overflow past the check.
+bool FrameFits(uint64_t rowBytes, uint64_t width, uint64_t height, uint64_t capacityBytes) {
+    return height != 0 && width <= rowBytes / 4 && rowBytes <= capacityBytes / height;
+}
+
+}  // namespace
+
+struct SharedFrameSlotHeader {
+    uint64_t sequence = 0;
+    uint64_t rowBytes = 0;
+    uint64_t width = 0;
+    uint64_t height = 0;
+    uint64_t publishNanos = 0;
+    uint64_t rasterNanos = 0;
+};
+
+// Head and tail sit on separate cache lines so the two processes do not
+// bounce one line between them on every message.
+struct SharedQueueState {
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+};
+
+struct SharedChannelHeader {
+    uint32_t magic = kChannelMagic;
+    uint32_t layoutVersion = kChannelLayoutVersion;
+    uint32_t messageBytes = sizeof(EngineMessage);
+    uint64_t frameCapacityBytes = 0;
+    uint64_t slotStrideBytes = 0;
+    uint64_t toEngineOffset = 0;
+    uint64_t fromEngineOffset = 0;
+    uint64_t pixelsOffset = 0;
+    uint64_t mappedBytes = 0;
+
+    // Frame ring state, as in FrameMailbox. The consumer also publishes the
+    // slot it holds so a restarted producer can find the free one.
+    alignas(64) std::atomic<uint32_t> pendingState{2};
+    std::atomic<uint32_t> consumerIndex{1};
+    std::atomic<uint64_t> publishedCount{0};
+    SharedFrameSlotHeader slots[SharedFrameRing::kSlotCount];
+
+    SharedQueueState toEngine;
+    SharedQueueState fromEngine;
+
+    // Futex words on Linux; Windows signals through named events instead.
+    SharedSignalWord frameSignal;
+    SharedSignalWord toEngineSignal;
+    SharedSignalWord fromEngineSignal;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "Shared-memory atomics must be lock-free to work across processes");
+
+uint64_t SteadyClockNanos() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+SharedFrameRing::SharedFrameRing(SharedChannelHeader* header,
+                                 uint8_t* pixels,
+                                 size_t capacityBytes,
+                                 size_t slotStrideBytes,
+                                 SharedSignal* frameSignal)
+    : header_(header),
+      pixels_(pixels),
+      capacityBytes_(capacityBytes),
+      slotStrideBytes_(slotStrideBytes),
+      frameSignal_(frameSignal) {
+    // A restarted producer can start while the consumer takes its
+    // predecessor's last frame, which swaps pendingState first and stores
+    // consumerIndex after. The producer's slot is the one neither names and
+    // does not move in that swap, so any pair read between the two stores
+    // gives it; a pair read across them names one slot twice.
+    const auto deadline = std::chrono::steady_clock::now() + kRingSettleTimeout;
+    for (;;) {
+        const uint32_t pending = header_->pendingState.load(std::memory_order_acquire) & kIndexMask;
+        const uint32_t consumer = header_->consumerIndex.load(std::memory_order_acquire);
+        if (pending < kSlotCount && consumer < kSlotCount && pending != consumer &&
+            (header_->pendingState.load(std::memory_order_acquire) & kIndexMask) == pending) {
+            readIndex_ = consumer;
+            writeIndex_ = 3u - pending - consumer;
+            break;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            throw std::runtime_error("Engine channel frame ring state is inconsistent");
+        }
+        std::this_thread::yield();
+    }
+    lastSequence_ = header_->publishedCount.load(std::memory_order_acquire);
+}
+
+size_t SharedFrameRing::CapacityBytes() const {
+    return capacityBytes_;
+}
+
+uint8_t* SharedFrameRing::BeginWrite(size_t rowBytes, size_t width, size_t height) {
+    if (!FrameFits(rowBytes, width, height, capacityBytes_)) {
+        return nullptr;
+    }
+
+    SharedFrameSlotHeader& slot = header_->slots[writeIndex_];
+    slot.rowBytes = rowBytes;
+    slot.width = width;
+    slot.height = height;
+    return pixels_ + writeIndex_ * slotStrideBytes_;
+}
+
+void SharedFrameRing::Publish(uint64_t rasterNanos) {
+    const uint64_t sequence = header_->publishedCount.load(std::memory_order_relaxed) + 1;
+    SharedFrameSlotHeader& slot = header_->slots[writeIndex_];
+    slot.sequence = sequence;
+    slot.publishNanos = SteadyClockNanos();
+    slot.rasterNanos = rasterNanos;
+
+    const uint32_t previous = header_->pendingState.exchange(writeIndex_ | kFreshBit, std::memory_order_acq_rel);
+    writeIndex_ = previous & kIndexMask;
+    header_->publishedCount.store(sequence, std::memory_order_release);
+    frameSignal_->Set();
+}
+
+bool SharedFrameRing::AcquireLatest(SharedFrame* outFrame) {
+    if ((header_->pendingState.load(std::memory_order_relaxed) & kFreshBit) == 0) {
+        return false;
+    }
+
+    // Everything the producer wrote is checked against what this process
+    // knows before it is used to index or size a read of the mapping. The
+    // swap only goes through for a valid index, so the slot held here is
+    // never handed to the producer while it is still being read.
+    uint32_t state = header_->pendingState.load(std::memory_order_acquire);
+    for (int attempt = 0;; ++attempt) {
+        if ((state & kFreshBit) == 0) {
+            return false;
+        }
+        if (attempt == kMaxAcquireAttempts) {
+            ++rejectedFrames_;
+            return false;
+        }
+        const uint32_t index = state & kIndexMask;
+        if (index >= kSlotCount || index == readIndex_) {
+            // Put back a slot other than the held one, not marked fresh.
+            if (header_->pendingState.compare_exchange_weak(state, (readIndex_ + 1) % kSlotCount,
+                                                            std::memory_order_acq_rel, std::memory_order_acquire)) {
+                ++rejectedFrames_;
+                return false;
+            }
+            continue;
+        }
+        if (header_->pendingState.compare_exchange_weak(state, readIndex_, std::memory_order_acq_rel,
+                                                        std::memory_order_acquire)) {
+            readIndex_ = index;
+            break;
+        }
+    }
+    header_->consumerIndex.store(readIndex_, std::memory_order_release);
+
+    // A local copy, so the producer cannot change the size after the check.
+    const SharedFrameSlotHeader slot = header_->slots[readIndex_];
+    if (!FrameFits(slot.rowBytes, slot.width, slot.height, capacityBytes_)) {
+        ++rejectedFrames_;
+        return false;
+    }
+    if (slot.sequence > lastSequence_ + 1) {
+        skippedFrames_ += slot.sequence - lastSequence_ - 1;
+    }
+    lastSequence_ = slot.sequence;
+
+    outFrame->pixels = pixels_ + readIndex_ * slotStrideBytes_;
+    outFrame->rowBytes = static_cast<size_t>(slot.rowBytes);
+    outFrame->width = static_cast<size_t>(slot.width);
+    outFrame->height = static_cast<size_t>(slot.height);
+    outFrame->sequence = slot.sequence;
+    outFrame->publishNanos = slot.publishNanos;
+    outFrame->rasterNanos = slot.rasterNanos;
+    return true;
+}
+
+bool SharedFrameRing::WaitForFrame(uint32_t timeoutMs) const {
+    return frameSignal_->Wait(timeoutMs);
+}
+
+uint64_t SharedFrameRing::PublishedFrameCount() const {
+    return header_->publishedCount.load(std::memory_order_acquire);
+}
+
+SharedMessageQueue::SharedMessageQueue(SharedQueueState* state, EngineMessage* records, SharedSignal* signal)
+    : state_(state), records_(records), signal_(signal) {}
+
+bool SharedMessageQueue::Push(EngineMessageType type,
+                              uint32_t generation,
+                              uint64_t id,
+                              const void* payload,
+                              size_t size,
+                              uint64_t timestampNanos) {
+    if (size > kEngineMessagePayloadBytes) {
+        return false;
+    }
+
+    const uint32_t tail = state_->tail.load(std::memory_order_relaxed);
+    if (tail - state_->head.load(std::memory_order_acquire) >= kEngineMessageQueueCapacity) {
+        return false;
+    }
+
+    EngineMessage& record = records_[tail % kEngineMessageQueueCapacity];
+    record.type = type;
+    record.size = static_cast<uint32_t>(size);
+    record.generation = generation;
+    record.id = id;
+    record.timestampNanos = timestampNanos;
+    if (size > 0) {
+        std::memcpy(record.payload, payload, size);
+    }
+    state_->tail.store(tail + 1, std::memory_order_release);
+    signal_->Set();
+    return true;
+}
+
+bool SharedMessageQueue::Pop(EngineMessage* outMessage) {
+    const uint32_t head = state_->head.load(std::memory_order_relaxed);
+    if (head == state_->tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    // The other process may be misbehaving, so sizes are not trusted.
+    const EngineMessage& record = records_[head % kEngineMessageQueueCapacity];
+    outMessage->type = record.type;
+    outMessage->size = std::min<uint32_t>(record.size, static_cast<uint32_t>(kEngineMessagePayloadBytes));
+    outMessage->generation = record.generation;
+    outMessage->id = record.id;
+    outMessage->timestampNanos = record.timestampNanos;
+    std::memcpy(outMessage->payload, record.payload, outMessage->size);
+    state_->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+std::unique_ptr<EngineChannel> EngineChannel::Create(const std::string& name, size_t frameCapacityBytes) {
+    // Header, both message queues, then page-aligned pixel slots.
+    const size_t toEngineOffset = AlignUp(sizeof(SharedChannelHeader), 64);
+    const size_t fromEngineOffset = toEngineOffset + sizeof(EngineMessage) * kEngineMessageQueueCapacity;
+    const size_t pixelsOffset =
+        AlignUp(fromEngineOffset + sizeof(EngineMessage) * kEngineMessageQueueCapacity, kPageBytes);
+    const size_t slotStrideBytes = AlignUp(frameCapacityBytes, kPageBytes);
+    const size_t mappedBytes = pixelsOffset + slotStrideBytes * SharedFrameRing::kSlotCount;
+
+    std::unique_ptr<EngineChannel> channel(new EngineChannel());
+    channel->memory_ = SharedMemoryMapping::Create(name, mappedBytes);
+
+    auto* header = new (channel->memory_->Data()) SharedChannelHeader();
+    header->frameCapacityBytes = frameCapacityBytes;
+    header->slotStrideBytes = slotStrideBytes;
+    header->toEngineOffset = toEngineOffset;
+    header->fromEngineOffset = fromEngineOffset;
+    header->pixelsOffset = pixelsOffset;
+    header->mappedBytes = mappedBytes;
+
+    channel->frameSignal_ = SharedSignal::Create(name + "_frame", &header->frameSignal);
+    channel->toEngineSignal_ = SharedSignal::Create(name + "_to_engine", &header->toEngineSignal);
+    channel->fromEngineSignal_ = SharedSignal::Create(name + "_from_engine", &header->fromEngineSignal);
+    channel->MapViews(mappedBytes, frameCapacityBytes, slotStrideBytes);
+    return channel;
+}
+
+std::unique_ptr<EngineChannel> EngineChannel::Open(const std::string& name) {
+    std::unique_ptr<EngineChannel> channel(new EngineChannel());
+    channel->memory_ = SharedMemoryMapping::Open(name);
+
+    auto* header = static_cast<SharedChannelHeader*>(channel->memory_->Data());
+    if (channel->memory_->Size() < sizeof(SharedChannelHeader) || header->magic != kChannelMagic ||
+        header->layoutVersion != kChannelLayoutVersion || header->messageBytes != sizeof(EngineMessage) ||
+        header->mappedBytes > channel->memory_->Size() || header->frameCapacityBytes > header->slotStrideBytes ||
+        header->pixelsOffset > header->mappedBytes ||
+        header->slotStrideBytes > (header->mappedBytes - header->pixelsOffset) / SharedFrameRing::kSlotCount) {
+        throw std::runtime_error("Engine channel " + name + " was created by a different runner build");
+    }
+
+    channel->frameSignal_ = SharedSignal::Open(name + "_frame", &header->frameSignal);
+    channel->toEngineSignal_ = SharedSignal::Open(name + "_to_engine", &header->toEngineSignal);
+    channel->fromEngineSignal_ = SharedSignal::Open(name + "_from_engine", &header->fromEngineSignal);
+    channel->MapViews(static_cast<size_t>(header->mappedBytes), static_cast<size_t>(header->frameCapacityBytes),
+                      static_cast<size_t>(header->slotStrideBytes));
+    return channel;
+}
+
+EngineChannel::~EngineChannel() = default;
+
+void EngineChannel::MapViews(size_t mappedBytes, size_t frameCapacityBytes, size_t slotStrideBytes) {
+    mappedBytes_ = mappedBytes;
+    auto* base = static_cast<uint8_t*>(memory_->Data());
+    auto* header = static_cast<SharedChannelHeader*>(memory_->Data());
+    frames_ = std::make_unique<SharedFrameRing>(header, base + header->pixelsOffset, frameCapacityBytes,
+                                                slotStrideBytes, frameSignal_.get());
+    toEngine_ = std::make_unique<SharedMessageQueue>(
+        &header->toEngine, reinterpret_cast<EngineMessage*>(base + header->toEngineOffset), toEngineSignal_.get());
+    fromEngine_ = std::make_unique<SharedMessageQueue>(
+        &header->fromEngine, reinterpret_cast<EngineMessage*>(base + header->fromEngineOffset), fromEngineSignal_.get());
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "flutter_xr/shared_memory.h"
+
+namespace flutter_xr {
+
+inline constexpr size_t kEngineMessagePayloadBytes = 4096;
+inline constexpr uint32_t kEngineMessageQueueCapacity = 64;
+
+enum class EngineMessageType : uint32_t {
+    // Runner to engine.
+    PointerEvents,     // FlutterPointerEvent array
+    WindowMetrics,     // FlutterWindowMetricsEvent
+    PlatformResponse,  // response bytes for the message `id`
+    Ping,
+    Shutdown,
+    // Engine to runner.
+    PlatformMessage,   // channel name, '\0', message bytes
+    Pong,
+};
+
+// Fixed-size queue record. Only the first `size` payload bytes are copied.
+struct EngineMessage {
+    EngineMessageType type = EngineMessageType::Ping;
+    uint32_t size = 0;
+    // Engine process generation the message belongs to, so responses to a
+    // process that was restarted are not delivered to its successor.
+    uint32_t generation = 0;
+    uint64_t id = 0;
+    uint64_t timestampNanos = 0;
+    uint8_t payload[kEngineMessagePayloadBytes];
+};
+
+struct SharedChannelHeader;
+struct SharedQueueState;
+
+// Newest frame handed out by SharedFrameRing::AcquireLatest. `pixels` points
+// into the shared mapping and stays valid until the next acquire.
+struct SharedFrame {
+    const uint8_t* pixels = nullptr;
+    size_t rowBytes = 0;
+    size_t width = 0;
+    size_t height = 0;
+    uint64_t sequence = 0;
+    // Producer's steady clock when the frame was published.
+    uint64_t publishNanos = 0;
+    uint64_t rasterNanos = 0;
+};
+
+// FrameMailbox's triple buffer laid out in shared memory: the producer
+// process writes into one slot, the consumer reads another and the third
+// holds the newest published frame. Slots carry sequence numbers so the
+// consumer can tell how many frames it never saw.
+class SharedFrameRing {
+   public:
+    static constexpr uint32_t kSlotCount = 3;
+
+    // `capacityBytes` and `slotStrideBytes` are kept here rather than read
+    // back from the header, which the other process can overwrite.
+    SharedFrameRing(SharedChannelHeader* header,
+                    uint8_t* pixels,
+                    size_t capacityBytes,
+                    size_t slotStrideBytes,
+                    SharedSignal* frameSignal);
+
+    size_t CapacityBytes() const;
+
+    // Producer side. Returns nullptr when the frame does not fit the slots.
+    uint8_t* BeginWrite(size_t rowBytes, size_t width, size_t height);
+    void Publish(uint64_t rasterNanos);
+
+    // Consumer side. Returns false when nothing was published since the
+    // previous call, or when the producer published a slot index or frame
+    // size that does not fit the ring; such frames are counted and dropped.
+    bool AcquireLatest(SharedFrame* outFrame);
+    bool WaitForFrame(uint32_t timeoutMs) const;
+
+    uint64_t PublishedFrameCount() const;
+    uint64_t SkippedFrameCount() const { return skippedFrames_; }
+    uint64_t RejectedFrameCount() const { return rejectedFrames_; }
+
+   private:
+    SharedChannelHeader* header_;
+    uint8_t* pixels_;
+    size_t capacityBytes_;
+    size_t slotStrideBytes_;
+    SharedSignal* frameSignal_;
+    uint32_t writeIndex_ = 0;
+    uint32_t readIndex_ = 1;
+    uint64_t lastSequence_ = 0;
+    uint64_t skippedFrames_ = 0;
+    uint64_t rejectedFrames_ = 0;
+};
+
+// Lock-free single-producer/single-consumer queue of EngineMessage records
+// in shared memory. Push sets a signal the consumer waits on.
+class SharedMessageQueue {
+   public:
+    SharedMessageQueue(SharedQueueState* state, EngineMessage* records, SharedSignal* signal);
+
+    // Returns false when the queue is full or the payload is too large.
+    bool Push(EngineMessageType type, uint32_t generation, uint64_t id, const void* payload, size_t size,
+              uint64_t timestampNanos = 0);
+    bool Pop(EngineMessage* outMessage);
+
+    SharedSignal& Signal() const { return *signal_; }
+
+   private:
+    SharedQueueState* state_;
+    EngineMessage* records_;
+    SharedSignal* signal_;
+};
+
+// Named shared-memory mapping and signals connecting the runner with an
+// engine process: one frame ring from the engine and a message queue in
+// each direction.
+class EngineChannel {
+   public:
+    // Runner side. Throws std::runtime_error when the mapping or signals
+    // cannot be created.
+    static std::unique_ptr<EngineChannel> Create(const std::string& name, size_t frameCapacityBytes);
+    // Engine side. Throws std::runtime_error when the channel does not exist
+    // or was made by a different runner build.
+    static std::unique_ptr<EngineChannel> Open(const std::string& name);
+
+    ~EngineChannel();
+
+    EngineChannel(const EngineChannel&) = delete;
+    EngineChannel& operator=(const EngineChannel&) = delete;
+
+    SharedFrameRing& Frames() { return *frames_; }
+    SharedMessageQueue& ToEngine() { return *toEngine_; }
+    SharedMessageQueue& FromEngine() { return *fromEngine_; }
+    size_t MappedBytes() const { return mappedBytes_; }
+
+   private:
+    EngineChannel() = default;
+    void MapViews(size_t mappedBytes, size_t frameCapacityBytes, size_t slotStrideBytes);
+
+    std::unique_ptr<SharedMemoryMapping> memory_;
+    size_t mappedBytes_ = 0;
+    std::unique_ptr<SharedSignal> frameSignal_;
+    std::unique_ptr<SharedSignal> toEngineSignal_;
+    std::unique_ptr<SharedSignal> fromEngineSignal_;
+    std::unique_ptr<SharedFrameRing> frames_;
+    std::unique_ptr<SharedMessageQueue> toEngine_;
+    std::unique_ptr<SharedMessageQueue> fromEngine_;
+};
+
+uint64_t SteadyClockNanos();
+
+}  // namespace flutter_xr
@@ -0,0 +1,351 @@
+#include "flutter_xr/engine_child.h"
+
+#include <windows.h>
+
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "flutter_embedder.h"
+#include "flutter_xr/engine_channel.h"
+#include "flutter_xr/flutter_bundle.h"
+#include "flutter_xr/platform_task_runner.h"
+#include "flutter_xr/pointer_events.h"
+#include "flutter_xr/shared.h"
+
+namespace flutter_xr {
+
+namespace {
+
+void ReleaseHeapBackingStore(void* user_data) {
+    delete[] static_cast<uint8_t*>(user_data);
+}
+
+void ReleaseRingBackingStore(void* /*user_data*/) {}
+
+// Runs one engine whose only view is the implicit one. The raster thread
+// writes frames into the channel's frame ring, the platform thread forwards
+// platform messages, and the main thread serves the runner's messages.
+class EngineChild {
+   public:
+    EngineChild(const RunnerConfig& config, EngineChannel& channel) : config_(config), channel_(channel) {}
+
+    void StartEngine();
+    void ShutdownEngine();
+
+    // Returns once the runner sends Shutdown or its process is gone.
+    void ServeMessages(HANDLE parentProcess);
+
+   private:
+    static bool OnSurfacePresent(void* user_data, const void* allocation, size_t row_bytes, size_t height);
+    static bool OnCreateBackingStore(const FlutterBackingStoreConfig* config,
+                                     FlutterBackingStore* backing_store_out,
+                                     void* user_data);
+    static bool OnCollectBackingStore(const FlutterBackingStore* backing_store, void* user_data);
+    static bool OnPresentView(const FlutterPresentViewInfo* info);
+    static void OnPlatformMessage(const FlutterPlatformMessage* message, void* user_data);
+
+    bool CopyFrame(const void* allocation, size_t rowBytes, size_t height, uint64_t rasterNanos);
+    bool Dispatch(const EngineMessage& message);
+
+    const RunnerConfig& config_;
+    EngineChannel& channel_;
+    FlutterBundle bundle_;
+    PlatformTaskRunner platformTasks_;
+    FlutterEngine engine_ = nullptr;
+
+    // Raster thread.
+    bool ringStoreOutstanding_ = false;
+    uint64_t rasterStartNanos_ = 0;
+    size_t lastRowBytes_ = 0;
+    size_t lastHeight_ = 0;
+    bool presentedEmpty_ = false;
+};
+
+void EngineChild::StartEngine() {
+    bundle_.Load();
+
+    FlutterRendererConfig rendererConfig{};
+    rendererConfig.type = kSoftware;
+    rendererConfig.software.struct_size = sizeof(FlutterSoftwareRendererConfig);
+    rendererConfig.software.surface_present_callback = OnSurfacePresent;
+
+    FlutterCompositor compositor{};
+    compositor.struct_size = sizeof(FlutterCompositor);
+    compositor.user_data = this;
+    compositor.create_backing_store_callback = OnCreateBackingStore;
+    compositor.collect_backing_store_callback = OnCollectBackingStore;
+    compositor.present_view_callback = OnPresentView;
+    compositor.avoid_backing_store_cache = true;
+
+    const std::string& entrypoint = config_.engineEntrypoints.front();
+    const char* commandLineArgs[] = {"flutter_open_xr_runner", "--enable-impeller=false"};
+    FlutterProjectArgs projectArgs{};
+    projectArgs.struct_size = sizeof(FlutterProjectArgs);
+    projectArgs.assets_path = bundle_.AssetsPath();
+    projectArgs.icu_data_path = bundle_.IcuPath();
+    projectArgs.command_line_argc = static_cast<int>(std::size(commandLineArgs));
+    projectArgs.command_line_argv = commandLineArgs;
+    projectArgs.platform_message_callback = OnPlatformMessage;
+    projectArgs.compositor = config_.useFlutterCompositor ? &compositor : nullptr;
+    projectArgs.aot_data = bundle_.AotData();
+    projectArgs.custom_dart_entrypoint = entrypoint == "main" ? nullptr : entrypoint.c_str();
+
+    // XR frame timing stays in the runner, so the engine paces itself.
+    FlutterCustomTaskRunners customTaskRunners{};
+    customTaskRunners.struct_size = sizeof(FlutterCustomTaskRunners);
+    customTaskRunners.platform_task_runner = platformTasks_.Description(0);
+    projectArgs.custom_task_runners = &customTaskRunners;
+
+    FlutterEngineResult runResult = kSuccess;
+    platformTasks_.RunSync([&]() {
+        runResult = FlutterEngineRun(FLUTTER_ENGINE_VERSION, &rendererConfig, &projectArgs, this, &engine_);
+    });
+    if (runResult != kSuccess || engine_ == nullptr) {
+        throw std::runtime_error("FlutterEngineRun failed in the engine process. entrypoint=" + entrypoint +
+                                 " result=" + std::to_string(static_cast<int32_t>(runResult)));
+    }
+    platformTasks_.SetEngine(0, engine_);
+    platformTasks_.Release();
+    std::cout << "Flutter engine process " << config_.engineGeneration << " running (" << entrypoint << ")\n";
+}
+
+void EngineChild::ShutdownEngine() {
+    if (engine_ != nullptr) {
+        platformTasks_.RunSync([this]() {
+            const FlutterEngineResult result = FlutterEngineShutdown(engine_);
+            if (result != kSuccess) {
+                std::cerr << "[warn] FlutterEngineShutdown failed in the engine process. result="
+                          << static_cast<int32_t>(result) << "\n";
+            }
+        });
+        platformTasks_.SetEngine(0, nullptr);
+        engine_ = nullptr;
+    }
+    platformTasks_.Stop();
+    bundle_.Unload();
+}
+
+void EngineChild::ServeMessages(HANDLE parentProcess) {
+    SharedMessageQueue& toEngine = channel_.ToEngine();
+    auto message = std::make_unique<EngineMessage>();
+    const HANDLE handles[2] = {static_cast<HANDLE>(toEngine.Signal().NativeHandle()), parentProcess};
+    for (;;) {
+        while (toEngine.Pop(message.get())) {
+            if (!Dispatch(*message)) {
+                return;
+            }
+        }
+        if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+            std::cerr << "[warn] Runner process is gone; stopping the Flutter engine process.\n";
+            return;
+        }
+    }
+}
+
+bool EngineChild::Dispatch(const EngineMessage& message) {
+    // Input queued for an engine process that has since been replaced is
+    // dropped along with its responses. The rest reaches the engine on the
+    // platform thread it was given.
+    const bool current = engine_ != nullptr && message.generation == config_.engineGeneration;
+    switch (message.type) {
+        case EngineMessageType::PointerEvents: {
+            std::vector<FlutterPointerEvent> events(current ? message.size / sizeof(FlutterPointerEvent) : 0);
+            if (!events.empty()) {
+                std::memcpy(events.data(), message.payload, events.size() * sizeof(FlutterPointerEvent));
+                platformTasks_.RunSync([&]() { FlutterEngineSendPointerEvent(engine_, events.data(), events.size()); });
+            }
+            return true;
+        }
+        case EngineMessageType::WindowMetrics: {
+            FlutterWindowMetricsEvent metrics{};
+            if (current && message.size == sizeof(metrics)) {
+                std::memcpy(&metrics, message.payload, sizeof(metrics));
+                platformTasks_.RunSync([&]() { FlutterEngineSendWindowMetricsEvent(engine_, &metrics); });
+            }
+            return true;
+        }
+        case EngineMessageType::PlatformResponse: {
+            // Stale responses carry handles this process never issued.
+            if (current) {
+                const auto* handle = reinterpret_cast<const FlutterPlatformMessageResponseHandle*>(message.id);
+                platformTasks_.RunSync([&]() {
+                    FlutterEngineSendPlatformMessageResponse(engine_, handle, message.payload, message.size);
+                });
+            }
+            return true;
+        }
+        case EngineMessageType::Ping:
+            channel_.FromEngine().Push(EngineMessageType::Pong, message.generation, message.id, nullptr, 0,
+                                       message.timestampNanos);
+            return true;
+        case EngineMessageType::Shutdown:
+            return false;
+        default:
+            return true;
+    }
+}
+
+bool EngineChild::CopyFrame(const void* allocation, size_t rowBytes, size_t height, uint64_t rasterNanos) {
+    uint8_t* target = channel_.Frames().BeginWrite(rowBytes, rowBytes / 4, height);
+    if (target == nullptr) {
+        return false;
+    }
+    std::memcpy(target, allocation, rowBytes * height);
+    channel_.Frames().Publish(rasterNanos);
+    return true;
+}
+
+bool EngineChild::OnSurfacePresent(void* user_data, const void* allocation, size_t row_bytes, size_t height) {
+    auto* child = static_cast<EngineChild*>(user_data);
+    if (child == nullptr || allocation == nullptr || row_bytes < 4 || height == 0) {
+        return false;
+    }
+    return child->CopyFrame(allocation, row_bytes, height, 0);
+}
+
+bool EngineChild::OnCreateBackingStore(const FlutterBackingStoreConfig* config,
+                                       FlutterBackingStore* backing_store_out,
+                                       void* user_data) {
+    auto* child = static_cast<EngineChild*>(user_data);
+    if (child == nullptr || config == nullptr || backing_store_out == nullptr || config->size.width < 1.0 ||
+        config->size.height < 1.0) {
+        return false;
+    }
+
+    const size_t width = static_cast<size_t>(config->size.width);
+    const size_t height = static_cast<size_t>(config->size.height);
+    const size_t rowBytes = width * 4;
+    child->rasterStartNanos_ = FlutterEngineGetCurrentTime();
+    child->lastRowBytes_ = rowBytes;
+    child->lastHeight_ = height;
+
+    // As in the runner, Flutter rasterizes straight into the ring's write
+    // slot when it is free, so frames reach the runner without a copy.
+    uint8_t* allocation = nullptr;
+    bool inRing = false;
+    if (!child->ringStoreOutstanding_) {
+        allocation = child->channel_.Frames().BeginWrite(rowBytes, width, height);
+        inRing = allocation != nullptr;
+    }
+    if (allocation == nullptr) {
+        allocation = new uint8_t[rowBytes * height]();
+    }
+
+    backing_store_out->struct_size = sizeof(FlutterBackingStore);
+    backing_store_out->type = kFlutterBackingStoreTypeSoftware;
+    backing_store_out->user_data = inRing ? &child->channel_ : nullptr;
+    backing_store_out->software.allocation = allocation;
+    backing_store_out->software.row_bytes = rowBytes;
+    backing_store_out->software.height = height;
+    backing_store_out->software.user_data = inRing ? nullptr : allocation;
+    backing_store_out->software.destruction_callback = inRing ? ReleaseRingBackingStore : ReleaseHeapBackingStore;
+    child->ringStoreOutstanding_ = child->ringStoreOutstanding_ || inRing;
+    return true;
+}
+
+bool EngineChild::OnCollectBackingStore(const FlutterBackingStore* backing_store, void* user_data) {
+    auto* child = static_cast<EngineChild*>(user_data);
+    if (child == nullptr || backing_store == nullptr) {
+        return false;
+    }
+    if (backing_store->user_data == &child->channel_) {
+        child->ringStoreOutstanding_ = false;
+    }
+    return true;
+}
+
+bool EngineChild::OnPresentView(const FlutterPresentViewInfo* info) {
+    auto* child = info != nullptr ? static_cast<EngineChild*>(info->user_data) : nullptr;
+    if (child == nullptr || info->view_id != kFlutterViewId || (info->layers == nullptr && info->layers_count != 0)) {
+        return false;
+    }
+
+    // An empty scene clears the panel once, as in the runner.
+    if (info->layers_count == 0) {
+        if (child->presentedEmpty_ || child->lastRowBytes_ == 0 || child->ringStoreOutstanding_) {
+            return true;
+        }
+        uint8_t* target = child->channel_.Frames().BeginWrite(child->lastRowBytes_, child->lastRowBytes_ / 4,
+                                                              child->lastHeight_);
+        if (target != nullptr) {
+            std::memset(target, 0, child->lastRowBytes_ * child->lastHeight_);
+            child->channel_.Frames().Publish(0);
+            child->presentedEmpty_ = true;
+        }
+        return true;
+    }
+    child->presentedEmpty_ = false;
+    if (info->layers_count != 1) {
+        return false;
+    }
+    const FlutterLayer* layer = info->layers[0];
+    if (layer == nullptr || layer->type != kFlutterLayerContentTypeBackingStore || layer->backing_store == nullptr) {
+        return false;
+    }
+
+    const uint64_t rasterNanos =
+        child->rasterStartNanos_ != 0 ? FlutterEngineGetCurrentTime() - child->rasterStartNanos_ : 0;
+    const FlutterBackingStore* store = layer->backing_store;
+    if (store->user_data == &child->channel_) {
+        child->channel_.Frames().Publish(rasterNanos);
+        return true;
+    }
+    return child->CopyFrame(store->software.allocation, store->software.row_bytes, store->software.height, rasterNanos);
+}
+
+void EngineChild::OnPlatformMessage(const FlutterPlatformMessage* message, void* user_data) {
+    auto* child = static_cast<EngineChild*>(user_data);
+    if (child == nullptr || message == nullptr || message->response_handle == nullptr) {
+        return;
+    }
+
+    // The runner answers platform messages, so they travel as the channel
+    // name and message bytes keyed by the response handle.
+    std::string payload = message->channel != nullptr ? message->channel : "";
+    payload.push_back('\0');
+    if (message->message != nullptr) {
+        payload.append(reinterpret_cast<const char*>(message->message), message->message_size);
+    }
+    const uint64_t id = reinterpret_cast<uint64_t>(message->response_handle);
+    if (!child->channel_.FromEngine().Push(EngineMessageType::PlatformMessage, child->config_.engineGeneration, id,
+                                           payload.data(), payload.size())) {
+        std::cerr << "[warn] Platform message did not fit the engine channel. bytes=" << payload.size() << "\n";
+        FlutterEngineSendPlatformMessageResponse(child->engine_, message->response_handle, nullptr, 0);
+    }
+}
+
+struct ScopedHandle {
+    explicit ScopedHandle(HANDLE value) : handle(value) {}
+    ~ScopedHandle() {
+        if (handle != nullptr) {
+            CloseHandle(handle);
+        }
+    }
+    ScopedHandle(const ScopedHandle&) = delete;
+    ScopedHandle& operator=(const ScopedHandle&) = delete;
+
+    HANDLE handle;
+};
+
+}  // namespace
+
+int RunEngineChild(const RunnerConfig& config) {
+    std::unique_ptr<EngineChannel> channel = EngineChannel::Open(config.engineChildChannel);
+    const ScopedHandle parent(OpenProcess(SYNCHRONIZE, FALSE, config.engineParentProcessId));
+    if (parent.handle == nullptr) {
+        throw std::runtime_error("OpenProcess failed for the runner process. error=" + std::to_string(GetLastError()));
+    }
+
+    EngineChild child(config, *channel);
+    child.StartEngine();
+    child.ServeMessages(parent.handle);
+    child.ShutdownEngine();
+    return 0;
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "flutter_xr/runner_config.h"
+
+namespace flutter_xr {
+
+// Body of the engine process the runner starts for --engine-process. Serves
+// the channel named by config.engineChildChannel until the runner asks it to stop or exits.
+// Returns the process exit code; throws std::runtime_error when the channel
+// or the engine cannot be set up.
+int RunEngineChild(const RunnerConfig& config);
+
+}  // namespace flutter_xr
@@ -0,0 +1,205 @@
+#include "flutter_xr/engine_process.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "flutter_xr/shared.h"
+
+namespace flutter_xr {
+
+namespace {
+
+constexpr DWORD kShutdownTimeoutMs = 2000;
+
+std::atomic<uint32_t> nextChannelId{0};
+
+}  // namespace
+
+EngineProcess::EngineProcess(std::string childArguments, size_t frameCapacityBytes)
+    : channelName_("Local\\flutter_open_xr_engine_" + std::to_string(GetCurrentProcessId()) + "_" +
+                   std::to_string(nextChannelId.fetch_add(1))),
+      childArguments_(std::move(childArguments)),
+      channel_(EngineChannel::Create(channelName_, frameCapacityBytes)) {
+    wakeEvent_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (wakeEvent_ == nullptr) {
+        throw std::runtime_error("CreateEventW failed for the engine process monitor. error=" +
+                                 std::to_string(GetLastError()));
+    }
+}
+
+EngineProcess::~EngineProcess() {
+    Stop();
+    if (wakeEvent_ != nullptr) {
+        CloseHandle(wakeEvent_);
+    }
+}
+
+void EngineProcess::Start(MessageHandler onPlatformMessage) {
+    onPlatformMessage_ = std::move(onPlatformMessage);
+    Spawn();
+    monitor_ = std::thread([this]() { MonitorMain(); });
+}
+
+void EngineProcess::Release() {
+    released_.store(true, std::memory_order_release);
+    SetEvent(wakeEvent_);
+}
+
+void EngineProcess::Stop() {
+    if (stopping_.exchange(true)) {
+        return;
+    }
+
+    Send(EngineMessageType::Shutdown, 0, nullptr, 0);
+    SetEvent(wakeEvent_);
+    if (monitor_.joinable()) {
+        monitor_.join();
+    }
+
+    if (process_ != nullptr) {
+        if (WaitForSingleObject(process_, kShutdownTimeoutMs) != WAIT_OBJECT_0) {
+            std::cerr << "[warn] Flutter engine process did not exit in time; terminating it.\n";
+            TerminateProcess(process_, 1);
+        }
+        CloseHandle(process_);
+        process_ = nullptr;
+    }
+    running_.store(false, std::memory_order_release);
+}
+
+bool EngineProcess::SendPointerEvents(const FlutterPointerEvent* events, size_t count) {
+    constexpr size_t kEventsPerMessage = kEngineMessagePayloadBytes / sizeof(FlutterPointerEvent);
+    for (size_t offset = 0; offset < count; offset += kEventsPerMessage) {
+        const size_t chunk = std::min(kEventsPerMessage, count - offset);
+        if (!Send(EngineMessageType::PointerEvents, 0, events + offset, chunk * sizeof(FlutterPointerEvent))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EngineProcess::SendWindowMetrics(const FlutterWindowMetricsEvent& metrics) {
+    std::lock_guard<std::mutex> lock(sendMutex_);
+    lastMetrics_ = metrics;
+    hasMetrics_ = true;
+    return channel_->ToEngine().Push(EngineMessageType::WindowMetrics, generation_, 0, &metrics, sizeof(metrics));
+}
+
+bool EngineProcess::Send(EngineMessageType type, uint64_t id, const void* payload, size_t size) {
+    std::lock_guard<std::mutex> lock(sendMutex_);
+    return channel_->ToEngine().Push(type, generation_, id, payload, size, SteadyClockNanos());
+}
+
+void EngineProcess::Spawn() {
+    const std::filesystem::path executable = GetExecutablePath();
+    if (executable.empty()) {
+        throw std::runtime_error("Cannot locate the runner executable to start the Flutter engine process");
+    }
+
+    uint32_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(sendMutex_);
+        generation = generation_ = restarts_.load(std::memory_order_relaxed);
+    }
+    const std::string arguments = "--engine-child=" + channelName_ +
+                                  " --engine-parent=" + std::to_string(GetCurrentProcessId()) +
+                                  " --engine-generation=" + std::to_string(generation) + " " + childArguments_;
+    std::wstring commandLine = L"\"" + executable.wstring() + L"\" " + Utf8ToWide(arguments);
+
+    // The child shares the runner's console so its log lines stay visible.
+    STARTUPINFOW startupInfo{};
+    startupInfo.cb = sizeof(startupInfo);
+    PROCESS_INFORMATION processInfo{};
+    if (!CreateProcessW(executable.c_str(), commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr,
+                        &startupInfo, &processInfo)) {
+        throw std::runtime_error("CreateProcessW failed for the Flutter engine process. error=" +
+                                 std::to_string(GetLastError()));
+    }
+    CloseHandle(processInfo.hThread);
+    process_ = processInfo.hProcess;
+    running_.store(true, std::memory_order_release);
+
+    // A restarted engine starts without metrics and would not draw.
+    std::lock_guard<std::mutex> lock(sendMutex_);
+    if (hasMetrics_) {
+        channel_->ToEngine().Push(EngineMessageType::WindowMetrics, generation_, 0, &lastMetrics_, sizeof(lastMetrics_));
+    }
+}
+
+void EngineProcess::MonitorMain() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        // Until released, the engine's messages stay queued and the queue's
+        // event is left to whoever else reads the channel.
+        const bool released = released_.load(std::memory_order_acquire);
+        HANDLE handles[3] = {wakeEvent_, nullptr, nullptr};
+        DWORD handleCount = 1;
+        DWORD processWaitIndex = MAXDWORD;
+        if (released) {
+            handles[handleCount++] = static_cast<HANDLE>(channel_->FromEngine().Signal().NativeHandle());
+        }
+        if (process_ != nullptr) {
+            processWaitIndex = handleCount;
+            handles[handleCount++] = process_;
+        }
+
+        const DWORD waited = WaitForMultipleObjects(handleCount, handles, FALSE, INFINITE);
+        if (stopping_.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (released) {
+            DrainFromEngine();
+        }
+        if (waited != WAIT_OBJECT_0 + processWaitIndex) {
+            continue;
+        }
+
+        DWORD exitCode = 0;
+        GetExitCodeProcess(process_, &exitCode);
+        CloseHandle(process_);
+        process_ = nullptr;
+        running_.store(false, std::memory_order_release);
+        if (restarts_.load(std::memory_order_relaxed) >= kMaxRestarts) {
+            std::cerr << "[warn] Flutter engine process exited with code " << exitCode
+                      << "; restart limit reached, the panel keeps its last frame.\n";
+            continue;
+        }
+        std::cerr << "[warn] Flutter engine process exited with code " << exitCode << "; restarting it.\n";
+        restarts_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            Spawn();
+        } catch (const std::exception& ex) {
+            std::cerr << "[warn] " << ex.what() << "\n";
+        }
+    }
+}
+
+void EngineProcess::DrainFromEngine() {
+    auto message = std::make_unique<EngineMessage>();
+    while (channel_->FromEngine().Pop(message.get())) {
+        if (message->type != EngineMessageType::PlatformMessage) {
+            continue;
+        }
+
+        const auto* bytes = reinterpret_cast<const char*>(message->payload);
+        const size_t channelLength = static_cast<size_t>(std::find(bytes, bytes + message->size, '\0') - bytes);
+        const std::string channel(bytes, channelLength);
+        const std::string text = channelLength < message->size
+                                     ? std::string(bytes + channelLength + 1, message->size - channelLength - 1)
+                                     : std::string();
+        const std::string response = onPlatformMessage_ ? onPlatformMessage_(channel, text) : std::string();
+
+        // Responses go back tagged with the generation that asked, so one
+        // meant for a process that has since restarted is ignored.
+        std::lock_guard<std::mutex> lock(sendMutex_);
+        if (!channel_->ToEngine().Push(EngineMessageType::PlatformResponse, message->generation, message->id,
+                                       response.data(), response.size())) {
+            std::cerr << "[warn] Dropped a platform message response to the Flutter engine process. bytes="
+                      << response.size() << "\n";
+        }
+    }
+}
+
+}  // namespace flutter_xr
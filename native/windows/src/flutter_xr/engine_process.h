@@ -0,0 +1,87 @@
+#pragma once
+
+#include <windows.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "flutter_embedder.h"
+#include "flutter_xr/engine_channel.h"
+
+namespace flutter_xr {
+
+// Runner side of --engine-process: a child copy of the runner hosts the
+// Flutter engine and hands frames over through an EngineChannel. A stalled
+// Dart app only stops its panel from updating, and a crashed one is
+// restarted up to kMaxRestarts times while the XR loop keeps running.
+class EngineProcess {
+   public:
+    static constexpr uint32_t kMaxRestarts = 3;
+
+    // Answers a platform message of the engine; runs on the monitor thread.
+    using MessageHandler = std::function<std::string(const std::string& channel, const std::string& message)>;
+
+    // `childArguments` are appended to the child's command line after the
+    // channel options. Throws std::runtime_error when the channel cannot be
+    // created.
+    EngineProcess(std::string childArguments, size_t frameCapacityBytes);
+    ~EngineProcess();
+
+    EngineProcess(const EngineProcess&) = delete;
+    EngineProcess& operator=(const EngineProcess&) = delete;
+
+    // Starts the child and the thread watching it. Throws
+    // std::runtime_error when the child cannot be started.
+    void Start(MessageHandler onPlatformMessage);
+
+    // Platform messages wait in the channel until the runner is released,
+    // like tasks of the in-process platform task runner.
+    void Release();
+    void Stop();
+
+    bool IsRunning() const { return running_.load(std::memory_order_acquire); }
+    uint32_t RestartCount() const { return restarts_.load(std::memory_order_relaxed); }
+    size_t MappedBytes() const { return channel_->MappedBytes(); }
+
+    EngineChannel& Channel() { return *channel_; }
+    SharedFrameRing& Frames() { return channel_->Frames(); }
+
+    // Safe to call from any thread. Return false when the child's queue is
+    // full; metrics are replayed to a restarted child.
+    bool SendPointerEvents(const FlutterPointerEvent* events, size_t count);
+    bool SendWindowMetrics(const FlutterWindowMetricsEvent& metrics);
+
+   private:
+    void Spawn();
+    void MonitorMain();
+    void DrainFromEngine();
+    bool Send(EngineMessageType type, uint64_t id, const void* payload, size_t size);
+
+    std::string channelName_;
+    std::string childArguments_;
+    std::unique_ptr<EngineChannel> channel_;
+    MessageHandler onPlatformMessage_;
+
+    HANDLE process_ = nullptr;
+    HANDLE wakeEvent_ = nullptr;
+    std::thread monitor_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> released_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint32_t> restarts_{0};
+
+    // The render and monitor threads both send, so pushes are serialized on
+    // this side; the queue itself stays lock-free between the processes.
+    std::mutex sendMutex_;
+    uint32_t generation_ = 0;
+    bool hasMetrics_ = false;
+    FlutterWindowMetricsEvent lastMetrics_{};
+};
+
+}  // namespace flutter_xr
@@ -0,0 +1,61 @@
+#include "flutter_xr/flutter_bundle.h"
+
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+#include "flutter_xr/shared.h"
+
+namespace flutter_xr {
+
+FlutterBundle::~FlutterBundle() {
+    Unload();
+}
+
+void FlutterBundle::Load() {
+    const auto exeDir = GetExecutableDir();
+    const auto assetsDir = exeDir / "data" / "flutter_assets";
+    const auto kernelBlob = assetsDir / "kernel_blob.bin";
+    const auto aotLibrary = exeDir / "data" / "app.so";
+    const auto icuPath = exeDir / "icudtl.dat";
+
+    // Release engines only run AOT-compiled Dart code; debug engines only
+    // run the kernel blob in the JIT VM.
+    if (FlutterEngineRunsAOTCompiledDartCode()) {
+        if (!std::filesystem::exists(aotLibrary)) {
+            throw std::runtime_error("Missing Flutter AOT library: " + aotLibrary.string());
+        }
+
+        aotLibraryPathUtf8_ = WideToUtf8(aotLibrary.wstring());
+        FlutterEngineAOTDataSource aotSource{};
+        aotSource.type = kFlutterEngineAOTDataSourceTypeElfPath;
+        aotSource.elf_path = aotLibraryPathUtf8_.c_str();
+        const FlutterEngineResult aotResult = FlutterEngineCreateAOTData(&aotSource, &aotData_);
+        if (aotResult != kSuccess || aotData_ == nullptr) {
+            throw std::runtime_error("FlutterEngineCreateAOTData failed. result=" +
+                                     std::to_string(static_cast<int32_t>(aotResult)));
+        }
+        std::cout << "Flutter Dart code: AOT (" << aotLibrary.string() << ")\n";
+    } else {
+        if (!std::filesystem::exists(kernelBlob)) {
+            throw std::runtime_error("Missing Flutter assets: " + kernelBlob.string());
+        }
+        std::cout << "Flutter Dart code: JIT (" << kernelBlob.string() << ")\n";
+    }
+
+    assetsPathUtf8_ = WideToUtf8(assetsDir.wstring());
+    if (std::filesystem::exists(icuPath)) {
+        icuPathUtf8_ = WideToUtf8(icuPath.wstring());
+    } else {
+        std::cout << "[warn] icudtl.dat not found next to executable. Trying without explicit ICU path.\n";
+    }
+}
+
+void FlutterBundle::Unload() {
+    if (aotData_ != nullptr) {
+        FlutterEngineCollectAOTData(aotData_);
+        aotData_ = nullptr;
+    }
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+#include "flutter_embedder.h"
+
+namespace flutter_xr {
+
+// The Flutter app bundle next to the executable: data/flutter_assets, ICU
+// data and, for release engine builds, the AOT snapshot in data/app.so. One
+// bundle is loaded per process and shared by every engine it runs.
+class FlutterBundle {
+   public:
+    FlutterBundle() = default;
+    ~FlutterBundle();
+
+    FlutterBundle(const FlutterBundle&) = delete;
+    FlutterBundle& operator=(const FlutterBundle&) = delete;
+
+    // Throws std::runtime_error when the Dart code this engine build runs is
+    // missing or the AOT snapshot cannot be loaded.
+    void Load();
+
+    // Engines read the AOT snapshot until they have shut down, so this must
+    // only run after every engine using the bundle is gone.
+    void Unload();
+
+    const char* AssetsPath() const { return assetsPathUtf8_.c_str(); }
+    // nullptr when icudtl.dat is missing and the engine has to find ICU data itself.
+    const char* IcuPath() const { return icuPathUtf8_.empty() ? nullptr : icuPathUtf8_.c_str(); }
+    FlutterEngineAOTData AotData() const { return aotData_; }
+
+   private:
+    std::string assetsPathUtf8_;
+    std::string icuPathUtf8_;
+    std::string aotLibraryPathUtf8_;
+    FlutterEngineAOTData aotData_ = nullptr;
+};
+
+}  // namespace flutter_xr
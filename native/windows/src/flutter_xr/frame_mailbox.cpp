@@ -0,0 +1,45 @@
+#include "flutter_xr/frame_mailbox.h"
+
+namespace flutter_xr {
+
+FrameMailbox::FrameMailbox(size_t capacityBytes) : capacityBytes_(capacityBytes) {
+    for (FrameSlot& slot : slots_) {
+        slot.pixels = std::make_unique<uint8_t[]>(capacityBytes);
+        slot.capacityBytes = capacityBytes;
+    }
+}
+
+uint8_t* FrameMailbox::BeginWrite(size_t rowBytes, size_t width, size_t height) {
+    if (rowBytes < width * 4 || height == 0 || rowBytes * height > capacityBytes_) {
+        return nullptr;
+    }
+
+    FrameSlot& slot = slots_[writeIndex_];
+    slot.rowBytes = rowBytes;
+    slot.width = width;
+    slot.height = height;
+    return slot.pixels.get();
+}
+
+void FrameMailbox::Publish() {
+    slots_[writeIndex_].frameIndex = ++nextFrameIndex_;
+
+    const uint32_t previous = pendingState_.exchange(writeIndex_ | kFreshBit, std::memory_order_acq_rel);
+    writeIndex_ = previous & kIndexMask;
+    if ((previous & kFreshBit) != 0) {
+        overwrittenFrameCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    publishedFrameCount_.store(nextFrameIndex_, std::memory_order_release);
+}
+
+const FrameSlot* FrameMailbox::AcquireLatest() {
+    if ((pendingState_.load(std::memory_order_relaxed) & kFreshBit) == 0) {
+        return nullptr;
+    }
+
+    const uint32_t previous = pendingState_.exchange(readIndex_, std::memory_order_acq_rel);
+    readIndex_ = previous & kIndexMask;
+    return &slots_[readIndex_];
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace flutter_xr {
+
+struct FrameSlot {
+    std::unique_ptr<uint8_t[]> pixels;
+    size_t capacityBytes = 0;
+    size_t rowBytes = 0;
+    size_t width = 0;
+    size_t height = 0;
+    uint64_t frameIndex = 0;
+};
+
+// Single-producer/single-consumer triple buffer. The producer always owns one
+// slot to write into, the consumer owns the slot it is reading, and the third
+// slot holds the newest published frame. Publishing and acquiring are a single
+// atomic exchange each, so neither side ever blocks the other and every slot
+// is allocated once up front.
+class FrameMailbox {
+   public:
+    static constexpr uint32_t kSlotCount = 3;
+
+    explicit FrameMailbox(size_t capacityBytes);
+
+    FrameMailbox(const FrameMailbox&) = delete;
+    FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+    size_t CapacityBytes() const { return capacityBytes_; }
+
+    // Producer side. Returns nullptr when the frame does not fit the slots.
+    uint8_t* BeginWrite(size_t rowBytes, size_t width, size_t height);
+    void Publish();
+
+    // Consumer side. Returns the newest frame if one was published since the
+    // previous call, otherwise nullptr. The slot stays valid until the next call.
+    const FrameSlot* AcquireLatest();
+
+    uint64_t PublishedFrameCount() const { return publishedFrameCount_.load(std::memory_order_acquire); }
+    uint64_t OverwrittenFrameCount() const { return overwrittenFrameCount_.load(std::memory_order_relaxed); }
+
+   private:
+    static constexpr uint32_t kIndexMask = 0x3u;
+    static constexpr uint32_t kFreshBit = 0x4u;
+
+    std::array<FrameSlot, kSlotCount> slots_;
+    size_t capacityBytes_ = 0;
+    uint32_t writeIndex_ = 0;
+    uint32_t readIndex_ = 1;
+    std::atomic<uint32_t> pendingState_{2};
+    uint64_t nextFrameIndex_ = 0;
+    std::atomic<uint64_t> publishedFrameCount_{0};
+    std::atomic<uint64_t> overwrittenFrameCount_{0};
+};
+
+}  // namespace flutter_xr
@@ -0,0 +1,99 @@
+#include "flutter_xr/frame_pipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flutter_xr {
+
+FrameWaitThread::FrameWaitThread(size_t queueCapacity) : capacity_(std::max<size_t>(queueCapacity, 1)) {}
+
+FrameWaitThread::~FrameWaitThread() {
+    Stop();
+}
+
+void FrameWaitThread::Start(WaitFunction wait) {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wait_ = std::move(wait);
+        frames_.clear();
+        error_ = nullptr;
+        stopping_ = false;
+    }
+    thread_ = std::thread([this]() { ThreadMain(); });
+}
+
+void FrameWaitThread::Stop(const DiscardFunction& discardFrame) {
+    std::deque<XrFrameState> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        pending.swap(frames_);
+    }
+    spaceCondition_.notify_all();
+    readyCondition_.notify_all();
+
+    // A frame the wait thread finishes waiting after this point is dropped
+    // without being begun; no further xrWaitFrame follows it.
+    if (discardFrame) {
+        for (const XrFrameState& frameState : pending) {
+            discardFrame(frameState);
+        }
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool FrameWaitThread::Pop(XrFrameState* outFrameState, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    readyCondition_.wait_for(lock, timeout, [this]() { return !frames_.empty() || error_ != nullptr || stopping_; });
+    if (!frames_.empty()) {
+        *outFrameState = frames_.front();
+        frames_.pop_front();
+        lock.unlock();
+        spaceCondition_.notify_one();
+        return true;
+    }
+    if (error_ != nullptr) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+    return false;
+}
+
+void FrameWaitThread::ThreadMain() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            spaceCondition_.wait(lock, [this]() { return stopping_ || frames_.size() < capacity_; });
+            if (stopping_) {
+                return;
+            }
+        }
+
+        XrFrameState frameState{XR_TYPE_FRAME_STATE};
+        try {
+            frameState = wait_();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = std::current_exception();
+            readyCondition_.notify_one();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return;
+            }
+            frames_.push_back(frameState);
+        }
+        readyCondition_.notify_one();
+    }
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <openxr/openxr.h>
+
+namespace flutter_xr {
+
+// Calls xrWaitFrame on its own thread and hands each XrFrameState to the
+// render thread through a bounded queue. The runtime does not return from
+// xrWaitFrame for frame N+1 before xrBeginFrame of frame N, so the wait for
+// the next frame overlaps the render thread's work on the current one.
+class FrameWaitThread {
+   public:
+    using WaitFunction = std::function<XrFrameState()>;
+
+    explicit FrameWaitThread(size_t queueCapacity);
+    ~FrameWaitThread();
+
+    FrameWaitThread(const FrameWaitThread&) = delete;
+    FrameWaitThread& operator=(const FrameWaitThread&) = delete;
+
+    void Start(WaitFunction wait);
+
+    // Joins the thread. The wait thread may be blocked in xrWaitFrame until
+    // the queued frame is begun, so every frame still queued is passed to
+    // `discardFrame`, which must begin and end it.
+    using DiscardFunction = std::function<void(const XrFrameState&)>;
+    void Stop(const DiscardFunction& discardFrame = nullptr);
+
+    bool IsRunning() const { return thread_.joinable(); }
+
+    // Takes the oldest waited frame. Returns false if none arrived within
+    // `timeout`. Rethrows a failure of the wait thread.
+    bool Pop(XrFrameState* outFrameState, std::chrono::milliseconds timeout);
+
+   private:
+    void ThreadMain();
+
+    const size_t capacity_;
+    WaitFunction wait_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable spaceCondition_;
+    std::condition_variable readyCondition_;
+    std::deque<XrFrameState> frames_;
+    std::exception_ptr error_;
+    bool stopping_ = false;
+};
+
+}  // namespace flutter_xr
@@ -1,12 +1,19 @@
 #include "flutter_xr/app.h"
+#include "flutter_xr/engine_child.h"
 
 #include <exception>
 #include <iostream>
 
-int main() {
+int main(int argc, char** argv) {
     try {
+        const flutter_xr::RunnerConfig config = flutter_xr::ParseRunnerConfig(argc, argv);
+        if (!config.engineChildChannel.empty()) {
+            return flutter_xr::RunEngineChild(config);
+        }
+        std::cout << "Runner options: " << flutter_xr::DescribeRunnerConfig(config) << '\n';
+
         flutter_xr::ScopedComInitializer com;
-        flutter_xr::FlutterXrApp app;
+        flutter_xr::FlutterXrApp app(config);
         app.Initialize();
         app.Run();
         return 0;
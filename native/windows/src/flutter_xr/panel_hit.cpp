@@ -0,0 +1,206 @@
+#include "flutter_xr/panel_hit.h"
+
+#include <cmath>
+
+#include "flutter_xr/xr_math.h"
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLUTTER_XR_PANEL_HIT_SSE2 1
+#endif
+
+namespace flutter_xr {
+
+namespace {
+
+constexpr float kMinDirectionZ = 1.0e-6f;
+
+}  // namespace
+
+bool IntersectRayWithQuad(const XrVector3f& rayOriginWorld,
+                          const XrVector3f& rayDirectionWorld,
+                          const XrPosef& quadPoseWorld,
+                          float quadWidthMeters,
+                          float quadHeightMeters,
+                          float* outHitDistanceMeters,
+                          double* outU,
+                          double* outV) {
+    if (outU == nullptr || outV == nullptr || quadWidthMeters <= 0.0f || quadHeightMeters <= 0.0f) {
+        return false;
+    }
+
+    const XrQuaternionf invQuadOrientation = Conjugate(quadPoseWorld.orientation);
+    const XrVector3f rayOriginLocal = RotateVector(invQuadOrientation, Subtract(rayOriginWorld, quadPoseWorld.position));
+    const XrVector3f rayDirectionLocal = RotateVector(invQuadOrientation, rayDirectionWorld);
+
+    if (std::abs(rayDirectionLocal.z) < kMinDirectionZ) {
+        return false;
+    }
+
+    const float t = -rayOriginLocal.z / rayDirectionLocal.z;
+    if (t <= 0.0f) {
+        return false;
+    }
+
+    const XrVector3f hit = Add(rayOriginLocal, Scale(rayDirectionLocal, t));
+    const float halfWidth = quadWidthMeters * 0.5f;
+    const float halfHeight = quadHeightMeters * 0.5f;
+    if (std::abs(hit.x) > halfWidth || std::abs(hit.y) > halfHeight) {
+        return false;
+    }
+
+    *outU = static_cast<double>(hit.x / quadWidthMeters + 0.5f);
+    *outV = static_cast<double>(0.5f - hit.y / quadHeightMeters);
+    if (outHitDistanceMeters != nullptr) {
+        *outHitDistanceMeters = t;
+    }
+    return true;
+}
+
+void PanelHitTester::Clear() {
+    for (std::vector<float>& field : fields_) {
+        field.clear();
+    }
+    panelCount_ = 0;
+}
+
+size_t PanelHitTester::AddPanel(const XrPosef& poseWorld, float widthMeters, float heightMeters) {
+    if (panelCount_ % kLanes == 0) {
+        for (size_t field = 0; field < kFieldCount; ++field) {
+            const float padding = (field == kHalfWidth || field == kHalfHeight) ? -1.0f : 0.0f;
+            fields_[field].resize(panelCount_ + kLanes, padding);
+        }
+    }
+
+    // local = R^T * (world - position), so the rows of R^T are stored.
+    const Matrix3 toLocal = Transpose(RotationMatrix(poseWorld.orientation));
+    const auto& rows = toLocal.m;
+    const XrVector3f& p = poseWorld.position;
+
+    const size_t index = panelCount_++;
+    for (size_t row = 0; row < 3; ++row) {
+        fields_[kRow0X + row * 3][index] = rows[row][0];
+        fields_[kRow0Y + row * 3][index] = rows[row][1];
+        fields_[kRow0Z + row * 3][index] = rows[row][2];
+        fields_[kOffsetX + row][index] = -(rows[row][0] * p.x + rows[row][1] * p.y + rows[row][2] * p.z);
+    }
+
+    const bool valid = widthMeters > 0.0f && heightMeters > 0.0f;
+    fields_[kHalfWidth][index] = valid ? widthMeters * 0.5f : -1.0f;
+    fields_[kHalfHeight][index] = valid ? heightMeters * 0.5f : -1.0f;
+    fields_[kInverseWidth][index] = valid ? 1.0f / widthMeters : 0.0f;
+    fields_[kInverseHeight][index] = valid ? 1.0f / heightMeters : 0.0f;
+    return index;
+}
+
+void PanelHitTester::IntersectScalar(const PanelRay& ray, size_t firstPanel, PanelHit* hit) const {
+    const XrVector3f& o = ray.origin;
+    const XrVector3f& d = ray.direction;
+    for (size_t i = firstPanel; i < panelCount_; ++i) {
+        const float dirZ = fields_[kRow2X][i] * d.x + fields_[kRow2Y][i] * d.y + fields_[kRow2Z][i] * d.z;
+        if (std::abs(dirZ) < kMinDirectionZ) {
+            continue;
+        }
+        const float originZ =
+            fields_[kRow2X][i] * o.x + fields_[kRow2Y][i] * o.y + fields_[kRow2Z][i] * o.z + fields_[kOffsetZ][i];
+        const float t = -originZ / dirZ;
+        if (t <= 0.0f || (hit->panel >= 0 && t >= hit->distance)) {
+            continue;
+        }
+
+        const float x = fields_[kRow0X][i] * (o.x + d.x * t) + fields_[kRow0Y][i] * (o.y + d.y * t) +
+                        fields_[kRow0Z][i] * (o.z + d.z * t) + fields_[kOffsetX][i];
+        const float y = fields_[kRow1X][i] * (o.x + d.x * t) + fields_[kRow1Y][i] * (o.y + d.y * t) +
+                        fields_[kRow1Z][i] * (o.z + d.z * t) + fields_[kOffsetY][i];
+        if (!(std::abs(x) <= fields_[kHalfWidth][i]) || !(std::abs(y) <= fields_[kHalfHeight][i])) {
+            continue;
+        }
+
+        hit->panel = static_cast<int32_t>(i);
+        hit->distance = t;
+        hit->u = x * fields_[kInverseWidth][i] + 0.5f;
+        hit->v = 0.5f - y * fields_[kInverseHeight][i];
+    }
+}
+
+PanelHit PanelHitTester::Intersect(const PanelRay& ray) const {
+    PanelHit hit;
+    Intersect(&ray, 1, &hit);
+    return hit;
+}
+
+void PanelHitTester::Intersect(const PanelRay* rays, size_t rayCount, PanelHit* outHits) const {
+    for (size_t r = 0; r < rayCount; ++r) {
+        PanelHit hit;
+        size_t panel = 0;
+
+#if defined(FLUTTER_XR_PANEL_HIT_SSE2)
+        const PanelRay& ray = rays[r];
+        const __m128 ox = _mm_set1_ps(ray.origin.x);
+        const __m128 oy = _mm_set1_ps(ray.origin.y);
+        const __m128 oz = _mm_set1_ps(ray.origin.z);
+        const __m128 dx = _mm_set1_ps(ray.direction.x);
+        const __m128 dy = _mm_set1_ps(ray.direction.y);
+        const __m128 dz = _mm_set1_ps(ray.direction.z);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        const __m128 minDirection = _mm_set1_ps(kMinDirectionZ);
+
+        // Padding lanes never hit, so whole groups cover every panel.
+        const size_t vectorEnd = fields_[kHalfWidth].size();
+        for (; panel < vectorEnd; panel += kLanes) {
+            auto load = [&](Field field) { return _mm_loadu_ps(fields_[field].data() + panel); };
+            auto dot = [&](Field x, Field y, Field z, __m128 vx, __m128 vy, __m128 vz) {
+                const __m128 xy = _mm_add_ps(_mm_mul_ps(load(x), vx), _mm_mul_ps(load(y), vy));
+                return _mm_add_ps(xy, _mm_mul_ps(load(z), vz));
+            };
+
+            // Local ray origin and direction for four panels at once.
+            const __m128 localDx = dot(kRow0X, kRow0Y, kRow0Z, dx, dy, dz);
+            const __m128 localDy = dot(kRow1X, kRow1Y, kRow1Z, dx, dy, dz);
+            const __m128 localDz = dot(kRow2X, kRow2Y, kRow2Z, dx, dy, dz);
+            const __m128 localOx = _mm_add_ps(dot(kRow0X, kRow0Y, kRow0Z, ox, oy, oz), load(kOffsetX));
+            const __m128 localOy = _mm_add_ps(dot(kRow1X, kRow1Y, kRow1Z, ox, oy, oz), load(kOffsetY));
+            const __m128 localOz = _mm_add_ps(dot(kRow2X, kRow2Y, kRow2Z, ox, oy, oz), load(kOffsetZ));
+
+            // Lanes parallel to their panel divide by 1 instead and are masked out.
+            const __m128 facing = _mm_cmpge_ps(_mm_and_ps(localDz, absMask), minDirection);
+            const __m128 divisor = _mm_or_ps(_mm_and_ps(facing, localDz), _mm_andnot_ps(facing, one));
+            const __m128 t = _mm_div_ps(_mm_sub_ps(zero, localOz), divisor);
+            const __m128 x = _mm_add_ps(localOx, _mm_mul_ps(localDx, t));
+            const __m128 y = _mm_add_ps(localOy, _mm_mul_ps(localDy, t));
+            __m128 inside = _mm_and_ps(facing, _mm_cmpgt_ps(t, zero));
+            inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_and_ps(x, absMask), load(kHalfWidth)));
+            inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_and_ps(y, absMask), load(kHalfHeight)));
+
+            int mask = _mm_movemask_ps(inside);
+            if (mask == 0) {
+                continue;
+            }
+
+            alignas(16) float laneT[kLanes];
+            alignas(16) float laneX[kLanes];
+            alignas(16) float laneY[kLanes];
+            _mm_store_ps(laneT, t);
+            _mm_store_ps(laneX, x);
+            _mm_store_ps(laneY, y);
+            for (size_t lane = 0; lane < kLanes; ++lane, mask >>= 1) {
+                if ((mask & 1) == 0 || (hit.panel >= 0 && laneT[lane] >= hit.distance)) {
+                    continue;
+                }
+                const size_t index = panel + lane;
+                hit.panel = static_cast<int32_t>(index);
+                hit.distance = laneT[lane];
+                hit.u = laneX[lane] * fields_[kInverseWidth][index] + 0.5f;
+                hit.v = 0.5f - laneY[lane] * fields_[kInverseHeight][index];
+            }
+        }
+#endif
+
+        IntersectScalar(rays[r], panel, &hit);
+        outHits[r] = hit;
+    }
+}
+
+}  // namespace flutter_xr
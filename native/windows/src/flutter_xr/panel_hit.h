@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <openxr/openxr.h>
+
+namespace flutter_xr {
+
+struct PanelRay {
+    XrVector3f origin{0.0f, 0.0f, 0.0f};
+    XrVector3f direction{0.0f, 0.0f, -1.0f};
+};
+
+struct PanelHit {
+    // Index of the nearest panel hit, or -1 when the ray misses every panel.
+    int32_t panel = -1;
+    float distance = 0.0f;
+    // Hit position on the panel, (0, 0) at its top-left corner and (1, 1) at
+    // its bottom-right corner.
+    float u = 0.0f;
+    float v = 0.0f;
+};
+
+// Intersects one ray with a quad centred on `quadPoseWorld` and facing +z.
+// `outU`/`outV` are 0 at the top-left corner and 1 at the bottom-right.
+bool IntersectRayWithQuad(const XrVector3f& rayOriginWorld,
+                          const XrVector3f& rayDirectionWorld,
+                          const XrPosef& quadPoseWorld,
+                          float quadWidthMeters,
+                          float quadHeightMeters,
+                          float* outHitDistanceMeters,
+                          double* outU,
+                          double* outV);
+
+// Intersects rays with a set of quads. Each panel's world-to-local transform
+// is computed once when the panel is added and kept structure-of-arrays, so
+// one ray is tested against four panels per SSE2 step. Same results as
+// IntersectRayWithQuad for each ray/panel pair.
+class PanelHitTester {
+   public:
+    void Clear();
+    size_t AddPanel(const XrPosef& poseWorld, float widthMeters, float heightMeters);
+    size_t PanelCount() const { return panelCount_; }
+
+    // Writes the nearest hit of every ray to `outHits[i]`.
+    void Intersect(const PanelRay* rays, size_t rayCount, PanelHit* outHits) const;
+    PanelHit Intersect(const PanelRay& ray) const;
+
+   private:
+    // World-to-local rotation rows, local translation, and quad extents.
+    enum Field : size_t {
+        kRow0X,
+        kRow0Y,
+        kRow0Z,
+        kRow1X,
+        kRow1Y,
+        kRow1Z,
+        kRow2X,
+        kRow2Y,
+        kRow2Z,
+        kOffsetX,
+        kOffsetY,
+        kOffsetZ,
+        kHalfWidth,
+        kHalfHeight,
+        kInverseWidth,
+        kInverseHeight,
+        kFieldCount,
+    };
+
+    static constexpr size_t kLanes = 4;
+
+    void IntersectScalar(const PanelRay& ray, size_t firstPanel, PanelHit* hit) const;
+
+    // Sized to a multiple of kLanes; padding panels have a negative extent
+    // and never report a hit.
+    std::array<std::vector<float>, kFieldCount> fields_;
+    size_t panelCount_ = 0;
+};
+
+}  // namespace flutter_xr
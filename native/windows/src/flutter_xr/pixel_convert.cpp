@@ -0,0 +1,259 @@
+#include "flutter_xr/pixel_convert.h"
+
+#include <cstring>
+#include <initializer_list>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FLUTTER_XR_PIXEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC exposes every intrinsic unconditionally; GCC and Clang need the
+// instruction set enabled per function so the rest of the file stays baseline.
+#if defined(FLUTTER_XR_PIXEL_X86) && !defined(_MSC_VER)
+#define FLUTTER_XR_TARGET(features) __attribute__((target(features)))
+#else
+#define FLUTTER_XR_TARGET(features)
+#endif
+
+namespace flutter_xr {
+
+namespace {
+
+using SwizzleRowFunction = void (*)(const uint8_t* source, uint8_t* destination, size_t width);
+
+void SwizzleRowScalar(const uint8_t* source, uint8_t* destination, size_t width) {
+    for (size_t x = 0; x < width; ++x) {
+        uint32_t pixel = 0;
+        std::memcpy(&pixel, source + x * 4, sizeof(pixel));
+        pixel = (pixel & 0xff00ff00u) | ((pixel & 0xffu) << 16) | ((pixel >> 16) & 0xffu);
+        std::memcpy(destination + x * 4, &pixel, sizeof(pixel));
+    }
+}
+
+#if defined(FLUTTER_XR_PIXEL_X86)
+
+struct CpuFeatures {
+    bool ssse3 = false;
+    bool avx2 = false;
+    bool avx512bw = false;
+};
+
+void QueryCpuid(int leaf, int subleaf, int registers[4]) {
+#if defined(_MSC_VER)
+    __cpuidex(registers, leaf, subleaf);
+#else
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    __cpuid_count(leaf, subleaf, eax, ebx, ecx, edx);
+    registers[0] = static_cast<int>(eax);
+    registers[1] = static_cast<int>(ebx);
+    registers[2] = static_cast<int>(ecx);
+    registers[3] = static_cast<int>(edx);
+#endif
+}
+
+uint64_t ReadXcr0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax = 0;
+    uint32_t edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+CpuFeatures DetectCpuFeatures() {
+    CpuFeatures features;
+    int registers[4] = {};
+    QueryCpuid(0, 0, registers);
+    const int maxLeaf = registers[0];
+    if (maxLeaf < 1) {
+        return features;
+    }
+
+    QueryCpuid(1, 0, registers);
+    const uint32_t leaf1Ecx = static_cast<uint32_t>(registers[2]);
+    features.ssse3 = (leaf1Ecx & (1u << 9)) != 0;
+
+    const bool osxsave = (leaf1Ecx & (1u << 27)) != 0;
+    const bool avx = (leaf1Ecx & (1u << 28)) != 0;
+    if (!osxsave || !avx || maxLeaf < 7) {
+        return features;
+    }
+
+    // The OS must save YMM (and for AVX-512 also opmask/ZMM) state.
+    const uint64_t xcr0 = ReadXcr0();
+    const bool ymmState = (xcr0 & 0x6u) == 0x6u;
+    const bool zmmState = (xcr0 & 0xe6u) == 0xe6u;
+
+    QueryCpuid(7, 0, registers);
+    const uint32_t leaf7Ebx = static_cast<uint32_t>(registers[1]);
+    features.avx2 = ymmState && (leaf7Ebx & (1u << 5)) != 0;
+    features.avx512bw = zmmState && (leaf7Ebx & (1u << 16)) != 0 && (leaf7Ebx & (1u << 30)) != 0;
+    return features;
+}
+
+const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+FLUTTER_XR_TARGET("ssse3")
+void SwizzleRowSsse3(const uint8_t* source, uint8_t* destination, size_t width) {
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), _mm_shuffle_epi8(pixels, shuffle));
+    }
+    SwizzleRowScalar(source + x * 4, destination + x * 4, width - x);
+}
+
+FLUTTER_XR_TARGET("avx2")
+void SwizzleRowAvx2(const uint8_t* source, uint8_t* destination, size_t width) {
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                             2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + x * 4));
+        const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + x * 4 + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x * 4), _mm256_shuffle_epi8(first, shuffle));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x * 4 + 32), _mm256_shuffle_epi8(second, shuffle));
+    }
+    for (; x + 8 <= width; x += 8) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + x * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x * 4), _mm256_shuffle_epi8(pixels, shuffle));
+    }
+    SwizzleRowScalar(source + x * 4, destination + x * 4, width - x);
+}
+
+FLUTTER_XR_TARGET("avx512f,avx512bw")
+void SwizzleRowAvx512(const uint8_t* source, uint8_t* destination, size_t width) {
+    const __m512i shuffle = _mm512_set4_epi32(0x0f0c0d0e, 0x0b08090a, 0x07040506, 0x03000102);
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m512i pixels = _mm512_loadu_si512(source + x * 4);
+        _mm512_storeu_si512(destination + x * 4, _mm512_shuffle_epi8(pixels, shuffle));
+    }
+
+    // The row tail uses byte-masked loads and stores instead of a scalar loop.
+    const size_t remainingBytes = (width - x) * 4;
+    if (remainingBytes != 0) {
+        const __mmask64 mask = (static_cast<__mmask64>(1) << remainingBytes) - 1;
+        const __m512i pixels = _mm512_maskz_loadu_epi8(mask, source + x * 4);
+        _mm512_mask_storeu_epi8(destination + x * 4, mask, _mm512_shuffle_epi8(pixels, shuffle));
+    }
+}
+
+#endif
+
+SwizzleRowFunction RowFunctionFor(PixelKernel kernel) {
+    switch (kernel) {
+#if defined(FLUTTER_XR_PIXEL_X86)
+        case PixelKernel::Ssse3:
+            return SwizzleRowSsse3;
+        case PixelKernel::Avx2:
+            return SwizzleRowAvx2;
+        case PixelKernel::Avx512:
+            return SwizzleRowAvx512;
+#endif
+        default:
+            return SwizzleRowScalar;
+    }
+}
+
+PixelKernel DetectBestPixelKernel() {
+    for (PixelKernel candidate : {PixelKernel::Avx512, PixelKernel::Avx2, PixelKernel::Ssse3}) {
+        if (IsPixelKernelSupported(candidate)) {
+            return candidate;
+        }
+    }
+    return PixelKernel::Scalar;
+}
+
+}  // namespace
+
+const char* PixelKernelName(PixelKernel kernel) {
+    switch (kernel) {
+        case PixelKernel::Scalar:
+            return "scalar";
+        case PixelKernel::Ssse3:
+            return "ssse3";
+        case PixelKernel::Avx2:
+            return "avx2";
+        case PixelKernel::Avx512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+bool IsPixelKernelSupported(PixelKernel kernel) {
+#if defined(FLUTTER_XR_PIXEL_X86)
+    const CpuFeatures& features = GetCpuFeatures();
+    switch (kernel) {
+        case PixelKernel::Scalar:
+            return true;
+        case PixelKernel::Ssse3:
+            return features.ssse3;
+        case PixelKernel::Avx2:
+            return features.avx2;
+        case PixelKernel::Avx512:
+            return features.avx512bw;
+    }
+    return false;
+#else
+    return kernel == PixelKernel::Scalar;
+#endif
+}
+
+PixelKernel SelectedPixelKernel() {
+    static const PixelKernel kernel = DetectBestPixelKernel();
+    return kernel;
+}
+
+void SwizzleRgbaToBgra(PixelKernel kernel,
+                       const uint8_t* source,
+                       size_t sourceRowBytes,
+                       uint8_t* destination,
+                       size_t destinationRowBytes,
+                       size_t width,
+                       size_t height) {
+    const SwizzleRowFunction swizzleRow = RowFunctionFor(IsPixelKernelSupported(kernel) ? kernel : PixelKernel::Scalar);
+    for (size_t y = 0; y < height; ++y) {
+        swizzleRow(source + y * sourceRowBytes, destination + y * destinationRowBytes, width);
+    }
+}
+
+void SwizzleRgbaToBgra(const uint8_t* source,
+                       size_t sourceRowBytes,
+                       uint8_t* destination,
+                       size_t destinationRowBytes,
+                       size_t width,
+                       size_t height) {
+    SwizzleRgbaToBgra(SelectedPixelKernel(), source, sourceRowBytes, destination, destinationRowBytes, width, height);
+}
+
+bool ConvertRgbaToBgra(const uint8_t* source,
+                       size_t sourceRowBytes,
+                       size_t width,
+                       size_t height,
+                       std::vector<uint8_t>& outPixels) {
+    if (source == nullptr || width == 0 || height == 0 || sourceRowBytes < width * 4) {
+        return false;
+    }
+
+    outPixels.resize(width * height * 4);
+    SwizzleRgbaToBgra(source, sourceRowBytes, outPixels.data(), width * 4, width, height);
+    return true;
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_xr {
+
+enum class PixelKernel : uint8_t {
+    Scalar,
+    Ssse3,
+    Avx2,
+    Avx512,
+};
+
+const char* PixelKernelName(PixelKernel kernel);
+bool IsPixelKernelSupported(PixelKernel kernel);
+
+// Best kernel supported by the CPU and OS, detected once on first use.
+PixelKernel SelectedPixelKernel();
+
+// Swaps the R and B channels of `height` rows of `width` 32-bit pixels.
+// Source and destination rows may be padded; they must not overlap unless
+// they are the same buffer with the same row pitch.
+void SwizzleRgbaToBgra(PixelKernel kernel,
+                       const uint8_t* source,
+                       size_t sourceRowBytes,
+                       uint8_t* destination,
+                       size_t destinationRowBytes,
+                       size_t width,
+                       size_t height);
+void SwizzleRgbaToBgra(const uint8_t* source,
+                       size_t sourceRowBytes,
+                       uint8_t* destination,
+                       size_t destinationRowBytes,
+                       size_t width,
+                       size_t height);
+
+// Converts into a tightly packed buffer using the selected kernel.
+bool ConvertRgbaToBgra(const uint8_t* source,
+                       size_t sourceRowBytes,
+                       size_t width,
+                       size_t height,
+                       std::vector<uint8_t>& outPixels);
+
+}  // namespace flutter_xr
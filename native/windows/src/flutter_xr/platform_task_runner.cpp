@@ -0,0 +1,236 @@
+#include "flutter_xr/platform_task_runner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <iostream>
+
+namespace flutter_xr {
+
+namespace {
+
+// A render frame's critical section normally lasts a few milliseconds; past
+// this, platform tasks run anyway so a stalled frame cannot starve them.
+constexpr uint64_t kMaxRenderDeferralNanos = 4'000'000;
+
+constexpr size_t kPlatformTaskRunnerIdentifier = 1;
+
+}  // namespace
+
+PlatformTaskRunner::PlatformTaskRunner() {
+    for (size_t i = 0; i < engines_.size(); ++i) {
+        EngineSlot& slot = engines_[i];
+        slot.runner = this;
+        slot.index = i;
+        slot.description.struct_size = sizeof(FlutterTaskRunnerDescription);
+        slot.description.user_data = &slot;
+        slot.description.runs_task_on_current_thread_callback = RunsTasksOnCurrentThread;
+        slot.description.post_task_callback = PostTask;
+        slot.description.identifier = kPlatformTaskRunnerIdentifier;
+    }
+
+    thread_ = std::thread([this]() { ThreadMain(); });
+    threadId_ = thread_.get_id();
+}
+
+PlatformTaskRunner::~PlatformTaskRunner() {
+    Stop();
+}
+
+bool PlatformTaskRunner::RunsTasksOnCurrentThread(void* userData) {
+    return std::this_thread::get_id() == static_cast<EngineSlot*>(userData)->runner->threadId_;
+}
+
+void PlatformTaskRunner::PostTask(FlutterTask task, uint64_t targetTimeNanos, void* userData) {
+    auto* slot = static_cast<EngineSlot*>(userData);
+    PlatformTaskRunner* runner = slot->runner;
+    {
+        std::lock_guard<std::mutex> lock(runner->mutex_);
+        if (runner->stopping_) {
+            return;
+        }
+        runner->tasks_.push(PendingTask{targetTimeNanos, runner->nextSequence_++, slot->index, task});
+        runner->maxQueueDepth_ = std::max(runner->maxQueueDepth_, runner->tasks_.size());
+        slot->maxQueueDepth = std::max(slot->maxQueueDepth, ++slot->queuedTasks);
+    }
+    runner->wakeCondition_.notify_one();
+}
+
+void PlatformTaskRunner::RunSync(const std::function<void()>& work) {
+    if (std::this_thread::get_id() == threadId_) {
+        work();
+        return;
+    }
+
+    std::promise<void> done;
+    std::future<void> result = done.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        closures_.push_back([&]() {
+            try {
+                work();
+                done.set_value();
+            } catch (...) {
+                done.set_exception(std::current_exception());
+            }
+        });
+    }
+    wakeCondition_.notify_one();
+    result.get();
+}
+
+void PlatformTaskRunner::Post(std::function<void()> work) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        closures_.push_back([work = std::move(work)]() {
+            try {
+                work();
+            } catch (const std::exception& error) {
+                std::cerr << "[warn] Platform thread work failed: " << error.what() << "\n";
+            }
+        });
+    }
+    wakeCondition_.notify_one();
+}
+
+void PlatformTaskRunner::SetEngine(size_t engineIndex, FlutterEngine engine) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        engines_[engineIndex].engine = engine;
+    }
+    wakeCondition_.notify_one();
+}
+
+void PlatformTaskRunner::Release() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released_ = true;
+    }
+    wakeCondition_.notify_one();
+}
+
+void PlatformTaskRunner::SetRenderCritical(bool critical) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (renderCritical_ == critical) {
+            return;
+        }
+        renderCritical_ = critical;
+        renderCriticalSinceNanos_ = critical ? FlutterEngineGetCurrentTime() : 0;
+    }
+    if (!critical) {
+        wakeCondition_.notify_one();
+    }
+}
+
+void PlatformTaskRunner::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeCondition_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_ = {};
+    closures_.clear();
+    for (EngineSlot& slot : engines_) {
+        slot.engine = nullptr;
+        slot.queuedTasks = 0;
+    }
+}
+
+PlatformTaskRunner::Stats PlatformTaskRunner::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    double totalLatencyNanos = 0.0;
+    uint64_t maxLatencyNanos = 0;
+    uint64_t busyNanos = 0;
+    for (const EngineSlot& slot : engines_) {
+        stats.tasksRun += slot.tasksRun;
+        totalLatencyNanos += slot.totalLatencyNanos;
+        maxLatencyNanos = std::max(maxLatencyNanos, slot.maxLatencyNanos);
+        busyNanos += slot.busyNanos;
+    }
+    stats.maxQueueDepth = maxQueueDepth_;
+    stats.meanLatencyMs = stats.tasksRun == 0 ? 0.0 : totalLatencyNanos / static_cast<double>(stats.tasksRun) / 1e6;
+    stats.maxLatencyMs = static_cast<double>(maxLatencyNanos) / 1e6;
+    stats.busyMs = static_cast<double>(busyNanos) / 1e6;
+    return stats;
+}
+
+PlatformTaskRunner::Stats PlatformTaskRunner::GetStats(size_t engineIndex) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const EngineSlot& slot = engines_[engineIndex];
+    Stats stats;
+    stats.tasksRun = slot.tasksRun;
+    stats.maxQueueDepth = slot.maxQueueDepth;
+    stats.meanLatencyMs = slot.tasksRun == 0 ? 0.0 : slot.totalLatencyNanos / static_cast<double>(slot.tasksRun) / 1e6;
+    stats.maxLatencyMs = static_cast<double>(slot.maxLatencyNanos) / 1e6;
+    stats.busyMs = static_cast<double>(slot.busyNanos) / 1e6;
+    return stats;
+}
+
+void PlatformTaskRunner::ThreadMain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (!closures_.empty()) {
+            std::function<void()> closure = std::move(closures_.front());
+            closures_.pop_front();
+            lock.unlock();
+            closure();
+            lock.lock();
+            continue;
+        }
+
+        if (!released_ || tasks_.empty()) {
+            wakeCondition_.wait(lock);
+            continue;
+        }
+
+        const uint64_t now = FlutterEngineGetCurrentTime();
+        uint64_t wakeAt = tasks_.top().targetTimeNanos;
+        if (renderCritical_) {
+            wakeAt = std::max(wakeAt, renderCriticalSinceNanos_ + kMaxRenderDeferralNanos);
+        }
+        if (wakeAt > now) {
+            wakeCondition_.wait_for(lock, std::chrono::nanoseconds(wakeAt - now));
+            continue;
+        }
+
+        const PendingTask pending = tasks_.top();
+        tasks_.pop();
+        EngineSlot& slot = engines_[pending.engineIndex];
+        --slot.queuedTasks;
+        const FlutterEngine engine = slot.engine;
+        if (engine == nullptr) {
+            continue;
+        }
+        const uint64_t latency = now - pending.targetTimeNanos;
+        lock.unlock();
+
+        const FlutterEngineResult result = FlutterEngineRunTask(engine, &pending.task);
+        if (result != kSuccess) {
+            std::cerr << "[warn] FlutterEngineRunTask failed. engine=" << pending.engineIndex
+                      << " result=" << static_cast<int32_t>(result) << "\n";
+        }
+        const uint64_t busy = FlutterEngineGetCurrentTime() - now;
+
+        lock.lock();
+        ++slot.tasksRun;
+        slot.totalLatencyNanos += static_cast<double>(latency);
+        slot.maxLatencyNanos = std::max(slot.maxLatencyNanos, latency);
+        slot.busyNanos += busy;
+    }
+}
+
+}  // namespace flutter_xr
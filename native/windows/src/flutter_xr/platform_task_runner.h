@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "flutter_embedder.h"
+
+namespace flutter_xr {
+
+// Flutter's platform task runner on a thread the runner owns, shared by up to
+// kMaxEngines engines. Engine tasks wait in one min-heap ordered by target
+// time and are handed back through FlutterEngineRunTask of the engine that
+// posted them once due. While the render thread marks itself critical, due
+// tasks are held back for a bounded time so platform work such as image
+// decoding stays out of the frame's way.
+class PlatformTaskRunner {
+   public:
+    static constexpr size_t kMaxEngines = 4;
+
+    struct Stats {
+        uint64_t tasksRun = 0;
+        size_t maxQueueDepth = 0;
+        double meanLatencyMs = 0.0;
+        double maxLatencyMs = 0.0;
+        // Platform thread time spent inside FlutterEngineRunTask.
+        double busyMs = 0.0;
+    };
+
+    PlatformTaskRunner();
+    ~PlatformTaskRunner();
+
+    PlatformTaskRunner(const PlatformTaskRunner&) = delete;
+    PlatformTaskRunner& operator=(const PlatformTaskRunner&) = delete;
+
+    // Description for FlutterCustomTaskRunners::platform_task_runner of
+    // engine `engineIndex`. It points into this object, which must outlive
+    // the engine. All engines share the thread and its identifier.
+    const FlutterTaskRunnerDescription* Description(size_t engineIndex) const {
+        return &engines_[engineIndex].description;
+    }
+
+    // Runs `work` on the platform thread and waits for it. Exceptions thrown
+    // by `work` are rethrown on the caller. Engine calls that must happen on
+    // the platform thread (run, shutdown) go through here.
+    void RunSync(const std::function<void()>& work);
+
+    // Queues `work` to run on the platform thread and returns at once. Like
+    // RunSync's work it runs ahead of engine tasks, in the order posted, and
+    // is not held back by SetRenderCritical. Exceptions it throws are logged
+    // and dropped. Engine calls made every frame (pointer events, window
+    // metrics) go through here so the render thread never waits.
+    void Post(std::function<void()> work);
+
+    // Engine tasks are only serviced once the runner is released; until then
+    // they stay queued. Tasks of an engine that is unset (not run yet or shut
+    // down) are dropped when due.
+    void SetEngine(size_t engineIndex, FlutterEngine engine);
+    void Release();
+
+    void SetRenderCritical(bool critical);
+
+    // Stops the thread and drops any tasks that have not run.
+    void Stop();
+
+    // Totals over all engines; maxQueueDepth is the deepest the shared queue
+    // got. Per engine it counts only that engine's pending tasks.
+    Stats GetStats() const;
+    Stats GetStats(size_t engineIndex) const;
+
+   private:
+    struct PendingTask {
+        uint64_t targetTimeNanos = 0;
+        uint64_t sequence = 0;
+        size_t engineIndex = 0;
+        FlutterTask task{};
+    };
+
+    struct EngineSlot {
+        PlatformTaskRunner* runner = nullptr;
+        size_t index = 0;
+        FlutterTaskRunnerDescription description{};
+        FlutterEngine engine = nullptr;
+        size_t queuedTasks = 0;
+        size_t maxQueueDepth = 0;
+        uint64_t tasksRun = 0;
+        double totalLatencyNanos = 0.0;
+        uint64_t maxLatencyNanos = 0;
+        uint64_t busyNanos = 0;
+    };
+
+    struct RunsLater {
+        bool operator()(const PendingTask& lhs, const PendingTask& rhs) const {
+            return lhs.targetTimeNanos != rhs.targetTimeNanos ? lhs.targetTimeNanos > rhs.targetTimeNanos
+                                                              : lhs.sequence > rhs.sequence;
+        }
+    };
+
+    static bool RunsTasksOnCurrentThread(void* userData);
+    static void PostTask(FlutterTask task, uint64_t targetTimeNanos, void* userData);
+
+    void ThreadMain();
+
+    std::array<EngineSlot, kMaxEngines> engines_;
+    std::thread thread_;
+    std::thread::id threadId_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeCondition_;
+    std::priority_queue<PendingTask, std::vector<PendingTask>, RunsLater> tasks_;
+    std::deque<std::function<void()>> closures_;
+    bool released_ = false;
+    bool stopping_ = false;
+    bool renderCritical_ = false;
+    uint64_t renderCriticalSinceNanos_ = 0;
+    uint64_t nextSequence_ = 0;
+    size_t maxQueueDepth_ = 0;
+};
+
+}  // namespace flutter_xr
@@ -0,0 +1,109 @@
+#include "flutter_xr/pointer_events.h"
+
+#include <algorithm>
+
+namespace flutter_xr {
+
+PointerEventBatch::PointerEventBatch(double moveThresholdPixels, double initialX, double initialY)
+    : moveThresholdSquared_(moveThresholdPixels * moveThresholdPixels),
+      lastX_(initialX),
+      lastY_(initialY),
+      viewId_(kFlutterViewId) {
+    events_.reserve(8);
+}
+
+FlutterPointerEvent& PointerEventBatch::Append(FlutterPointerPhase phase,
+                                               double xPixels,
+                                               double yPixels,
+                                               int64_t buttons) {
+    FlutterPointerEvent event{};
+    event.struct_size = sizeof(event);
+    event.phase = phase;
+    event.x = xPixels;
+    event.y = yPixels;
+    event.device = kPointerDeviceId;
+    event.signal_kind = kFlutterPointerSignalKindNone;
+    event.device_kind = kFlutterPointerDeviceKindMouse;
+    event.buttons = buttons;
+    event.view_id = viewId_;
+    events_.push_back(event);
+
+    lastX_ = xPixels;
+    lastY_ = yPixels;
+    return events_.back();
+}
+
+void PointerEventBatch::Add(FlutterPointerPhase phase, double xPixels, double yPixels, int64_t buttons) {
+    Append(phase, xPixels, yPixels, buttons);
+}
+
+bool PointerEventBatch::AddMove(double xPixels, double yPixels, int64_t buttons) {
+    const double dx = xPixels - lastX_;
+    const double dy = yPixels - lastY_;
+    if (dx * dx + dy * dy <= moveThresholdSquared_) {
+        return false;
+    }
+
+    // Only the newest position of a run of moves matters to the framework.
+    if (!events_.empty()) {
+        FlutterPointerEvent& last = events_.back();
+        const FlutterPointerPhase phase = buttons != 0 ? kMove : kHover;
+        if (last.phase == phase && last.signal_kind == kFlutterPointerSignalKindNone && last.buttons == buttons) {
+            last.x = xPixels;
+            last.y = yPixels;
+            lastX_ = xPixels;
+            lastY_ = yPixels;
+            return true;
+        }
+    }
+
+    Append(buttons != 0 ? kMove : kHover, xPixels, yPixels, buttons);
+    return true;
+}
+
+void PointerEventBatch::AddScroll(double xPixels,
+                                  double yPixels,
+                                  double deltaXPixels,
+                                  double deltaYPixels,
+                                  int64_t buttons) {
+    FlutterPointerEvent& event = Append(buttons != 0 ? kMove : kHover, xPixels, yPixels, buttons);
+    event.signal_kind = kFlutterPointerSignalKindScroll;
+    event.scroll_delta_x = deltaXPixels;
+    event.scroll_delta_y = deltaYPixels;
+}
+
+FlutterEngineResult PointerEventBatch::Submit(FlutterEngine engine, uint64_t timestampNanos) {
+    return Submit(
+        [](void* context, const FlutterPointerEvent* events, size_t count) {
+            return FlutterEngineSendPointerEvent(static_cast<FlutterEngine>(context), events, count);
+        },
+        engine, timestampNanos);
+}
+
+FlutterEngineResult PointerEventBatch::Submit(Sender send, void* context, uint64_t timestampNanos) {
+    if (events_.empty()) {
+        return kSuccess;
+    }
+
+    if (timestampNanos == 0) {
+        timestampNanos = FlutterEngineGetCurrentTime();
+    }
+    lastTimestampNanos_ = std::max(lastTimestampNanos_, timestampNanos);
+
+    // The embedder expects microseconds on the FlutterEngineGetCurrentTime clock.
+    const size_t timestamp = static_cast<size_t>(lastTimestampNanos_ / 1000);
+    for (FlutterPointerEvent& event : events_) {
+        event.timestamp = timestamp;
+    }
+
+    const FlutterEngineResult result = send(context, events_.data(), events_.size());
+    events_.clear();
+    return result;
+}
+
+void PointerEventBatch::ScalePosition(double scaleX, double scaleY) {
+    lastX_ *= scaleX;
+    lastY_ *= scaleY;
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "flutter_embedder.h"
+
+namespace flutter_xr {
+
+inline constexpr int32_t kPointerDeviceId = 1;
+inline constexpr int64_t kFlutterViewId = 0;
+
+// Collects the pointer events of one display frame so they reach the engine
+// in a single FlutterEngineSendPointerEvent call sharing one timestamp. Hover
+// and move events closer than the threshold to the last queued position are
+// dropped, so a steady controller does not wake the framework every frame.
+class PointerEventBatch {
+   public:
+    PointerEventBatch(double moveThresholdPixels, double initialX, double initialY);
+
+    void Add(FlutterPointerPhase phase, double xPixels, double yPixels, int64_t buttons);
+
+    // Queues kMove while `buttons` is non-zero and kHover otherwise. Returns
+    // false when the event was coalesced away.
+    bool AddMove(double xPixels, double yPixels, int64_t buttons);
+    void AddScroll(double xPixels, double yPixels, double deltaXPixels, double deltaYPixels, int64_t buttons);
+
+    // Sends and clears the queued events stamped with `timestampNanos` on the
+    // engine clock, or with the current time when it is 0. Timestamps never go
+    // backwards between batches. An empty batch is kSuccess.
+    FlutterEngineResult Submit(FlutterEngine engine, uint64_t timestampNanos = 0);
+
+    // Same as Submit(engine) but hands the stamped events to `send`, e.g. to
+    // forward them to an engine in another process.
+    using Sender = FlutterEngineResult (*)(void* context, const FlutterPointerEvent* events, size_t count);
+    FlutterEngineResult Submit(Sender send, void* context, uint64_t timestampNanos = 0);
+    void Clear() { events_.clear(); }
+
+    // View that events queued from now on are delivered to.
+    void SetViewId(int64_t viewId) { viewId_ = viewId; }
+    int64_t ViewId() const { return viewId_; }
+
+    void SetMoveThreshold(double moveThresholdPixels) {
+        moveThresholdSquared_ = moveThresholdPixels * moveThresholdPixels;
+    }
+
+    bool Empty() const { return events_.empty(); }
+    size_t Size() const { return events_.size(); }
+    double LastX() const { return lastX_; }
+    double LastY() const { return lastY_; }
+
+    // Keeps the last position on the same spot of the panel when the surface
+    // is resized.
+    void ScalePosition(double scaleX, double scaleY);
+
+   private:
+    FlutterPointerEvent& Append(FlutterPointerPhase phase, double xPixels, double yPixels, int64_t buttons);
+
+    double moveThresholdSquared_;
+    double lastX_;
+    double lastY_;
+    int64_t viewId_;
+    uint64_t lastTimestampNanos_ = 0;
+    std::vector<FlutterPointerEvent> events_;
+};
+
+}  // namespace flutter_xr
@@ -0,0 +1,111 @@
+#include "flutter_xr/pointer_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "flutter_xr/xr_math.h"
+
+namespace flutter_xr {
+
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+
+struct ProfileTuning {
+    const char* profile;
+    PointerFilterTuning tuning;
+};
+
+// Tracked controllers with fast IMU fusion need little smoothing; inside-out
+// tracked and emulated controllers jitter more and get a lower still cutoff.
+constexpr ProfileTuning kProfileTunings[] = {
+    {"/interaction_profiles/oculus/touch_controller", {1.2f, 10.0f, 6.0f, 1.0f, 0.75}},
+    {"/interaction_profiles/valve/index_controller", {1.2f, 10.0f, 6.0f, 1.0f, 0.75}},
+    {"/interaction_profiles/htc/vive_controller", {1.0f, 10.0f, 6.0f, 1.0f, 1.0}},
+    {"/interaction_profiles/microsoft/motion_controller", {0.7f, 8.0f, 5.0f, 1.0f, 1.5}},
+    {"/interaction_profiles/khr/simple_controller", {0.5f, 8.0f, 5.0f, 1.0f, 2.0}},
+};
+
+float SmoothingFactor(float cutoffHz, float dtSeconds) {
+    const float tau = 1.0f / (2.0f * kPi * cutoffHz);
+    return 1.0f / (1.0f + tau / dtSeconds);
+}
+
+float Lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+XrQuaternionf Nlerp(const XrQuaternionf& from, XrQuaternionf to, float t) {
+    if (from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w < 0.0f) {
+        to = {-to.x, -to.y, -to.z, -to.w};
+    }
+    XrQuaternionf result{Lerp(from.x, to.x, t), Lerp(from.y, to.y, t), Lerp(from.z, to.z, t), Lerp(from.w, to.w, t)};
+    const float length =
+        std::sqrt(result.x * result.x + result.y * result.y + result.z * result.z + result.w * result.w);
+    if (length <= 0.0f) {
+        return to;
+    }
+    return {result.x / length, result.y / length, result.z / length, result.w / length};
+}
+
+// Rotation vector (axis * angle) taking `from` to `to`, small-angle form.
+XrVector3f RotationDelta(const XrQuaternionf& from, const XrQuaternionf& to) {
+    const XrQuaternionf d = Multiply(to, Conjugate(from));
+    const float sign = d.w < 0.0f ? -2.0f : 2.0f;
+    return {d.x * sign, d.y * sign, d.z * sign};
+}
+
+float Length(const XrVector3f& value) {
+    return std::sqrt(Dot(value, value));
+}
+
+XrVector3f LerpVector(const XrVector3f& a, const XrVector3f& b, float t) {
+    return Add(a, Scale(Subtract(b, a), t));
+}
+
+}  // namespace
+
+PointerFilterTuning PointerFilterTuningForProfile(const std::string& interactionProfile) {
+    for (const ProfileTuning& entry : kProfileTunings) {
+        if (interactionProfile == entry.profile) {
+            return entry.tuning;
+        }
+    }
+    return PointerFilterTuning{};
+}
+
+XrPosef PoseFilter::Filter(double timeSeconds, const XrPosef& pose) {
+    const double dt = timeSeconds - lastTimeSeconds_;
+    if (!initialized_ || dt > kMaxGapSeconds || dt < 0.0) {
+        initialized_ = true;
+        lastTimeSeconds_ = timeSeconds;
+        filtered_ = pose;
+        linearVelocity_ = {0.0f, 0.0f, 0.0f};
+        angularVelocity_ = {0.0f, 0.0f, 0.0f};
+        return filtered_;
+    }
+    if (dt == 0.0) {
+        return filtered_;
+    }
+    lastTimeSeconds_ = timeSeconds;
+
+    // Velocities are smoothed as signed vectors, so jitter averages out and
+    // only sustained motion raises the cutoff.
+    const float dtSeconds = static_cast<float>(dt);
+    const float derivativeAlpha = SmoothingFactor(tuning_.derivativeCutoffHz, dtSeconds);
+    const float inverseDt = 1.0f / dtSeconds;
+
+    const XrVector3f linearVelocity = Scale(Subtract(pose.position, filtered_.position), inverseDt);
+    linearVelocity_ = LerpVector(linearVelocity_, linearVelocity, derivativeAlpha);
+    const float positionCutoff = tuning_.minCutoffHz + tuning_.positionBeta * Length(linearVelocity_);
+    filtered_.position = LerpVector(filtered_.position, pose.position, SmoothingFactor(positionCutoff, dtSeconds));
+
+    const XrVector3f rotation = RotationDelta(filtered_.orientation, pose.orientation);
+    const XrVector3f angularVelocity = Scale(rotation, inverseDt);
+    angularVelocity_ = LerpVector(angularVelocity_, angularVelocity, derivativeAlpha);
+    const float rotationCutoff = tuning_.minCutoffHz + tuning_.rotationBeta * Length(angularVelocity_);
+    filtered_.orientation = Nlerp(filtered_.orientation, pose.orientation, SmoothingFactor(rotationCutoff, dtSeconds));
+    return filtered_;
+}
+
+}  // namespace flutter_xr
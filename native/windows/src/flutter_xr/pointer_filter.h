@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+
+#include <openxr/openxr.h>
+
+namespace flutter_xr {
+
+// One-Euro filter parameters for an aim pose, plus the pixel hysteresis
+// applied before a filtered hit point is sent to Flutter as a move.
+struct PointerFilterTuning {
+    // Cutoff frequency while the controller is still. Lower is smoother.
+    float minCutoffHz = 1.0f;
+    // How quickly the cutoff rises with speed, per m/s and per rad/s.
+    float positionBeta = 10.0f;
+    float rotationBeta = 6.0f;
+    float derivativeCutoffHz = 1.0f;
+    // Minimum hit point travel before a move is sent, in pixels of the
+    // nominal kFlutterSurfaceWidth x kFlutterSurfaceHeight surface.
+    double hysteresisPixels = 1.0;
+};
+
+// Returns the tuning for an interaction profile path such as
+// "/interaction_profiles/oculus/touch_controller", or the default for
+// unknown or empty profiles.
+PointerFilterTuning PointerFilterTuningForProfile(const std::string& interactionProfile);
+
+// Speed-adaptive low-pass filter on a pose: heavy smoothing removes tracking
+// jitter while the controller is held still, and the cutoff opens up with
+// linear and angular speed so deliberate motion is not delayed.
+class PoseFilter {
+   public:
+    void SetTuning(const PointerFilterTuning& tuning) { tuning_ = tuning; }
+    const PointerFilterTuning& Tuning() const { return tuning_; }
+
+    // `timeSeconds` must increase between calls; a repeated time returns the
+    // previous result and a gap of more than kMaxGapSeconds restarts the filter.
+    XrPosef Filter(double timeSeconds, const XrPosef& pose);
+    void Reset() { initialized_ = false; }
+
+    static constexpr double kMaxGapSeconds = 0.25;
+
+   private:
+    PointerFilterTuning tuning_;
+    bool initialized_ = false;
+    double lastTimeSeconds_ = 0.0;
+    XrPosef filtered_{{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+    XrVector3f linearVelocity_{0.0f, 0.0f, 0.0f};
+    XrVector3f angularVelocity_{0.0f, 0.0f, 0.0f};
+};
+
+}  // namespace flutter_xr
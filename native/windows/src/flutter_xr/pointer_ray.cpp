@@ -0,0 +1,141 @@
+#include "flutter_xr/pointer_ray.h"
+
+#include <algorithm>
+#include <array>
+
+#include "flutter_xr/shared.h"
+
+namespace flutter_xr {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Taylor series for |radians| <= pi, accurate to float precision.
+constexpr double ConstexprSin(double radians) {
+    double term = radians;
+    double sum = radians;
+    for (int n = 1; n < 12; ++n) {
+        term *= -radians * radians / static_cast<double>((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double ConstexprCos(double radians) {
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 12; ++n) {
+        term *= -radians * radians / static_cast<double>((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+using SegmentTable = std::array<XrPosef, kMaxPointerRaySegments>;
+
+// Segment k is rotated about the ray (the quad's x axis). Three or more
+// segments sit on the cylinder surface; fewer cross at the ray's center.
+constexpr SegmentTable MakeSegmentTable(uint32_t segmentCount) {
+    SegmentTable table{};
+    const double step = (segmentCount >= 3 ? 2.0 : 1.0) * kPi / static_cast<double>(segmentCount);
+    const float radius = segmentCount >= 3 ? kPointerRayCylinderDiameterMeters * 0.5f : 0.0f;
+    for (uint32_t k = 0; k < segmentCount; ++k) {
+        const double halfAngle = step * static_cast<double>(k) * 0.5;
+        const XrQuaternionf rotation{static_cast<float>(ConstexprSin(halfAngle)), 0.0f, 0.0f,
+                                     static_cast<float>(ConstexprCos(halfAngle))};
+        table[k] = XrPosef{rotation, RotateVector(rotation, XrVector3f{0.0f, 0.0f, radius})};
+    }
+    return table;
+}
+
+constexpr std::array<SegmentTable, kMaxPointerRaySegments> MakeSegmentTables() {
+    std::array<SegmentTable, kMaxPointerRaySegments> tables{};
+    for (uint32_t i = 0; i < kMaxPointerRaySegments; ++i) {
+        tables[i] = MakeSegmentTable(i + 1);
+    }
+    return tables;
+}
+
+constexpr std::array<float, kMaxPointerRaySegments> MakeSegmentWidths() {
+    std::array<float, kMaxPointerRaySegments> widths{};
+    for (uint32_t i = 0; i < kMaxPointerRaySegments; ++i) {
+        const uint32_t segmentCount = i + 1;
+        if (segmentCount < 3) {
+            widths[i] = kPointerRayCylinderDiameterMeters;
+            continue;
+        }
+        const double halfSegmentAngle = kPi / static_cast<double>(segmentCount);
+        widths[i] = static_cast<float>(static_cast<double>(kPointerRayCylinderDiameterMeters) *
+                                       ConstexprSin(halfSegmentAngle) / ConstexprCos(halfSegmentAngle));
+    }
+    return widths;
+}
+
+constexpr std::array<SegmentTable, kMaxPointerRaySegments> kSegmentTables = MakeSegmentTables();
+constexpr std::array<float, kMaxPointerRaySegments> kSegmentWidths = MakeSegmentWidths();
+
+uint32_t ClampSegmentCount(uint32_t segmentCount) {
+    return std::clamp<uint32_t>(segmentCount, 1, kMaxPointerRaySegments);
+}
+
+}  // namespace
+
+const char* PointerRayModeName(PointerRayMode mode) {
+    switch (mode) {
+        case PointerRayMode::Auto:
+            return "auto";
+        case PointerRayMode::Billboard:
+            return "billboard";
+        case PointerRayMode::Cylinder:
+            return "cylinder";
+    }
+    return "unknown";
+}
+
+PointerRayLayerPlan PlanPointerRayLayers(PointerRayMode requested,
+                                         uint32_t cylinderSegments,
+                                         uint32_t rayCount,
+                                         uint32_t layerBudget,
+                                         uint32_t eyeCount) {
+    PointerRayLayerPlan plan;
+    if (rayCount == 0 || layerBudget == 0) {
+        return plan;
+    }
+
+    const uint32_t layersPerRay = std::max<uint32_t>(layerBudget / rayCount, 1);
+    plan.rayCount = std::min(rayCount, layerBudget);
+    if (requested != PointerRayMode::Cylinder && eyeCount > 0 && layersPerRay >= eyeCount) {
+        plan.mode = PointerRayMode::Billboard;
+        plan.layersPerRay = eyeCount;
+        return plan;
+    }
+
+    plan.mode = PointerRayMode::Cylinder;
+    plan.layersPerRay = std::min(ClampSegmentCount(cylinderSegments), layersPerRay);
+    return plan;
+}
+
+const XrPosef* PointerRaySegmentPoses(uint32_t segmentCount) {
+    return kSegmentTables[ClampSegmentCount(segmentCount) - 1].data();
+}
+
+float PointerRaySegmentWidthMeters(uint32_t segmentCount) {
+    return kSegmentWidths[ClampSegmentCount(segmentCount) - 1];
+}
+
+XrPosef MakeBillboardRayPose(const XrPosef& rayPose, const XrVector3f& eyePosition) {
+    const XrVector3f xAxis = RotateVector(rayPose.orientation, XrVector3f{1.0f, 0.0f, 0.0f});
+    const XrVector3f toEye = Subtract(eyePosition, rayPose.position);
+    const XrVector3f facing = Subtract(toEye, Scale(xAxis, Dot(toEye, xAxis)));
+    if (Dot(facing, facing) <= 1.0e-8f) {
+        // Looking straight along the ray; any roll shows the same edge.
+        return rayPose;
+    }
+
+    const XrVector3f zAxis = Normalize(facing);
+    const XrVector3f yAxis = Cross(zAxis, xAxis);
+    return XrPosef{QuaternionFromAxes(xAxis, yAxis, zAxis), rayPose.position};
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include <openxr/openxr.h>
+
+namespace flutter_xr {
+
+// How a pointer ray is drawn with quad layers. A billboard is one quad per
+// eye turned towards that eye; a cylinder is a ring of quads around the ray
+// (two or fewer segments form a cross of flat quads instead).
+enum class PointerRayMode : uint8_t {
+    Auto,
+    Billboard,
+    Cylinder,
+};
+
+const char* PointerRayModeName(PointerRayMode mode);
+
+inline constexpr uint32_t kMaxPointerRaySegments = 8;
+
+struct PointerRayLayerPlan {
+    PointerRayMode mode = PointerRayMode::Cylinder;
+    uint32_t layersPerRay = 0;
+    // Rays that fit the budget, in submission order.
+    uint32_t rayCount = 0;
+};
+
+// Picks the drawing for `rayCount` rays within `layerBudget` layers. Auto and
+// Billboard use billboards when the eye poses are known and every ray gets a
+// layer per eye; otherwise cylinders lose segments until the rays fit, and
+// rays that do not get even one layer are dropped.
+PointerRayLayerPlan PlanPointerRayLayers(PointerRayMode requested,
+                                         uint32_t cylinderSegments,
+                                         uint32_t rayCount,
+                                         uint32_t layerBudget,
+                                         uint32_t eyeCount);
+
+// Segment poses relative to the ray pose, from tables built at compile time.
+// `segmentCount` is clamped to [1, kMaxPointerRaySegments].
+const XrPosef* PointerRaySegmentPoses(uint32_t segmentCount);
+float PointerRaySegmentWidthMeters(uint32_t segmentCount);
+
+// Ray quad pose rolled about the ray axis so the quad faces `eyePosition`.
+XrPosef MakeBillboardRayPose(const XrPosef& rayPose, const XrVector3f& eyePosition);
+
+}  // namespace flutter_xr
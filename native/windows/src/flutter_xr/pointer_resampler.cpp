@@ -0,0 +1,78 @@
+#include "flutter_xr/pointer_resampler.h"
+
+#include <algorithm>
+
+namespace flutter_xr {
+
+namespace {
+
+double Lerp(double a, double b, double t) {
+    return a + (b - a) * t;
+}
+
+}  // namespace
+
+PointerResampler::PointerResampler(uint64_t maxExtrapolationNanos) : maxExtrapolationNanos_(maxExtrapolationNanos) {}
+
+void PointerResampler::AddSample(uint64_t timeNanos, double x, double y) {
+    if (count_ > 0) {
+        Sample& newest = samples_[count_ - 1];
+        if (timeNanos < newest.timeNanos) {
+            return;
+        }
+        if (timeNanos == newest.timeNanos) {
+            newest.x = x;
+            newest.y = y;
+            return;
+        }
+    }
+
+    if (count_ == kMaxSamples) {
+        std::move(samples_.begin() + 1, samples_.end(), samples_.begin());
+        --count_;
+    }
+    samples_[count_++] = Sample{timeNanos, x, y};
+}
+
+bool PointerResampler::Resample(uint64_t targetNanos, double* outX, double* outY) const {
+    if (count_ == 0 || targetNanos < samples_[0].timeNanos) {
+        return false;
+    }
+
+    const Sample& newest = samples_[count_ - 1];
+    if (count_ == 1 || targetNanos == newest.timeNanos) {
+        *outX = newest.x;
+        *outY = newest.y;
+        return true;
+    }
+
+    if (targetNanos < newest.timeNanos) {
+        size_t next = 1;
+        while (samples_[next].timeNanos < targetNanos) {
+            ++next;
+        }
+        const Sample& a = samples_[next - 1];
+        const Sample& b = samples_[next];
+        const double t = static_cast<double>(targetNanos - a.timeNanos) / static_cast<double>(b.timeNanos - a.timeNanos);
+        *outX = Lerp(a.x, b.x, t);
+        *outY = Lerp(a.y, b.y, t);
+        return true;
+    }
+
+    const Sample& previous = samples_[count_ - 2];
+    const uint64_t interval = newest.timeNanos - previous.timeNanos;
+    const uint64_t ahead = std::min({targetNanos - newest.timeNanos, interval, maxExtrapolationNanos_});
+    const double t = 1.0 + static_cast<double>(ahead) / static_cast<double>(interval);
+    *outX = Lerp(previous.x, newest.x, t);
+    *outY = Lerp(previous.y, newest.y, t);
+    return true;
+}
+
+void PointerResampler::ScalePositions(double scaleX, double scaleY) {
+    for (size_t i = 0; i < count_; ++i) {
+        samples_[i].x *= scaleX;
+        samples_[i].y *= scaleY;
+    }
+}
+
+}  // namespace flutter_xr
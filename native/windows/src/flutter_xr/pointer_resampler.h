@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter_xr {
+
+// Keeps the last few pointer hit positions with the engine-clock time their
+// pose is valid for, and estimates the position at another time. Targets
+// between samples are interpolated; targets past the newest sample are
+// extrapolated from the last two, at most one sample interval and
+// `maxExtrapolationNanos` ahead.
+class PointerResampler {
+   public:
+    static constexpr size_t kMaxSamples = 4;
+    static constexpr uint64_t kDefaultMaxExtrapolationNanos = 8000000;
+
+    explicit PointerResampler(uint64_t maxExtrapolationNanos = kDefaultMaxExtrapolationNanos);
+
+    // Samples must arrive in time order; one with the same time as the newest
+    // replaces it and an older one is ignored.
+    void AddSample(uint64_t timeNanos, double x, double y);
+
+    // Returns false when there are no samples or the target is older than the
+    // oldest one kept.
+    bool Resample(uint64_t targetNanos, double* outX, double* outY) const;
+
+    void Reset() { count_ = 0; }
+    void ScalePositions(double scaleX, double scaleY);
+
+   private:
+    struct Sample {
+        uint64_t timeNanos = 0;
+        double x = 0.0;
+        double y = 0.0;
+    };
+
+    uint64_t maxExtrapolationNanos_;
+    std::array<Sample, kMaxSamples> samples_{};
+    size_t count_ = 0;
+};
+
+}  // namespace flutter_xr
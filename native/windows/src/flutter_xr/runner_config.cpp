@@ -0,0 +1,226 @@
+#include "flutter_xr/runner_config.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace flutter_xr {
+
+namespace {
+
+bool ParseBoolOption(const std::string& name, const std::string& value) {
+    if (value == "1" || value == "true" || value == "on") {
+        return true;
+    }
+    if (value == "0" || value == "false" || value == "off") {
+        return false;
+    }
+    throw std::runtime_error("Invalid value for --" + name + ": " + value + " (expected on/off)");
+}
+
+size_t ParseCountOption(const std::string& name, const std::string& value) {
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.size() > 6) {
+        throw std::runtime_error("Invalid value for --" + name + ": " + value + " (expected a non-negative integer)");
+    }
+    return static_cast<size_t>(std::stoul(value));
+}
+
+uint32_t ParseUint32Option(const std::string& name, const std::string& value) {
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.size() > 10 ||
+        std::stoull(value) > 0xffffffffull) {
+        throw std::runtime_error("Invalid value for --" + name + ": " + value + " (expected a 32-bit unsigned integer)");
+    }
+    return static_cast<uint32_t>(std::stoull(value));
+}
+
+double ParseRangeOption(const std::string& name, const std::string& value, double maxValue, const char* unit) {
+    size_t parsed = 0;
+    double result = 0.0;
+    try {
+        result = std::stod(value, &parsed);
+    } catch (const std::exception&) {
+        parsed = 0;
+    }
+    if (parsed == 0 || parsed != value.size() || !(result >= 0.0) || result > maxValue) {
+        std::ostringstream expected;
+        expected << " (expected " << unit << " between 0 and " << maxValue << ")";
+        throw std::runtime_error("Invalid value for --" + name + ": " + value + expected.str());
+    }
+    return result;
+}
+
+double ParseMillisecondsOption(const std::string& name, const std::string& value) {
+    return ParseRangeOption(name, value, 1000.0, "milliseconds");
+}
+
+double ParsePixelsOption(const std::string& name, const std::string& value) {
+    return ParseRangeOption(name, value, 100.0, "pixels");
+}
+
+double ParseSecondsOption(const std::string& name, const std::string& value) {
+    return ParseRangeOption(name, value, 3600.0, "seconds");
+}
+
+std::vector<std::string> ParseEntrypointList(const std::string& name, const std::string& value) {
+    std::vector<std::string> entrypoints;
+    size_t begin = 0;
+    while (begin <= value.size()) {
+        const size_t end = std::min(value.find(',', begin), value.size());
+        const std::string entrypoint = value.substr(begin, end - begin);
+        if (entrypoint.empty() || entrypoint.find_first_not_of("abcdefghijklmnopqrstuvwxyz"
+                                                               "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                                               "0123456789_$") != std::string::npos) {
+            throw std::runtime_error("Invalid value for --" + name + ": " + value +
+                                     " (expected comma-separated Dart function names)");
+        }
+        entrypoints.push_back(entrypoint);
+        begin = end + 1;
+    }
+    if (entrypoints.size() > kMaxFlutterEngines) {
+        throw std::runtime_error("Invalid value for --" + name + ": " + value + " (at most " +
+                                 std::to_string(kMaxFlutterEngines) + " engines)");
+    }
+    return entrypoints;
+}
+
+}  // namespace
+
+RunnerConfig ParseRunnerConfig(int argc, const char* const* argv) {
+    RunnerConfig config;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i] == nullptr ? std::string() : std::string(argv[i]);
+        if (arg.rfind("--", 0) != 0) {
+            throw std::runtime_error("Unexpected runner argument: " + arg);
+        }
+
+        const size_t separator = arg.find('=');
+        const std::string name = arg.substr(2, separator == std::string::npos ? std::string::npos : separator - 2);
+        const std::string value = separator == std::string::npos ? std::string("on") : arg.substr(separator + 1);
+
+        if (name == "flutter-compositor") {
+            config.useFlutterCompositor = ParseBoolOption(name, value);
+        } else if (name == "engines") {
+            config.engineEntrypoints = ParseEntrypointList(name, value);
+        } else if (name == "engine-stats-interval") {
+            config.engineStatsIntervalSeconds = ParseSecondsOption(name, value);
+        } else if (name == "engine-process") {
+            config.useEngineProcess = ParseBoolOption(name, value);
+        } else if (name == "engine-child") {
+            config.engineChildChannel = value;
+        } else if (name == "engine-parent") {
+            config.engineParentProcessId = ParseUint32Option(name, value);
+        } else if (name == "engine-generation") {
+            config.engineGeneration = ParseUint32Option(name, value);
+        } else if (name == "views") {
+            config.flutterViews = ParseCountOption(name, value);
+            if (config.flutterViews < 1 || config.flutterViews > kMaxFlutterViews) {
+                throw std::runtime_error("Invalid value for --" + name + ": " + value + " (expected 1 to " +
+                                         std::to_string(kMaxFlutterViews) + ")");
+            }
+        } else if (name == "worker-threads") {
+            config.workerThreads = value == "auto" ? 0 : ParseCountOption(name, value);
+        } else if (name == "flutter-vsync") {
+            config.useFlutterVsync = ParseBoolOption(name, value);
+        } else if (name == "idle-frame-elision") {
+            config.elideIdleFrames = ParseBoolOption(name, value);
+        } else if (name == "adaptive-resolution") {
+            config.adaptiveResolution = ParseBoolOption(name, value);
+        } else if (name == "content-crop") {
+            config.cropToContent = ParseBoolOption(name, value);
+        } else if (name == "raster-lead-ms") {
+            config.rasterLeadMs = ParseMillisecondsOption(name, value);
+        } else if (name == "late-latch-rays") {
+            config.lateLatchPointerRays = ParseBoolOption(name, value);
+        } else if (name == "ray-mode") {
+            if (value == "auto") {
+                config.pointerRayMode = PointerRayMode::Auto;
+            } else if (value == "billboard") {
+                config.pointerRayMode = PointerRayMode::Billboard;
+            } else if (value == "cylinder") {
+                config.pointerRayMode = PointerRayMode::Cylinder;
+            } else {
+                throw std::runtime_error("Invalid value for --" + name + ": " + value +
+                                         " (expected auto/billboard/cylinder)");
+            }
+        } else if (name == "ray-segments") {
+            const size_t segments = ParseCountOption(name, value);
+            if (segments < 1 || segments > kMaxPointerRaySegments) {
+                throw std::runtime_error("Invalid value for --" + name + ": " + value + " (expected 1 to " +
+                                         std::to_string(kMaxPointerRaySegments) + ")");
+            }
+            config.pointerRaySegments = static_cast<uint32_t>(segments);
+        } else if (name == "ray-layer-budget") {
+            config.pointerRayLayerBudget = static_cast<uint32_t>(ParseCountOption(name, value));
+        } else if (name == "pointer-move-threshold") {
+            config.pointerMoveThresholdPx = ParsePixelsOption(name, value);
+        } else if (name == "pointer-filter") {
+            config.filterPointerPose = ParseBoolOption(name, value);
+        } else if (name == "pointer-resampling") {
+            config.resamplePointer = ParseBoolOption(name, value);
+        } else if (name == "frame-pipeline-depth") {
+            config.framePipelineDepth = ParseCountOption(name, value);
+            if (config.framePipelineDepth < 1 || config.framePipelineDepth > 2) {
+                throw std::runtime_error("Invalid value for --" + name + ": " + value + " (expected 1 or 2)");
+            }
+        } else if (name == "upload-budget-kb") {
+            config.uploadBudgetKb = ParseCountOption(name, value);
+        } else if (name == "upload-budget-ms") {
+            config.uploadBudgetMs = ParseMillisecondsOption(name, value);
+        } else {
+            throw std::runtime_error("Unknown runner option: --" + name);
+        }
+    }
+
+    // Only the implicit view can be presented through surface_present_callback.
+    if (config.flutterViews > 1 && !config.useFlutterCompositor) {
+        throw std::runtime_error("--views above 1 requires --flutter-compositor=on");
+    }
+    if (config.flutterViews * config.engineEntrypoints.size() > kMaxFlutterViews) {
+        throw std::runtime_error("--engines times --views must not exceed " + std::to_string(kMaxFlutterViews) +
+                                 " panels");
+    }
+    // The engine process hosts exactly one engine with its implicit view.
+    if (config.useEngineProcess && (config.flutterViews > 1 || config.engineEntrypoints.size() > 1)) {
+        throw std::runtime_error("--engine-process=on supports a single engine with a single view");
+    }
+    if (!config.engineChildChannel.empty() && config.engineParentProcessId == 0) {
+        throw std::runtime_error("--engine-child requires --engine-parent");
+    }
+    return config;
+}
+
+std::string DescribeRunnerConfig(const RunnerConfig& config) {
+    std::ostringstream oss;
+    oss << "flutter-compositor=" << (config.useFlutterCompositor ? "on" : "off");
+    oss << " engines=";
+    for (size_t i = 0; i < config.engineEntrypoints.size(); ++i) {
+        oss << (i > 0 ? "," : "") << config.engineEntrypoints[i];
+    }
+    oss << " views=" << config.flutterViews;
+    oss << " engine-stats-interval=" << config.engineStatsIntervalSeconds;
+    oss << " engine-process=" << (config.useEngineProcess ? "on" : "off");
+    oss << " worker-threads=";
+    if (config.workerThreads == 0) {
+        oss << "auto";
+    } else {
+        oss << config.workerThreads;
+    }
+    oss << " flutter-vsync=" << (config.useFlutterVsync ? "on" : "off");
+    oss << " raster-lead-ms=" << config.rasterLeadMs;
+    oss << " idle-frame-elision=" << (config.elideIdleFrames ? "on" : "off");
+    oss << " adaptive-resolution=" << (config.adaptiveResolution ? "on" : "off");
+    oss << " content-crop=" << (config.cropToContent ? "on" : "off");
+    oss << " late-latch-rays=" << (config.lateLatchPointerRays ? "on" : "off");
+    oss << " ray-mode=" << PointerRayModeName(config.pointerRayMode);
+    oss << " ray-segments=" << config.pointerRaySegments;
+    oss << " ray-layer-budget=" << config.pointerRayLayerBudget;
+    oss << " pointer-move-threshold=" << config.pointerMoveThresholdPx;
+    oss << " pointer-filter=" << (config.filterPointerPose ? "on" : "off");
+    oss << " pointer-resampling=" << (config.resamplePointer ? "on" : "off");
+    oss << " frame-pipeline-depth=" << config.framePipelineDepth;
+    oss << " upload-budget-kb=" << config.uploadBudgetKb;
+    oss << " upload-budget-ms=" << config.uploadBudgetMs;
+    return oss.str();
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "flutter_xr/pointer_ray.h"
+
+namespace flutter_xr {
+
+// Upper bound of panels over all engines. Each view is a quad panel with its
+// own swapchain.
+inline constexpr size_t kMaxFlutterViews = 4;
+inline constexpr size_t kMaxFlutterEngines = 4;
+
+struct RunnerConfig {
+    // Let Flutter rasterize into runner-owned backing stores instead of copying
+    // the software surface in surface_present_callback.
+    bool useFlutterCompositor = true;
+
+    // Dart entrypoints of the bundle, each run in its own engine (isolate
+    // group) with its own panels. Engines share the AOT data, ICU data,
+    // platform thread, pixel workers and upload budget.
+    std::vector<std::string> engineEntrypoints{"main"};
+
+    // Flutter views per engine, shown as panels side by side around the
+    // user. View 0 is the implicit view; further views are added through the
+    // embedder multi-view API and need the compositor.
+    size_t flutterViews = 1;
+
+    // How often per-engine frame, upload, platform task and memory totals are
+    // logged, in seconds. 0 logs them only at exit.
+    double engineStatsIntervalSeconds = 0.0;
+
+    // Run the Flutter engine in a child process that hands frames over
+    // through shared memory, so a stalled or crashed Dart app cannot stop the
+    // XR frame loop. The child is restarted when it exits.
+    bool useEngineProcess = false;
+
+    // Set by the runner on the engine process it starts: the shared-memory
+    // channel to attach to, the runner's process id and the restart count.
+    std::string engineChildChannel;
+    uint32_t engineParentProcessId = 0;
+    uint32_t engineGeneration = 0;
+
+    // Threads sharing CPU pixel work, including the calling thread. 0 sizes
+    // the pool from the hardware; 1 keeps all pixel work on the caller.
+    size_t workerThreads = 0;
+
+    // Answer Flutter's vsync requests from the xrWaitFrame timeline so frames
+    // are produced in phase with the headset display.
+    bool useFlutterVsync = true;
+
+    // Resubmit the last released quad swapchain image when Flutter produced
+    // nothing new instead of acquiring and copying into a fresh one.
+    bool elideIdleFrames = true;
+
+    // Scale the Flutter surface's pixel density with viewing distance and
+    // raster cost. When off the surface stays at its nominal resolution.
+    bool adaptiveResolution = true;
+
+    // Submit only the non-transparent part of the Flutter surface and skip
+    // uploading the transparent margin around it.
+    bool cropToContent = true;
+
+    // How long before the render thread samples the next frame Flutter's
+    // frame should be finished, in milliseconds.
+    double rasterLeadMs = 2.0;
+
+    // Re-locate the controllers right before xrEndFrame and draw the pointer
+    // rays from that later sample. Flutter input keeps the early sample.
+    bool lateLatchPointerRays = true;
+
+    // How pointer rays are drawn and how many quad layers they may use per
+    // frame. Auto draws eye-facing billboards when they fit and otherwise a
+    // cylinder of at most pointerRaySegments quads per ray.
+    PointerRayMode pointerRayMode = PointerRayMode::Auto;
+    uint32_t pointerRaySegments = 6;
+    uint32_t pointerRayLayerBudget = 4;
+
+    // Hover and move events closer than this many physical pixels to the
+    // last one sent are dropped. 0 sends every change of the hit point.
+    double pointerMoveThresholdPx = 0.5;
+
+    // Smooth controller aim poses with a speed-adaptive low-pass filter and
+    // apply per-interaction-profile hysteresis on top of the move threshold.
+    bool filterPointerPose = true;
+
+    // Interpolate or extrapolate pointer moves to the target time of the
+    // frame Flutter is producing instead of sending the latest raw sample.
+    bool resamplePointer = false;
+
+    // Frames in flight between xrWaitFrame and xrEndFrame. 1 waits and
+    // renders on one thread; 2 waits for the next frame on its own thread
+    // while the render thread finishes the current one.
+    size_t framePipelineDepth = 1;
+
+    // Per-frame budget for background texture uploads, spread in row bands
+    // over as many frames as needed. Flutter panel uploads are charged first.
+    size_t uploadBudgetKb = 1024;
+    double uploadBudgetMs = 1.0;
+};
+
+// Parses `--name=value` options passed to flutter_open_xr_runner. Throws
+// std::runtime_error for unknown options or malformed values.
+RunnerConfig ParseRunnerConfig(int argc, const char* const* argv);
+std::string DescribeRunnerConfig(const RunnerConfig& config);
+
+}  // namespace flutter_xr
@@ -158,14 +158,19 @@ ScopedComInitializer::~ScopedComInitializer() {
     }
 }
 
-std::filesystem::path GetExecutableDir() {
+std::filesystem::path GetExecutablePath() {
     std::wstring buffer(MAX_PATH, L'\0');
     const DWORD copied = GetModuleFileNameW(nullptr, buffer.data(), static_cast<DWORD>(buffer.size()));
     if (copied == 0 || copied == MAX_PATH) {
-        return std::filesystem::current_path();
+        return std::filesystem::path();
     }
     buffer.resize(copied);
-    return std::filesystem::path(buffer).parent_path();
+    return std::filesystem::path(buffer);
+}
+
+std::filesystem::path GetExecutableDir() {
+    const std::filesystem::path executable = GetExecutablePath();
+    return executable.empty() ? std::filesystem::current_path() : executable.parent_path();
 }
 
 std::string WideToUtf8(const std::wstring& wide) {
@@ -196,130 +201,38 @@ std::wstring Utf8ToWide(const std::string& utf8) {
     return out;
 }
 
-XrVector3f Add(const XrVector3f& lhs, const XrVector3f& rhs) {
-    return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
-}
-
-XrVector3f Subtract(const XrVector3f& lhs, const XrVector3f& rhs) {
-    return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
-}
-
-XrVector3f Scale(const XrVector3f& value, float scale) {
-    return {value.x * scale, value.y * scale, value.z * scale};
-}
-
-float Dot(const XrVector3f& lhs, const XrVector3f& rhs) {
-    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
-}
-
-XrVector3f Cross(const XrVector3f& lhs, const XrVector3f& rhs) {
-    return {
-        lhs.y * rhs.z - lhs.z * rhs.y,
-        lhs.z * rhs.x - lhs.x * rhs.z,
-        lhs.x * rhs.y - lhs.y * rhs.x,
-    };
-}
-
-XrQuaternionf Conjugate(const XrQuaternionf& value) {
-    return {-value.x, -value.y, -value.z, value.w};
-}
-
-XrQuaternionf Multiply(const XrQuaternionf& lhs, const XrQuaternionf& rhs) {
-    return {
-        lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y,
-        lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x,
-        lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w,
-        lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z,
-    };
-}
-
-XrVector3f RotateVector(const XrQuaternionf& rotation, const XrVector3f& value) {
-    const XrVector3f qv{rotation.x, rotation.y, rotation.z};
-    const XrVector3f term1 = Scale(qv, 2.0f * Dot(qv, value));
-    const XrVector3f term2 = Scale(value, rotation.w * rotation.w - Dot(qv, qv));
-    const XrVector3f term3 = Scale(Cross(qv, value), 2.0f * rotation.w);
-    return Add(Add(term1, term2), term3);
-}
-
-XrVector3f Normalize(const XrVector3f& value) {
-    const float lengthSquared = Dot(value, value);
-    if (lengthSquared <= 1.0e-8f) {
-        return {0.0f, 0.0f, -1.0f};
-    }
-    const float invLength = 1.0f / std::sqrt(lengthSquared);
-    return Scale(value, invLength);
-}
-
-bool IntersectRayWithQuad(const XrVector3f& rayOriginWorld,
-                          const XrVector3f& rayDirectionWorld,
-                          const XrPosef& quadPoseWorld,
-                          float quadWidthMeters,
-                          float quadHeightMeters,
-                          float* outHitDistanceMeters,
-                          double* outU,
-                          double* outV) {
-    if (outU == nullptr || outV == nullptr || quadWidthMeters <= 0.0f || quadHeightMeters <= 0.0f) {
-        return false;
-    }
-
-    const XrQuaternionf invQuadOrientation = Conjugate(quadPoseWorld.orientation);
-    const XrVector3f rayOriginLocal = RotateVector(invQuadOrientation, Subtract(rayOriginWorld, quadPoseWorld.position));
-    const XrVector3f rayDirectionLocal = RotateVector(invQuadOrientation, rayDirectionWorld);
-
-    if (std::abs(rayDirectionLocal.z) < 1.0e-6f) {
-        return false;
-    }
-
-    const float t = -rayOriginLocal.z / rayDirectionLocal.z;
-    if (t <= 0.0f) {
-        return false;
-    }
-
-    const XrVector3f hit = Add(rayOriginLocal, Scale(rayDirectionLocal, t));
-    const float halfWidth = quadWidthMeters * 0.5f;
-    const float halfHeight = quadHeightMeters * 0.5f;
-    if (std::abs(hit.x) > halfWidth || std::abs(hit.y) > halfHeight) {
-        return false;
-    }
+XrPosef MakePanelPose(size_t index, size_t count) {
+    // Neighbouring panels are tangent to the arc and meet kPanelGapMeters
+    // apart at their edges.
+    const float step = 2.0f * std::atan((kQuadWidthMeters * 0.5f + kPanelGapMeters) / kQuadDistanceMeters);
+    const float angle = (static_cast<float>(index) - static_cast<float>(count > 0 ? count - 1 : 0) * 0.5f) * step;
 
-    *outU = static_cast<double>(hit.x / quadWidthMeters + 0.5f);
-    *outV = static_cast<double>(0.5f - hit.y / quadHeightMeters);
-    if (outHitDistanceMeters != nullptr) {
-        *outHitDistanceMeters = t;
-    }
-    return true;
-}
-
-bool ConvertRgbaToBgra(const uint8_t* source,
-                       size_t sourceRowBytes,
-                       size_t width,
-                       size_t height,
-                       std::vector<uint8_t>& outPixels) {
-    if (source == nullptr || width == 0 || height == 0 || sourceRowBytes < width * 4) {
-        return false;
-    }
-
-    outPixels.resize(width * height * 4);
-    for (size_t y = 0; y < height; ++y) {
-        const uint8_t* src = source + y * sourceRowBytes;
-        uint8_t* dst = outPixels.data() + y * width * 4;
-        for (size_t x = 0; x < width; ++x) {
-            dst[x * 4 + 0] = src[x * 4 + 2];
-            dst[x * 4 + 1] = src[x * 4 + 1];
-            dst[x * 4 + 2] = src[x * 4 + 0];
-            dst[x * 4 + 3] = src[x * 4 + 3];
-        }
-    }
-    return true;
-}
-
-XrPosef MakeQuadPose() {
     XrPosef pose{};
-    pose.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
-    pose.position = {0.0f, 0.0f, -kQuadDistanceMeters};
+    pose.orientation = {0.0f, std::sin(-angle * 0.5f), 0.0f, std::cos(-angle * 0.5f)};
+    pose.position = {kQuadDistanceMeters * std::sin(angle), 0.0f, -kQuadDistanceMeters * std::cos(angle)};
     return pose;
 }
 
+PanelGeometry MakePanelGeometry(const XrPosef& panelPose,
+                                int32_t surfaceWidth,
+                                int32_t surfaceHeight,
+                                const XrRect2Di& imageRect) {
+    PanelGeometry geometry;
+    geometry.imageRect = imageRect;
+    geometry.u0 = static_cast<double>(imageRect.offset.x) / static_cast<double>(surfaceWidth);
+    geometry.v0 = static_cast<double>(imageRect.offset.y) / static_cast<double>(surfaceHeight);
+    geometry.uSpan = static_cast<double>(imageRect.extent.width) / static_cast<double>(surfaceWidth);
+    geometry.vSpan = static_cast<double>(imageRect.extent.height) / static_cast<double>(surfaceHeight);
+    geometry.size = {kQuadWidthMeters * static_cast<float>(geometry.uSpan), kQuadHeightMeters * static_cast<float>(geometry.vSpan)};
+
+    // Image v grows downwards while the quad's local y axis points up.
+    const float centerX = static_cast<float>(geometry.u0 + geometry.uSpan * 0.5 - 0.5) * kQuadWidthMeters;
+    const float centerY = static_cast<float>(0.5 - (geometry.v0 + geometry.vSpan * 0.5)) * kQuadHeightMeters;
+    geometry.pose.orientation = panelPose.orientation;
+    geometry.pose.position = Add(panelPose.position, RotateVector(panelPose.orientation, XrVector3f{centerX, centerY, 0.0f}));
+    return geometry;
+}
+
 XrPosef MakeGroundPose() {
     XrPosef pose{};
     pose.orientation = {-0.70710677f, 0.0f, 0.0f, 0.70710677f};
@@ -5,6 +5,7 @@
 #include <windows.h>
 #include <wrl/client.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <string>
@@ -13,6 +14,8 @@
 #include <openxr/openxr.h>
 #include <openxr/openxr_platform.h>
 
+#include "flutter_xr/xr_math.h"
+
 namespace flutter_xr {
 
 using Microsoft::WRL::ComPtr;
@@ -23,6 +26,7 @@ inline constexpr float kQuadWidthMeters = 1.2f;
 inline constexpr float kQuadHeightMeters =
     kQuadWidthMeters * (static_cast<float>(kFlutterSurfaceHeight) / static_cast<float>(kFlutterSurfaceWidth));
 inline constexpr float kQuadDistanceMeters = 1.2f;
+inline constexpr float kPanelGapMeters = 0.05f;
 inline constexpr int32_t kBackgroundTextureWidth = 1024;
 inline constexpr int32_t kBackgroundTextureHeight = 1024;
 inline constexpr float kGroundQuadWidthMeters = 160.0f;
@@ -33,17 +37,13 @@ inline constexpr int32_t kPointerRayTextureWidth = 256;
 inline constexpr int32_t kPointerRayTextureHeight = 8;
 inline constexpr float kPointerRayThicknessMeters = 0.01f;
 inline constexpr float kPointerRayCylinderDiameterMeters = kPointerRayThicknessMeters * 0.6f;
-inline constexpr uint32_t kPointerRayCylinderSegmentCount = 6;
 inline constexpr float kPointerRayFallbackLengthMeters = 2.0f;
 inline constexpr float kPointerRayMinLengthMeters = 0.05f;
-inline constexpr DWORD kFirstFrameTimeoutMs = 15000;
 inline constexpr float kTriggerPressThreshold = 0.75f;
 inline constexpr float kTriggerReleaseThreshold = 0.65f;
 inline constexpr float kScrollAxisDeadzone = 0.2f;
 inline constexpr double kScrollPixelsPerFrame = 18.0;
 inline constexpr double kScrollDeltaEpsilonPixels = 0.01;
-inline constexpr int32_t kPointerDeviceId = 1;
-inline constexpr int64_t kFlutterViewId = 0;
 
 std::string HResultToString(HRESULT hr);
 void ThrowIfFailed(HRESULT hr, const char* call);
@@ -69,36 +69,35 @@ class ScopedComInitializer {
     bool initialized_ = false;
 };
 
+// Empty when the path does not fit MAX_PATH.
+std::filesystem::path GetExecutablePath();
 std::filesystem::path GetExecutableDir();
 std::string WideToUtf8(const std::wstring& wide);
 std::wstring Utf8ToWide(const std::string& utf8);
 
-XrVector3f Add(const XrVector3f& lhs, const XrVector3f& rhs);
-XrVector3f Subtract(const XrVector3f& lhs, const XrVector3f& rhs);
-XrVector3f Scale(const XrVector3f& value, float scale);
-float Dot(const XrVector3f& lhs, const XrVector3f& rhs);
-XrVector3f Cross(const XrVector3f& lhs, const XrVector3f& rhs);
-XrQuaternionf Conjugate(const XrQuaternionf& value);
-XrQuaternionf Multiply(const XrQuaternionf& lhs, const XrQuaternionf& rhs);
-XrVector3f RotateVector(const XrQuaternionf& rotation, const XrVector3f& value);
-XrVector3f Normalize(const XrVector3f& value);
-
-bool IntersectRayWithQuad(const XrVector3f& rayOriginWorld,
-                          const XrVector3f& rayDirectionWorld,
-                          const XrPosef& quadPoseWorld,
-                          float quadWidthMeters,
-                          float quadHeightMeters,
-                          float* outHitDistanceMeters,
-                          double* outU,
-                          double* outV);
-
-bool ConvertRgbaToBgra(const uint8_t* source,
-                       size_t sourceRowBytes,
-                       size_t width,
-                       size_t height,
-                       std::vector<uint8_t>& outPixels);
-
-XrPosef MakeQuadPose();
+// Pose of panel `index` out of `count`, placed left to right on an arc at
+// kQuadDistanceMeters and turned to face the origin. A single panel sits
+// straight ahead.
+XrPosef MakePanelPose(size_t index, size_t count);
 XrPosef MakeGroundPose();
 
+// Placement of the Flutter panel when only `imageRect` of a
+// surfaceWidth x surfaceHeight surface is submitted. The region keeps the
+// position and pixel density it has on the full panel.
+struct PanelGeometry {
+    XrPosef pose{};
+    XrExtent2Df size{};
+    XrRect2Di imageRect{};
+    // Offset and extent of imageRect as fractions of the full surface.
+    double u0 = 0.0;
+    double v0 = 0.0;
+    double uSpan = 1.0;
+    double vSpan = 1.0;
+};
+
+PanelGeometry MakePanelGeometry(const XrPosef& panelPose,
+                                int32_t surfaceWidth,
+                                int32_t surfaceHeight,
+                                const XrRect2Di& imageRect);
+
 }  // namespace flutter_xr
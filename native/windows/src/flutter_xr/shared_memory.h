@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace flutter_xr {
+
+// Named memory shared between processes. shared_memory_win32.cpp backs it
+// with a pagefile mapping and shared_memory_linux.cpp with a POSIX shm object.
+class SharedMemoryMapping {
+   public:
+    // Throws std::runtime_error when a mapping of that name already exists
+    // or cannot be created. The mapping starts zeroed.
+    static std::unique_ptr<SharedMemoryMapping> Create(const std::string& name, size_t bytes);
+    // Throws std::runtime_error when no mapping of that name exists.
+    static std::unique_ptr<SharedMemoryMapping> Open(const std::string& name);
+
+    ~SharedMemoryMapping();
+
+    SharedMemoryMapping(const SharedMemoryMapping&) = delete;
+    SharedMemoryMapping& operator=(const SharedMemoryMapping&) = delete;
+
+    void* Data() const { return data_; }
+    // At least the size passed to Create; may be rounded up to whole pages.
+    size_t Size() const { return size_; }
+
+   private:
+    SharedMemoryMapping() = default;
+
+    std::string name_;
+    void* handle_ = nullptr;
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    bool owner_ = false;
+};
+
+// State word a SharedSignal keeps in shared memory. Zero-initialized is unset.
+struct SharedSignalWord {
+    std::atomic<uint32_t> state{0};
+};
+
+// Auto-reset event between processes: Set wakes one Wait, or the next one
+// if nobody is waiting. On Windows it is a named event and `word` is unused;
+// on Linux the waiter sleeps on a futex on `word`, which must be in memory
+// both processes map.
+class SharedSignal {
+   public:
+    static constexpr uint32_t kWaitForever = 0xffffffffu;
+
+    // Throws std::runtime_error when the event cannot be created or opened.
+    static std::unique_ptr<SharedSignal> Create(const std::string& name, SharedSignalWord* word);
+    static std::unique_ptr<SharedSignal> Open(const std::string& name, SharedSignalWord* word);
+
+    ~SharedSignal();
+
+    SharedSignal(const SharedSignal&) = delete;
+    SharedSignal& operator=(const SharedSignal&) = delete;
+
+    void Set();
+    // Returns false when `timeoutMs` passed without the signal being set.
+    bool Wait(uint32_t timeoutMs) const;
+
+    // The event HANDLE on Windows, for waits on several objects at once;
+    // nullptr elsewhere.
+    void* NativeHandle() const { return handle_; }
+
+   private:
+    explicit SharedSignal(SharedSignalWord* word) : word_(word) {}
+
+    SharedSignalWord* word_;
+    void* handle_ = nullptr;
+};
+
+}  // namespace flutter_xr
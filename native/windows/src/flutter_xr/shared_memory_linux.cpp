@@ -0,0 +1,161 @@
+#include "flutter_xr/shared_memory.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+namespace flutter_xr {
+
+namespace {
+
+// SharedSignalWord states. kWaiting is unset with a waiter asleep on the
+// futex, so Set only makes the wake syscall when someone needs it.
+constexpr uint32_t kUnset = 0;
+constexpr uint32_t kSet = 1;
+constexpr uint32_t kWaiting = 2;
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+              "the futex word is waited on as a plain 32-bit integer");
+
+// POSIX shm names are a single path component starting with '/'.
+std::string ShmName(const std::string& name) {
+    std::string shmName = "/" + name;
+    for (size_t i = 1; i < shmName.size(); ++i) {
+        if (shmName[i] == '/' || shmName[i] == '\\') {
+            shmName[i] = '_';
+        }
+    }
+    return shmName;
+}
+
+std::string ErrnoText() {
+    return std::to_string(errno) + " (" + std::strerror(errno) + ")";
+}
+
+// Shared, not FUTEX_PRIVATE_FLAG: the waker is another process.
+long Futex(std::atomic<uint32_t>* word, int operation, uint32_t value, const timespec* timeout) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), operation, value, timeout, nullptr, 0);
+}
+
+}  // namespace
+
+std::unique_ptr<SharedMemoryMapping> SharedMemoryMapping::Create(const std::string& name, size_t bytes) {
+    std::unique_ptr<SharedMemoryMapping> mapping(new SharedMemoryMapping());
+    mapping->name_ = ShmName(name);
+    const int fd = shm_open(mapping->name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open failed for " + name + ". error=" + ErrnoText());
+    }
+    mapping->owner_ = true;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        const std::string error = ErrnoText();
+        close(fd);
+        throw std::runtime_error("ftruncate failed for " + name + ". error=" + error);
+    }
+    void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const std::string error = ErrnoText();
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("mmap failed for " + name + ". error=" + error);
+    }
+    mapping->data_ = data;
+    mapping->size_ = bytes;
+    return mapping;
+}
+
+std::unique_ptr<SharedMemoryMapping> SharedMemoryMapping::Open(const std::string& name) {
+    std::unique_ptr<SharedMemoryMapping> mapping(new SharedMemoryMapping());
+    const std::string shmName = ShmName(name);
+    const int fd = shm_open(shmName.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open failed for " + name + ". error=" + ErrnoText());
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        const std::string error = ErrnoText();
+        close(fd);
+        throw std::runtime_error("fstat failed for " + name + ". error=" + error);
+    }
+    const size_t bytes = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const std::string error = ErrnoText();
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("mmap failed for " + name + ". error=" + error);
+    }
+    mapping->data_ = data;
+    mapping->size_ = bytes;
+    return mapping;
+}
+
+SharedMemoryMapping::~SharedMemoryMapping() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+    // The name goes with its creator; processes that opened it keep their
+    // mapping until they unmap it.
+    if (owner_) {
+        shm_unlink(name_.c_str());
+    }
+}
+
+std::unique_ptr<SharedSignal> SharedSignal::Create(const std::string& /*name*/, SharedSignalWord* word) {
+    return std::unique_ptr<SharedSignal>(new SharedSignal(word));
+}
+
+std::unique_ptr<SharedSignal> SharedSignal::Open(const std::string& /*name*/, SharedSignalWord* word) {
+    return std::unique_ptr<SharedSignal>(new SharedSignal(word));
+}
+
+SharedSignal::~SharedSignal() = default;
+
+void SharedSignal::Set() {
+    if (word_->state.exchange(kSet, std::memory_order_release) == kWaiting) {
+        Futex(&word_->state, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+}
+
+bool SharedSignal::Wait(uint32_t timeoutMs) const {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    uint32_t state = word_->state.load(std::memory_order_acquire);
+    for (;;) {
+        if (state == kSet) {
+            if (word_->state.compare_exchange_weak(state, kUnset, std::memory_order_acquire,
+                                                   std::memory_order_acquire)) {
+                return true;
+            }
+            continue;
+        }
+        if (state == kUnset &&
+            !word_->state.compare_exchange_weak(state, kWaiting, std::memory_order_acquire, std::memory_order_acquire)) {
+            continue;
+        }
+
+        // A spurious wake, EINTR or a Set that raced the futex call all land
+        // back here to re-read the state.
+        if (timeoutMs == kWaitForever) {
+            Futex(&word_->state, FUTEX_WAIT, kWaiting, nullptr);
+        } else {
+            const auto remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::nanoseconds::zero()) {
+                return false;
+            }
+            const long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+            const timespec timeout{static_cast<time_t>(nanos / 1'000'000'000), static_cast<long>(nanos % 1'000'000'000)};
+            Futex(&word_->state, FUTEX_WAIT, kWaiting, &timeout);
+        }
+        state = word_->state.load(std::memory_order_acquire);
+    }
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,104 @@
+#include "flutter_xr/shared_memory.h"
+
+#include <windows.h>
+
+#include <stdexcept>
+
+namespace flutter_xr {
+
+namespace {
+
+// Not shared.h's Utf8ToWide: that header pulls in D3D11 and OpenXR, and the
+// channel also builds in native/tests without them.
+std::wstring ObjectName(const std::string& name) {
+    const int needed = MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, nullptr, 0);
+    if (needed <= 1) {
+        return std::wstring();
+    }
+    std::wstring out(static_cast<size_t>(needed - 1), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, out.data(), needed - 1);
+    return out;
+}
+
+}  // namespace
+
+std::unique_ptr<SharedMemoryMapping> SharedMemoryMapping::Create(const std::string& name, size_t bytes) {
+    std::unique_ptr<SharedMemoryMapping> mapping(new SharedMemoryMapping());
+    mapping->name_ = name;
+    mapping->owner_ = true;
+    mapping->handle_ =
+        CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(uint64_t{bytes} >> 32),
+                           static_cast<DWORD>(bytes & 0xffffffffu), ObjectName(name).c_str());
+    if (mapping->handle_ == nullptr || GetLastError() == ERROR_ALREADY_EXISTS) {
+        throw std::runtime_error("CreateFileMappingW failed for " + name + ". error=" + std::to_string(GetLastError()));
+    }
+    mapping->data_ = MapViewOfFile(mapping->handle_, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (mapping->data_ == nullptr) {
+        throw std::runtime_error("MapViewOfFile failed for " + name + ". error=" + std::to_string(GetLastError()));
+    }
+    mapping->size_ = bytes;
+    return mapping;
+}
+
+std::unique_ptr<SharedMemoryMapping> SharedMemoryMapping::Open(const std::string& name) {
+    std::unique_ptr<SharedMemoryMapping> mapping(new SharedMemoryMapping());
+    mapping->name_ = name;
+    mapping->handle_ = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, ObjectName(name).c_str());
+    if (mapping->handle_ == nullptr) {
+        throw std::runtime_error("OpenFileMappingW failed for " + name + ". error=" + std::to_string(GetLastError()));
+    }
+    mapping->data_ = MapViewOfFile(mapping->handle_, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (mapping->data_ == nullptr) {
+        throw std::runtime_error("MapViewOfFile failed for " + name + ". error=" + std::to_string(GetLastError()));
+    }
+    // The view covers the whole mapping, rounded up to pages.
+    MEMORY_BASIC_INFORMATION info{};
+    if (VirtualQuery(mapping->data_, &info, sizeof(info)) == 0) {
+        throw std::runtime_error("VirtualQuery failed for " + name + ". error=" + std::to_string(GetLastError()));
+    }
+    mapping->size_ = info.RegionSize;
+    return mapping;
+}
+
+SharedMemoryMapping::~SharedMemoryMapping() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (handle_ != nullptr) {
+        CloseHandle(handle_);
+    }
+}
+
+std::unique_ptr<SharedSignal> SharedSignal::Create(const std::string& name, SharedSignalWord* word) {
+    std::unique_ptr<SharedSignal> signal(new SharedSignal(word));
+    signal->handle_ = CreateEventW(nullptr, FALSE, FALSE, ObjectName(name).c_str());
+    if (signal->handle_ == nullptr) {
+        throw std::runtime_error("CreateEventW failed for " + name + ". error=" + std::to_string(GetLastError()));
+    }
+    return signal;
+}
+
+std::unique_ptr<SharedSignal> SharedSignal::Open(const std::string& name, SharedSignalWord* word) {
+    std::unique_ptr<SharedSignal> signal(new SharedSignal(word));
+    signal->handle_ = OpenEventW(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, ObjectName(name).c_str());
+    if (signal->handle_ == nullptr) {
+        throw std::runtime_error("OpenEventW failed for " + name + ". error=" + std::to_string(GetLastError()));
+    }
+    return signal;
+}
+
+SharedSignal::~SharedSignal() {
+    if (handle_ != nullptr) {
+        CloseHandle(handle_);
+    }
+}
+
+void SharedSignal::Set() {
+    SetEvent(handle_);
+}
+
+bool SharedSignal::Wait(uint32_t timeoutMs) const {
+    return WaitForSingleObject(handle_, timeoutMs == kWaitForever ? INFINITE : timeoutMs) == WAIT_OBJECT_0;
+}
+
+}  // namespace flutter_xr
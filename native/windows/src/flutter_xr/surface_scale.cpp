@@ -0,0 +1,101 @@
+#include "flutter_xr/surface_scale.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "flutter_xr/shared.h"
+
+namespace flutter_xr {
+
+namespace {
+
+// Roughly the angular resolution of current headsets; at the default viewing
+// distance this keeps the panel at its nominal 1280 x 720.
+constexpr float kTargetPixelsPerDegree = 24.0f;
+
+// A level must be wanted for this many consecutive frames before switching,
+// so head jitter near a threshold does not cause resize storms.
+constexpr uint32_t kSettleFrames = 45;
+
+// Raster time relative to the frame budget above which density is lowered,
+// and below which the budget cap is allowed to rise again.
+constexpr double kOverBudgetFraction = 0.75;
+constexpr double kUnderBudgetFraction = 0.4;
+constexpr double kRasterSmoothing = 0.1;
+
+constexpr float kRadiansToDegrees = 57.29577951308232f;
+
+}  // namespace
+
+SurfaceScaleController::SurfaceScaleController(size_t initialLevel)
+    : level_(std::min(initialLevel, MaxLevel())), candidateLevel_(level_) {}
+
+uint32_t SurfaceScaleController::ScaledWidth(size_t level) {
+    return static_cast<uint32_t>(std::lround(static_cast<float>(kFlutterSurfaceWidth) * kScaleLevels[level]));
+}
+
+uint32_t SurfaceScaleController::ScaledHeight(size_t level) {
+    return static_cast<uint32_t>(std::lround(static_cast<float>(kFlutterSurfaceHeight) * kScaleLevels[level]));
+}
+
+size_t SurfaceScaleController::LevelForDistance(float viewDistanceMeters) const {
+    if (!(viewDistanceMeters > 0.0f)) {
+        return level_;
+    }
+
+    const float angleDegrees = 2.0f * std::atan((kQuadWidthMeters * 0.5f) / viewDistanceMeters) * kRadiansToDegrees;
+    const float wantedScale = (angleDegrees * kTargetPixelsPerDegree) / static_cast<float>(kFlutterSurfaceWidth);
+    for (size_t level = 0; level < kScaleLevels.size(); ++level) {
+        // Allow a few percent under the ideal before paying for the next level.
+        if (kScaleLevels[level] >= wantedScale * 0.95f) {
+            return level;
+        }
+    }
+    return MaxLevel();
+}
+
+bool SurfaceScaleController::Update(float viewDistanceMeters, uint64_t rasterNanos, uint64_t frameBudgetNanos) {
+    ++framesSinceBudgetChange_;
+    if (rasterNanos > 0 && frameBudgetNanos > 0) {
+        const double raster = static_cast<double>(rasterNanos);
+        smoothedRasterNanos_ = smoothedRasterNanos_ <= 0.0
+                                   ? raster
+                                   : smoothedRasterNanos_ + (raster - smoothedRasterNanos_) * kRasterSmoothing;
+
+        const double budget = static_cast<double>(frameBudgetNanos);
+        if (framesSinceBudgetChange_ >= kSettleFrames) {
+            if (smoothedRasterNanos_ > budget * kOverBudgetFraction && level_ > 0) {
+                budgetCap_ = std::min(budgetCap_, level_ - 1);
+                framesSinceBudgetChange_ = 0;
+            } else if (smoothedRasterNanos_ < budget * kUnderBudgetFraction && budgetCap_ < MaxLevel()) {
+                ++budgetCap_;
+                framesSinceBudgetChange_ = 0;
+            }
+        }
+    }
+
+    const size_t wanted = std::min(LevelForDistance(viewDistanceMeters), budgetCap_);
+    if (wanted == level_) {
+        candidateFrames_ = 0;
+        return false;
+    }
+    if (wanted != candidateLevel_) {
+        candidateLevel_ = wanted;
+        candidateFrames_ = 0;
+    }
+    // Dropping density for an over-budget frame rate should not wait as long
+    // as raising it for a closer viewer.
+    const uint32_t settleFrames = wanted < level_ && wanted == budgetCap_ ? kSettleFrames / 3 : kSettleFrames;
+    if (++candidateFrames_ < settleFrames) {
+        return false;
+    }
+
+    level_ = wanted;
+    candidateFrames_ = 0;
+    // Raster time measured at the old size says little about the new one.
+    smoothedRasterNanos_ = 0.0;
+    framesSinceBudgetChange_ = 0;
+    return true;
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter_xr {
+
+// Picks the pixel density of the Flutter surface. The logical size stays at
+// kFlutterSurfaceWidth x kFlutterSurfaceHeight so layout never changes; only
+// the physical pixel count follows how large the panel appears to the user and
+// whether Flutter's raster time fits the display period.
+class SurfaceScaleController {
+   public:
+    static constexpr std::array<float, 7> kScaleLevels = {0.5f, 0.625f, 0.75f, 0.875f, 1.0f, 1.25f, 1.5f};
+    static constexpr size_t kDefaultLevel = 4;
+
+    explicit SurfaceScaleController(size_t initialLevel = kDefaultLevel);
+
+    // Feeds one display frame. `rasterNanos` is the latest Flutter raster time
+    // or 0 when unknown. Returns true when the selected level changed.
+    bool Update(float viewDistanceMeters, uint64_t rasterNanos, uint64_t frameBudgetNanos);
+
+    size_t Level() const { return level_; }
+    float Scale() const { return kScaleLevels[level_]; }
+
+    static size_t MaxLevel() { return kScaleLevels.size() - 1; }
+    static uint32_t ScaledWidth(size_t level);
+    static uint32_t ScaledHeight(size_t level);
+    // RGBA bytes of a frame at the highest level.
+    static size_t MaxFrameBytes() {
+        return static_cast<size_t>(ScaledWidth(MaxLevel())) * static_cast<size_t>(ScaledHeight(MaxLevel())) * 4;
+    }
+
+   private:
+    size_t LevelForDistance(float viewDistanceMeters) const;
+
+    size_t level_ = kDefaultLevel;
+    size_t budgetCap_ = kScaleLevels.size() - 1;
+    size_t candidateLevel_ = kDefaultLevel;
+    uint32_t candidateFrames_ = 0;
+    uint32_t framesSinceBudgetChange_ = 0;
+    double smoothedRasterNanos_ = 0.0;
+};
+
+}  // namespace flutter_xr
@@ -0,0 +1,111 @@
+#include "flutter_xr/upload_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace flutter_xr {
+
+namespace {
+
+// Every pump moves at least this many rows so uploads finish even when the
+// Flutter panel alone exceeds the frame budget.
+constexpr uint32_t kMinBandRows = 16;
+
+}  // namespace
+
+TextureUploadScheduler::TextureUploadScheduler(size_t bytesPerFrame, double millisecondsPerFrame)
+    : bytesPerFrame_(bytesPerFrame), millisecondsPerFrame_(millisecondsPerFrame) {}
+
+void TextureUploadScheduler::Submit(ID3D11Texture2D* texture,
+                                    std::vector<uint32_t> pixels,
+                                    uint32_t width,
+                                    uint32_t height,
+                                    uint64_t version) {
+    if (texture == nullptr || width == 0 || height == 0 || pixels.size() < static_cast<size_t>(width) * height) {
+        return;
+    }
+
+    auto existing = std::find_if(jobs_.begin(), jobs_.end(), [&](const Job& job) { return job.texture.Get() == texture; });
+    Job& job = existing != jobs_.end() ? *existing : jobs_.emplace_back();
+    job.texture = texture;
+    job.pixels = std::move(pixels);
+    job.width = width;
+    job.height = height;
+    job.nextRow = 0;
+    job.version = version;
+}
+
+void TextureUploadScheduler::BeginFrame(size_t bytesAlreadyUploaded) {
+    frameBytesUsed_ = bytesAlreadyUploaded;
+}
+
+void TextureUploadScheduler::Pump(ID3D11DeviceContext* context) {
+    if (context == nullptr) {
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    bool movedAnyRows = false;
+    for (Job& job : jobs_) {
+        const size_t rowBytes = static_cast<size_t>(job.width) * sizeof(uint32_t);
+        while (job.nextRow < job.height) {
+            const size_t remainingBytes = bytesPerFrame_ > frameBytesUsed_ ? bytesPerFrame_ - frameBytesUsed_ : 0;
+            uint32_t bandRows = static_cast<uint32_t>(std::min<size_t>(remainingBytes / rowBytes, job.height - job.nextRow));
+            if (bandRows == 0) {
+                if (movedAnyRows) {
+                    return;
+                }
+                bandRows = std::min(kMinBandRows, job.height - job.nextRow);
+            }
+
+            D3D11_BOX box{};
+            box.left = 0;
+            box.top = job.nextRow;
+            box.front = 0;
+            box.right = job.width;
+            box.bottom = job.nextRow + bandRows;
+            box.back = 1;
+            context->UpdateSubresource(job.texture.Get(), 0, &box, job.pixels.data() + static_cast<size_t>(job.nextRow) * job.width,
+                                       static_cast<UINT>(rowBytes), 0);
+
+            job.nextRow += bandRows;
+            frameBytesUsed_ += rowBytes * bandRows;
+            movedAnyRows = true;
+
+            const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (elapsedMs >= millisecondsPerFrame_) {
+                return;
+            }
+        }
+    }
+}
+
+bool TextureUploadScheduler::HasPendingUpload(ID3D11Texture2D* texture, uint64_t version) const {
+    return std::any_of(jobs_.begin(), jobs_.end(),
+                       [&](const Job& job) { return job.texture.Get() == texture && job.version == version; });
+}
+
+bool TextureUploadScheduler::TakeCompleted(ID3D11Texture2D* texture, uint64_t* outVersion) {
+    auto done = std::find_if(jobs_.begin(), jobs_.end(),
+                             [&](const Job& job) { return job.texture.Get() == texture && job.nextRow >= job.height; });
+    if (done == jobs_.end()) {
+        return false;
+    }
+    if (outVersion != nullptr) {
+        *outVersion = done->version;
+    }
+    jobs_.erase(done);
+    return true;
+}
+
+void TextureUploadScheduler::Cancel(ID3D11Texture2D* texture) {
+    jobs_.erase(std::remove_if(jobs_.begin(), jobs_.end(), [&](const Job& job) { return job.texture.Get() == texture; }),
+                jobs_.end());
+}
+
+void TextureUploadScheduler::Clear() {
+    jobs_.clear();
+}
+
+}  // namespace flutter_xr
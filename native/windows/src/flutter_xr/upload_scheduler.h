@@ -0,0 +1,59 @@
+#pragma once
+
+#include <d3d11_4.h>
+#include <wrl/client.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_xr {
+
+// Spreads large CPU-to-GPU texture uploads over several frames. Each frame
+// gets a byte and time budget; work done outside the scheduler (the Flutter
+// panel) is charged first, and queued uploads go out in row bands with what
+// is left. A texture's new content counts as complete only once every band
+// of it has been uploaded.
+class TextureUploadScheduler {
+   public:
+    TextureUploadScheduler(size_t bytesPerFrame, double millisecondsPerFrame);
+
+    // Queues `pixels` (tightly packed 32-bit rows) for `texture`, replacing
+    // any unfinished upload to the same texture.
+    void Submit(ID3D11Texture2D* texture,
+                std::vector<uint32_t> pixels,
+                uint32_t width,
+                uint32_t height,
+                uint64_t version);
+
+    // Starts a frame; `bytesAlreadyUploaded` is charged against its budget.
+    void BeginFrame(size_t bytesAlreadyUploaded);
+
+    // Uploads as many bands as the remaining frame budget allows.
+    void Pump(ID3D11DeviceContext* context);
+
+    bool HasPendingUpload(ID3D11Texture2D* texture, uint64_t version) const;
+
+    // Reports a finished upload of `texture` once and forgets about it.
+    bool TakeCompleted(ID3D11Texture2D* texture, uint64_t* outVersion);
+
+    void Cancel(ID3D11Texture2D* texture);
+    void Clear();
+
+   private:
+    struct Job {
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        std::vector<uint32_t> pixels;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t nextRow = 0;
+        uint64_t version = 0;
+    };
+
+    size_t bytesPerFrame_ = 0;
+    double millisecondsPerFrame_ = 0.0;
+    size_t frameBytesUsed_ = 0;
+    std::vector<Job> jobs_;
+};
+
+}  // namespace flutter_xr
@@ -0,0 +1,126 @@
+#include "flutter_xr/worker_pool.h"
+
+#include <algorithm>
+
+namespace flutter_xr {
+
+namespace {
+
+// Stripes per participating thread; a few extra stripes let fast threads pick
+// up the slack when the OS deschedules one of them mid-frame.
+constexpr size_t kStripesPerThread = 4;
+
+thread_local bool tIsPoolWorker = false;
+
+}  // namespace
+
+WorkerPool::WorkerPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = DefaultThreadCount();
+    }
+    threadCount = std::min(threadCount, kMaxThreads);
+
+    workers_.reserve(threadCount > 0 ? threadCount - 1 : 0);
+    for (size_t i = 1; i < threadCount; ++i) {
+        workers_.emplace_back([this]() { WorkerMain(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeCondition_.notify_all();
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+size_t WorkerPool::DefaultThreadCount() {
+    // Leave headroom for the XR compositor and the Flutter raster thread.
+    const size_t hardwareThreads = std::thread::hardware_concurrency();
+    if (hardwareThreads <= 2) {
+        return 1;
+    }
+    return std::min<size_t>(hardwareThreads / 2, 8);
+}
+
+void WorkerPool::ParallelForRows(size_t rowCount, size_t minRowsPerStripe, const RowRangeFunction& body) {
+    if (rowCount == 0) {
+        return;
+    }
+
+    minRowsPerStripe = std::max<size_t>(minRowsPerStripe, 1);
+    const size_t threadCount = ThreadCount();
+    if (threadCount == 1 || rowCount < minRowsPerStripe * 2 || tIsPoolWorker) {
+        body(0, rowCount);
+        return;
+    }
+
+    std::unique_lock<std::mutex> submitLock(submitMutex_, std::try_to_lock);
+    if (!submitLock.owns_lock()) {
+        body(0, rowCount);
+        return;
+    }
+
+    const size_t targetStripes = threadCount * kStripesPerThread;
+    const size_t stripeRows = std::max(minRowsPerStripe, (rowCount + targetStripes - 1) / targetStripes);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body_ = &body;
+        rowCount_ = rowCount;
+        stripeRows_ = stripeRows;
+        stripeCount_ = (rowCount + stripeRows - 1) / stripeRows;
+        nextStripe_.store(0, std::memory_order_relaxed);
+        activeWorkers_ = workers_.size();
+        ++generation_;
+    }
+    wakeCondition_.notify_all();
+
+    tIsPoolWorker = true;
+    RunStripes();
+    tIsPoolWorker = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [this]() { return activeWorkers_ == 0; });
+    body_ = nullptr;
+}
+
+void WorkerPool::WorkerMain() {
+    tIsPoolWorker = true;
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeCondition_.wait(lock, [&]() { return stopping_ || generation_ != seenGeneration; });
+            if (stopping_) {
+                return;
+            }
+            seenGeneration = generation_;
+        }
+
+        RunStripes();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--activeWorkers_ == 0) {
+            doneCondition_.notify_one();
+        }
+    }
+}
+
+void WorkerPool::RunStripes() {
+    for (;;) {
+        const size_t stripe = nextStripe_.fetch_add(1, std::memory_order_relaxed);
+        if (stripe >= stripeCount_) {
+            return;
+        }
+        const size_t rowBegin = stripe * stripeRows_;
+        const size_t rowEnd = std::min(rowBegin + stripeRows_, rowCount_);
+        (*body_)(rowBegin, rowEnd);
+    }
+}
+
+}  // namespace flutter_xr
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flutter_xr {
+
+// Persistent threads that split row-oriented pixel work into horizontal
+// stripes. The calling thread takes part in every job, and each thread keeps
+// claiming the next unclaimed stripe until none are left, so a slow stripe
+// never holds the others back.
+class WorkerPool {
+   public:
+    using RowRangeFunction = std::function<void(size_t rowBegin, size_t rowEnd)>;
+
+    static constexpr size_t kMaxThreads = 16;
+
+    // `threadCount` includes the calling thread; 0 picks a count from the
+    // hardware and 1 runs every job inline.
+    explicit WorkerPool(size_t threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Calls `body` for disjoint row ranges covering [0, rowCount) and returns
+    // once all of them finished. Ranges hold at least `minRowsPerStripe` rows
+    // except the last. Runs inline when the job is too small, when called from
+    // a worker, or when another thread is already using the pool.
+    void ParallelForRows(size_t rowCount, size_t minRowsPerStripe, const RowRangeFunction& body);
+
+    size_t ThreadCount() const { return workers_.size() + 1; }
+
+    static size_t DefaultThreadCount();
+
+   private:
+    void WorkerMain();
+    void RunStripes();
+
+    std::vector<std::thread> workers_;
+    std::mutex submitMutex_;
+    std::mutex mutex_;
+    std::condition_variable wakeCondition_;
+    std::condition_variable doneCondition_;
+    uint64_t generation_ = 0;
+    size_t activeWorkers_ = 0;
+    bool stopping_ = false;
+
+    const RowRangeFunction* body_ = nullptr;
+    size_t rowCount_ = 0;
+    size_t stripeRows_ = 0;
+    size_t stripeCount_ = 0;
+    std::atomic<size_t> nextStripe_{0};
+};
+
+}  // namespace flutter_xr
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include <openxr/openxr.h>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLUTTER_XR_MATH_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define FLUTTER_XR_MATH_NEON 1
+#endif
+
+namespace flutter_xr {
+
+static_assert(sizeof(XrVector3f) == 3 * sizeof(float), "batch kernels read XrVector3f arrays as packed floats");
+
+// Scalar vector and quaternion helpers. Everything except Normalize is
+// constexpr so constant poses can be folded at compile time.
+
+constexpr XrVector3f Add(const XrVector3f& lhs, const XrVector3f& rhs) {
+    return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
+}
+
+constexpr XrVector3f Subtract(const XrVector3f& lhs, const XrVector3f& rhs) {
+    return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+}
+
+constexpr XrVector3f Scale(const XrVector3f& value, float scale) {
+    return {value.x * scale, value.y * scale, value.z * scale};
+}
+
+constexpr float Dot(const XrVector3f& lhs, const XrVector3f& rhs) {
+    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+constexpr XrVector3f Cross(const XrVector3f& lhs, const XrVector3f& rhs) {
+    return {
+        lhs.y * rhs.z - lhs.z * rhs.y,
+        lhs.z * rhs.x - lhs.x * rhs.z,
+        lhs.x * rhs.y - lhs.y * rhs.x,
+    };
+}
+
+constexpr XrQuaternionf Conjugate(const XrQuaternionf& value) {
+    return {-value.x, -value.y, -value.z, value.w};
+}
+
+constexpr XrQuaternionf Multiply(const XrQuaternionf& lhs, const XrQuaternionf& rhs) {
+    return {
+        lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y,
+        lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x,
+        lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w,
+        lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z,
+    };
+}
+
+constexpr XrVector3f RotateVector(const XrQuaternionf& rotation, const XrVector3f& value) {
+    const XrVector3f qv{rotation.x, rotation.y, rotation.z};
+    const XrVector3f term1 = Scale(qv, 2.0f * Dot(qv, value));
+    const XrVector3f term2 = Scale(value, rotation.w * rotation.w - Dot(qv, qv));
+    const XrVector3f term3 = Scale(Cross(qv, value), 2.0f * rotation.w);
+    return Add(Add(term1, term2), term3);
+}
+
+inline XrVector3f Normalize(const XrVector3f& value) {
+    const float lengthSquared = Dot(value, value);
+    if (lengthSquared <= 1.0e-8f) {
+        return {0.0f, 0.0f, -1.0f};
+    }
+    const float invLength = 1.0f / std::sqrt(lengthSquared);
+    return Scale(value, invLength);
+}
+
+constexpr XrVector3f TransformPoint(const XrPosef& pose, const XrVector3f& point) {
+    return Add(pose.position, RotateVector(pose.orientation, point));
+}
+
+// Pose of `child`, given relative to `parent`, in the parent's space.
+constexpr XrPosef ComposePoses(const XrPosef& parent, const XrPosef& child) {
+    return {Multiply(parent.orientation, child.orientation), TransformPoint(parent, child.position)};
+}
+
+// Row-major rotation matrix of a unit quaternion.
+struct Matrix3 {
+    float m[3][3];
+};
+
+constexpr Matrix3 RotationMatrix(const XrQuaternionf& q) {
+    const float xx = q.x * q.x;
+    const float yy = q.y * q.y;
+    const float zz = q.z * q.z;
+    const float xy = q.x * q.y;
+    const float xz = q.x * q.z;
+    const float yz = q.y * q.z;
+    const float wx = q.w * q.x;
+    const float wy = q.w * q.y;
+    const float wz = q.w * q.z;
+    return {{
+        {1.0f - 2.0f * (yy + zz), 2.0f * (xy - wz), 2.0f * (xz + wy)},
+        {2.0f * (xy + wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz - wx)},
+        {2.0f * (xz - wy), 2.0f * (yz + wx), 1.0f - 2.0f * (xx + yy)},
+    }};
+}
+
+constexpr Matrix3 Transpose(const Matrix3& value) {
+    return {{
+        {value.m[0][0], value.m[1][0], value.m[2][0]},
+        {value.m[0][1], value.m[1][1], value.m[2][1]},
+        {value.m[0][2], value.m[1][2], value.m[2][2]},
+    }};
+}
+
+// Rotation taking the unit x, y and z axes onto the given orthonormal,
+// right-handed axes.
+inline XrQuaternionf QuaternionFromAxes(const XrVector3f& xAxis, const XrVector3f& yAxis, const XrVector3f& zAxis) {
+    const float trace = xAxis.x + yAxis.y + zAxis.z;
+    if (trace > 0.0f) {
+        const float s = 0.5f / std::sqrt(trace + 1.0f);
+        return {(yAxis.z - zAxis.y) * s, (zAxis.x - xAxis.z) * s, (xAxis.y - yAxis.x) * s, 0.25f / s};
+    }
+    if (xAxis.x > yAxis.y && xAxis.x > zAxis.z) {
+        const float s = 2.0f * std::sqrt(1.0f + xAxis.x - yAxis.y - zAxis.z);
+        return {0.25f * s, (yAxis.x + xAxis.y) / s, (zAxis.x + xAxis.z) / s, (yAxis.z - zAxis.y) / s};
+    }
+    if (yAxis.y > zAxis.z) {
+        const float s = 2.0f * std::sqrt(1.0f + yAxis.y - xAxis.x - zAxis.z);
+        return {(yAxis.x + xAxis.y) / s, 0.25f * s, (zAxis.y + yAxis.z) / s, (zAxis.x - xAxis.z) / s};
+    }
+    const float s = 2.0f * std::sqrt(1.0f + zAxis.z - xAxis.x - yAxis.y);
+    return {(zAxis.x + xAxis.z) / s, (zAxis.y + yAxis.z) / s, 0.25f * s, (xAxis.y - yAxis.x) / s};
+}
+
+namespace detail {
+
+// out[i] = rotation * in[i] + translation. The quaternion is expanded to a
+// matrix once; four vectors are deinterleaved per SIMD step.
+inline void TransformVectors(const Matrix3& r,
+                             const XrVector3f& translation,
+                             const XrVector3f* in,
+                             XrVector3f* out,
+                             size_t count) {
+    size_t i = 0;
+#if defined(FLUTTER_XR_MATH_SSE2) || defined(FLUTTER_XR_MATH_NEON)
+    const float* source = reinterpret_cast<const float*>(in);
+    float* destination = reinterpret_cast<float*>(out);
+#endif
+
+#if defined(FLUTTER_XR_MATH_SSE2)
+    const __m128 m00 = _mm_set1_ps(r.m[0][0]), m01 = _mm_set1_ps(r.m[0][1]), m02 = _mm_set1_ps(r.m[0][2]);
+    const __m128 m10 = _mm_set1_ps(r.m[1][0]), m11 = _mm_set1_ps(r.m[1][1]), m12 = _mm_set1_ps(r.m[1][2]);
+    const __m128 m20 = _mm_set1_ps(r.m[2][0]), m21 = _mm_set1_ps(r.m[2][1]), m22 = _mm_set1_ps(r.m[2][2]);
+    const __m128 tx = _mm_set1_ps(translation.x), ty = _mm_set1_ps(translation.y), tz = _mm_set1_ps(translation.z);
+    for (; i + 4 <= count; i += 4) {
+        // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+        const __m128 a = _mm_loadu_ps(source + i * 3);
+        const __m128 b = _mm_loadu_ps(source + i * 3 + 4);
+        const __m128 c = _mm_loadu_ps(source + i * 3 + 8);
+        const __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)),
+                                        _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 1, 0, 2)),
+                                        _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+        const __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_add_ps(_mm_mul_ps(m02, z), tx));
+        const __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m12, z), ty));
+        const __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_add_ps(_mm_mul_ps(m22, z), tz));
+
+        _mm_storeu_ps(destination + i * 3,
+                      _mm_shuffle_ps(_mm_shuffle_ps(rx, ry, _MM_SHUFFLE(0, 0, 0, 0)),
+                                     _mm_shuffle_ps(rz, rx, _MM_SHUFFLE(0, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(destination + i * 3 + 4,
+                      _mm_shuffle_ps(_mm_shuffle_ps(ry, rz, _MM_SHUFFLE(0, 1, 0, 1)),
+                                     _mm_shuffle_ps(rx, ry, _MM_SHUFFLE(0, 2, 0, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(destination + i * 3 + 8,
+                      _mm_shuffle_ps(_mm_shuffle_ps(rz, rx, _MM_SHUFFLE(0, 3, 0, 2)),
+                                     _mm_shuffle_ps(ry, rz, _MM_SHUFFLE(0, 3, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#elif defined(FLUTTER_XR_MATH_NEON)
+    for (; i + 4 <= count; i += 4) {
+        const float32x4x3_t v = vld3q_f32(source + i * 3);
+        float32x4x3_t result;
+        for (int row = 0; row < 3; ++row) {
+            const float t = row == 0 ? translation.x : (row == 1 ? translation.y : translation.z);
+            float32x4_t acc = vdupq_n_f32(t);
+            acc = vmlaq_n_f32(acc, v.val[0], r.m[row][0]);
+            acc = vmlaq_n_f32(acc, v.val[1], r.m[row][1]);
+            result.val[row] = vmlaq_n_f32(acc, v.val[2], r.m[row][2]);
+        }
+        vst3q_f32(destination + i * 3, result);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const XrVector3f v = in[i];
+        out[i] = {r.m[0][0] * v.x + r.m[0][1] * v.y + r.m[0][2] * v.z + translation.x,
+                  r.m[1][0] * v.x + r.m[1][1] * v.y + r.m[1][2] * v.z + translation.y,
+                  r.m[2][0] * v.x + r.m[2][1] * v.y + r.m[2][2] * v.z + translation.z};
+    }
+}
+
+}  // namespace detail
+
+// Batch forms. `in` and `out` may be the same array but must not otherwise
+// overlap.
+
+inline void RotateVectors(const XrQuaternionf& rotation, const XrVector3f* in, XrVector3f* out, size_t count) {
+    detail::TransformVectors(RotationMatrix(rotation), XrVector3f{0.0f, 0.0f, 0.0f}, in, out, count);
+}
+
+inline void TransformPoints(const XrPosef& pose, const XrVector3f* in, XrVector3f* out, size_t count) {
+    detail::TransformVectors(RotationMatrix(pose.orientation), pose.position, in, out, count);
+}
+
+inline void ComposePoses(const XrPosef& parent, const XrPosef* children, XrPosef* out, size_t count) {
+    const Matrix3 rotation = RotationMatrix(parent.orientation);
+    for (size_t i = 0; i < count; ++i) {
+        const XrVector3f& p = children[i].position;
+        const XrQuaternionf orientation = Multiply(parent.orientation, children[i].orientation);
+        out[i].position = {rotation.m[0][0] * p.x + rotation.m[0][1] * p.y + rotation.m[0][2] * p.z + parent.position.x,
+                           rotation.m[1][0] * p.x + rotation.m[1][1] * p.y + rotation.m[1][2] * p.z + parent.position.y,
+                           rotation.m[2][0] * p.x + rotation.m[2][1] * p.y + rotation.m[2][2] * p.z + parent.position.z};
+        out[i].orientation = orientation;
+    }
+}
+
+}  // namespace flutter_xr